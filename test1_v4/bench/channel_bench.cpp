@@ -0,0 +1,478 @@
+// channel_bench.cpp
+// 通道回环基准：用真实的 ProtocolChannel 与端点对象转发回环流量，覆盖各端点组合
+//  - tcp_server->tcp_server / tcp_client->tcp_server / udp_server->tcp_server
+//  - serial->tcp_server / tcp_server->serial（串口使用 PtySerial 伪终端，驱动端读写主设备）
+// 驱动线程按固定报文长度发送（rate > 0 时按固定速率，否则尽快发送），每条报文携带序号与发送时间，
+// 接收线程按报文长度切分字节流，统计吞吐、每 GB 的 CPU 时间（进程 CPU 扣除驱动线程）与端到端延迟分位数
+// 串口输入的组合另外输出串口端点的接收统计（每次唤醒取出的字节数与其线路时间）；
+// 串口的接收延迟以端到端延迟衡量（伪终端按波特率限速，发送时间在驱动端测得），rx_modes 用于比较 VMIN / VTIME 的效果
+// 结果以 JSON 输出到 stdout，可作为性能回归基线
+// 用法: ./bench_channel [seconds] [rate] [sizes] [bauds] [rx_modes]
+//   sizes 为逗号分隔的报文长度（默认 "64,1024"，最小 16 字节）；rate 为每秒报文数（默认 0：不限速）
+//   bauds 为逗号分隔的串口波特率（如 "9600,115200,921600"），串口组合按每个波特率各运行一次，
+//   伪终端按该波特率限速模拟线路时序；默认 "0"：不限速（配置 115200，以伪终端的速度收发）
+//   限速且不限报文速率时，tcp_server->serial 的发送速率限制为线路速率（否则通道发送队列持续堆积，延迟只反映排队）
+//   rx_modes 为逗号分隔的串口接收参数 "vmin:vtime"（如 "0:0,32:0,32:1"），串口输入的组合按每组参数各运行一次；
+//   默认 "0:0"。伪终端不支持 low_latency（ASYNC_LOW_LATENCY），需在真实串口上比较
+#include "../protocol_channel.h"
+#include "../reactor.h"
+#include "../latency_histogram.h"
+#include "../pty_serial.h"
+#include <nlohmann/json.hpp>
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr uint16_t kBasePort = 19800;
+constexpr size_t kHeaderSize = 16; // 序号 + 发送时间（纳秒）
+constexpr auto kConnectTimeout = std::chrono::seconds(3);
+constexpr auto kDrainTimeout = std::chrono::milliseconds(500);
+constexpr int kDefaultBaud = 115200;
+
+// 串口接收参数（对应端点配置的 vmin / vtime）
+struct RxMode {
+    uint32_t vmin = 0;
+    uint32_t vtime = 0;
+};
+
+struct Pairing {
+    const char* name;
+    const char* input;
+    const char* output;
+};
+
+const Pairing kPairings[] = {
+    {"tcp_server->tcp_server", "tcp_server", "tcp_server"},
+    {"tcp_client->tcp_server", "tcp_client", "tcp_server"},
+    {"udp_server->tcp_server", "udp_server", "tcp_server"},
+    {"serial->tcp_server", "serial", "tcp_server"},
+    {"tcp_server->serial", "tcp_server", "serial"},
+};
+
+// 驱动端连接：sourceFd 写入通道的输入端点，sinkFd 读取通道的输出端点
+struct Link {
+    int sourceFd = -1;
+    int sinkFd = -1;
+    PtySerial* sourcePty = nullptr; // 源端 / 目的端为串口时经 PtySerial 读写（限速）
+    PtySerial* sinkPty = nullptr;
+    bool datagram = false;   // 源端按数据报发送（UDP）
+    sockaddr_in target{};    // 数据报目标
+    std::vector<int> fds;    // 结束时关闭
+};
+
+struct Result {
+    size_t sent = 0;
+    size_t received = 0;
+    size_t bytes = 0;
+    size_t sequenceErrors = 0; // 序号不连续：报文被改写或流错位（数据报丢失只产生序号跳跃，不计入）
+    double rate = 0;           // 实际使用的发送速率（每秒报文数，0：不限速）
+    double seconds = 0;
+    double channelCpu = 0;
+    LatencySummary latency;
+    EndpointStats input;       // 输入端点状态（串口输入时包含接收唤醒次数与每次取出的数据量）
+};
+
+sockaddr_in loopback(uint16_t port) {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    return addr;
+}
+
+uint64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+double threadCpuSeconds() {
+    timespec ts{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+double processCpuSeconds() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+           usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+[[noreturn]] void fail(const std::string& message) {
+    std::cerr << "bench_channel: " << message << std::endl;
+    std::exit(1);
+}
+
+int connectTcp(uint16_t port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr = loopback(port);
+    const auto deadline = Clock::now() + kConnectTimeout;
+    while (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        if (Clock::now() > deadline) fail("connect to port " + std::to_string(port) + " failed");
+        ::close(fd);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+int listenTcp(uint16_t port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr = loopback(port);
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || listen(fd, 1) < 0) {
+        fail("listen on port " + std::to_string(port) + " failed");
+    }
+    return fd;
+}
+
+int acceptTcp(int listenFd) {
+    pollfd pfd{listenFd, POLLIN, 0};
+    if (poll(&pfd, 1, static_cast<int>(std::chrono::milliseconds(kConnectTimeout).count())) <= 0) {
+        fail("tcp_client endpoint did not connect");
+    }
+    int fd = accept(listenFd, nullptr, nullptr);
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+bool isSerial(const char* type) {
+    return std::strcmp(type, "serial") == 0;
+}
+
+// baud 为 0 时不限速
+EndpointConfig endpointConfig(const char* type, uint16_t port, int baud, const RxMode& rx,
+                              std::unique_ptr<PtySerial>& pty, int& listenFd) {
+    EndpointConfig config;
+    config.type = type;
+    config.port = port;
+    if (config.type == "tcp_client") {
+        // 驱动端监听，通道的 tcp_client 端点连接过来
+        listenFd = listenTcp(port);
+        config.ip = "127.0.0.1";
+    } else if (config.type == "serial") {
+        // 驱动端持有主设备，从设备路径交给 SerialEndpoint 打开
+        pty = std::make_unique<PtySerial>();
+        pty->setPacing(baud > 0);
+        config.serial_port = pty->slavePath();
+        config.baud_rate = baud > 0 ? baud : kDefaultBaud;
+        config.vmin = rx.vmin;
+        config.vtime = rx.vtime;
+    }
+    return config;
+}
+
+// 等待 tcp_server 端点接受驱动端的连接（之前发送的数据会被丢弃）
+void waitForClient(const ProtocolChannel& channel, int node) {
+    const auto deadline = Clock::now() + kConnectTimeout;
+    while (channel.stats().endpoints[node].clients == 0) {
+        if (Clock::now() > deadline) fail("tcp_server endpoint did not accept the driver");
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+}
+
+Link connect(const Pairing& pairing, const ProtocolChannel& channel, uint16_t inputPort,
+             uint16_t outputPort, PtySerial* inputPty, PtySerial* outputPty, int listenFd) {
+    Link link;
+    const std::string input = pairing.input;
+    const std::string output = pairing.output;
+
+    if (output == "tcp_server") {
+        link.sinkFd = connectTcp(outputPort);
+        waitForClient(channel, 1);
+    } else {
+        link.sinkPty = outputPty;
+        link.sinkFd = outputPty->fd();
+    }
+
+    if (input == "tcp_server") {
+        link.sourceFd = connectTcp(inputPort);
+        waitForClient(channel, 0);
+    } else if (input == "tcp_client") {
+        link.sourceFd = acceptTcp(listenFd);
+    } else if (input == "udp_server") {
+        link.sourceFd = socket(AF_INET, SOCK_DGRAM, 0);
+        link.datagram = true;
+        link.target = loopback(inputPort);
+    } else {
+        link.sourcePty = inputPty;
+        link.sourceFd = inputPty->fd();
+    }
+    if (!link.sourcePty) link.fds.push_back(link.sourceFd);
+    if (!link.sinkPty) link.fds.push_back(link.sinkFd);
+    return link;
+}
+
+bool writeAll(int fd, const uint8_t* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = ::write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        len -= n;
+    }
+    return true;
+}
+
+// 发送线程：返回发送的报文数
+size_t sendMessages(const Link& link, size_t size, double rate, double seconds, double& cpu) {
+    std::vector<uint8_t> message(size, 0x5A);
+    const auto start = Clock::now();
+    const auto deadline = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+    size_t sent = 0;
+    while (true) {
+        auto now = Clock::now();
+        if (now >= deadline) break;
+        if (rate > 0) {
+            // 按固定速率：发送所有已到期的报文，之后等待下一条的发送时间
+            const auto due = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(sent / rate));
+            if (due > now) {
+                std::this_thread::sleep_until(due);
+                continue;
+            }
+        }
+        const uint64_t seq = sent;
+        const uint64_t sendNs = nowNs();
+        memcpy(message.data(), &seq, sizeof(seq));
+        memcpy(message.data() + sizeof(seq), &sendNs, sizeof(sendNs));
+        if (link.datagram) {
+            sendto(link.sourceFd, message.data(), size, 0,
+                   reinterpret_cast<const sockaddr*>(&link.target), sizeof(link.target));
+        } else if (link.sourcePty ? !link.sourcePty->write(message.data(), size)
+                                  : !writeAll(link.sourceFd, message.data(), size)) {
+            break;
+        }
+        ++sent;
+    }
+    cpu = threadCpuSeconds();
+    return sent;
+}
+
+// 接收线程：按报文长度切分字节流，发送结束且所有报文到达（或空闲超时）后返回
+void receiveMessages(const Link& link, size_t size, const std::atomic<bool>& senderDone,
+                     const std::atomic<size_t>& sentCount, Result& result, LatencyHistogram& histogram,
+                     double& cpu) {
+    std::vector<uint8_t> buffer(256 * 1024);
+    size_t filled = 0;
+    uint64_t nextSeq = 0;
+    auto lastData = Clock::now();
+    while (true) {
+        if (senderDone.load(std::memory_order_acquire)) {
+            if (result.received >= sentCount.load(std::memory_order_acquire)) break;
+            if (Clock::now() - lastData > kDrainTimeout) break;
+        }
+        pollfd pfd{link.sinkFd, POLLIN, 0};
+        if (poll(&pfd, 1, 50) <= 0) continue;
+        ssize_t n = link.sinkPty ? link.sinkPty->read(buffer.data() + filled, buffer.size() - filled)
+                                 : ::read(link.sinkFd, buffer.data() + filled, buffer.size() - filled);
+        if (n <= 0) {
+            if (n < 0 && (errno == EINTR || errno == EAGAIN)) continue;
+            break;
+        }
+        const uint64_t arrival = nowNs();
+        lastData = Clock::now();
+        filled += n;
+        result.bytes += n;
+
+        size_t offset = 0;
+        for (; offset + size <= filled; offset += size) {
+            uint64_t seq;
+            uint64_t sendNs;
+            memcpy(&seq, buffer.data() + offset, sizeof(seq));
+            memcpy(&sendNs, buffer.data() + offset + sizeof(seq), sizeof(sendNs));
+            // 字节流必须连续；数据报允许丢失造成的跳跃
+            if (link.datagram ? seq < nextSeq : seq != nextSeq) {
+                ++result.sequenceErrors;
+                continue;
+            }
+            nextSeq = seq + 1;
+            histogram.record(arrival > sendNs ? arrival - sendNs : 0);
+            ++result.received;
+        }
+        memmove(buffer.data(), buffer.data() + offset, filled - offset);
+        filled -= offset;
+    }
+    cpu = threadCpuSeconds();
+}
+
+Result runPairing(size_t index, ThreadPool& pool, size_t size, double rate, double seconds, int baud,
+                  const RxMode& rx) {
+    const Pairing& pairing = kPairings[index];
+    const uint16_t inputPort = static_cast<uint16_t>(kBasePort + index * 2);
+    const uint16_t outputPort = static_cast<uint16_t>(inputPort + 1);
+
+    std::unique_ptr<PtySerial> inputPty;
+    std::unique_ptr<PtySerial> outputPty;
+    int listenFd = -1;
+    int unused = -1;
+    ChannelConfig config;
+    config.name = pairing.name;
+    config.log_level = "warning";
+    config.input = endpointConfig(pairing.input, inputPort, baud, rx, inputPty, listenFd);
+    config.output = endpointConfig(pairing.output, outputPort, baud, rx, outputPty, unused);
+
+    auto channel = std::make_unique<ProtocolChannel>(config, pool);
+    channel->start();
+    // 串口端点完成 TCSETS2 配置（原始模式）之前写入的数据会被终端行规程处理
+    for (PtySerial* pty : {inputPty.get(), outputPty.get()}) {
+        if (pty && !pty->waitConfigured(baud > 0 ? baud : kDefaultBaud, kConnectTimeout)) {
+            fail("serial endpoint did not configure " + pty->slavePath());
+        }
+    }
+    Link link = connect(pairing, *channel, inputPort, outputPort, inputPty.get(), outputPty.get(), listenFd);
+    if (baud > 0 && rate <= 0 && outputPty) {
+        // 不限报文速率时按线路速率发送
+        rate = static_cast<double>(baud) / PtySerial::kBitsPerByte / size;
+    }
+
+    Result result;
+    result.rate = rate;
+    LatencyHistogram histogram;
+    std::atomic<bool> senderDone{false};
+    std::atomic<size_t> sentCount{0};
+    double senderCpu = 0;
+    double receiverCpu = 0;
+
+    const double cpuStart = processCpuSeconds();
+    const auto start = Clock::now();
+    std::thread receiver([&] {
+        receiveMessages(link, size, senderDone, sentCount, result, histogram, receiverCpu);
+    });
+    std::thread sender([&] {
+        sentCount.store(sendMessages(link, size, rate, seconds, senderCpu), std::memory_order_release);
+        senderDone.store(true, std::memory_order_release);
+    });
+    sender.join();
+    receiver.join();
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    result.channelCpu = processCpuSeconds() - cpuStart - senderCpu - receiverCpu;
+    result.sent = sentCount.load();
+    result.latency = histogram.summary();
+    result.input = channel->stats().endpoints[0];
+
+    channel->stop();
+    channel.reset();
+    for (int fd : link.fds) ::close(fd);
+    if (listenFd >= 0) ::close(listenFd);
+    return result;
+}
+
+std::vector<size_t> parseList(const char* list) {
+    std::vector<size_t> values;
+    std::string s(list);
+    size_t pos = 0;
+    while (pos < s.size()) {
+        size_t comma = s.find(',', pos);
+        if (comma == std::string::npos) comma = s.size();
+        values.push_back(std::strtoull(s.substr(pos, comma - pos).c_str(), nullptr, 10));
+        pos = comma + 1;
+    }
+    return values;
+}
+
+// "vmin:vtime" 的逗号分隔列表
+std::vector<RxMode> parseRxModes(const char* list) {
+    std::vector<RxMode> modes;
+    std::string s(list);
+    size_t pos = 0;
+    while (pos < s.size()) {
+        size_t comma = s.find(',', pos);
+        if (comma == std::string::npos) comma = s.size();
+        const std::string item = s.substr(pos, comma - pos);
+        const size_t colon = item.find(':');
+        if (colon == std::string::npos) fail("rx mode must be vmin:vtime: " + item);
+        RxMode mode;
+        mode.vmin = static_cast<uint32_t>(std::strtoul(item.substr(0, colon).c_str(), nullptr, 10));
+        mode.vtime = static_cast<uint32_t>(std::strtoul(item.substr(colon + 1).c_str(), nullptr, 10));
+        modes.push_back(mode);
+        pos = comma + 1;
+    }
+    return modes;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const double seconds = argc > 1 ? std::strtod(argv[1], nullptr) : 1.0;
+    const double rate = argc > 2 ? std::strtod(argv[2], nullptr) : 0;
+    const std::vector<size_t> sizes = parseList(argc > 3 ? argv[3] : "64,1024");
+    const std::vector<size_t> bauds = parseList(argc > 4 ? argv[4] : "0");
+    const std::vector<RxMode> rxModes = parseRxModes(argc > 5 ? argv[5] : "0:0");
+    for (size_t size : sizes) {
+        if (size < kHeaderSize) fail("message size must be at least " + std::to_string(kHeaderSize));
+    }
+
+    LogRecord::init(true, false);
+    LogRecord::setLevel(LogLevel::WARNING);
+    Reactor::init(1);
+    ThreadPool pool(2);
+
+    nlohmann::json results = nlohmann::json::array();
+    for (size_t i = 0; i < std::size(kPairings); ++i) {
+        // 不含串口的组合与波特率无关，只运行一次
+        const bool serial = isSerial(kPairings[i].input) || isSerial(kPairings[i].output);
+        const std::vector<size_t> pairingBauds = serial ? bauds : std::vector<size_t>{0};
+        // 接收参数只影响串口输入的组合
+        const std::vector<RxMode> pairingModes = isSerial(kPairings[i].input) ? rxModes : std::vector<RxMode>{RxMode{}};
+        const size_t perBaud = sizes.size() * pairingModes.size();
+        for (size_t run = 0; run < pairingBauds.size() * perBaud; ++run) {
+            const size_t baud = pairingBauds[run / perBaud];
+            const size_t size = sizes[run % perBaud / pairingModes.size()];
+            const RxMode& rx = pairingModes[run % pairingModes.size()];
+            const Result r = runPairing(i, pool, size, rate, seconds, static_cast<int>(baud), rx);
+            const double gb = r.bytes / 1e9;
+            nlohmann::json entry = {
+                {"pair", kPairings[i].name},
+                {"baud", baud},
+                {"message_size", size},
+                {"rate", r.rate},
+                {"seconds", r.seconds},
+                {"messages_sent", r.sent},
+                {"messages_received", r.received},
+                {"sequence_errors", r.sequenceErrors},
+                {"throughput_mbps", r.bytes * 8 / r.seconds / 1e6},
+                {"messages_per_sec", r.received / r.seconds},
+                {"cpu_seconds_per_gb", gb > 0 ? r.channelCpu / gb : 0.0},
+                {"latency_us", {{"p50", r.latency.p50 / 1e3}, {"p99", r.latency.p99 / 1e3},
+                                {"p999", r.latency.p999 / 1e3}, {"max", r.latency.max / 1e3}}},
+            };
+            if (r.input.type == "serial") {
+                const LatencySummary& drain = r.input.rx_drain_time;
+                entry["serial_rx"] = {
+                    {"vmin", rx.vmin},
+                    {"vtime", rx.vtime},
+                    {"wakeups", r.input.rx_wakeups},
+                    {"reads", r.input.rx_reads},
+                    {"bytes_per_wakeup", r.input.rx_wakeups ? static_cast<double>(r.bytes) / r.input.rx_wakeups : 0.0},
+                    {"drain_wire_us", {{"p50", drain.p50 / 1e3}, {"p99", drain.p99 / 1e3}, {"max", drain.max / 1e3}}},
+                };
+            }
+            results.push_back(std::move(entry));
+        }
+    }
+    std::cout << results.dump(2) << std::endl;
+    return 0;
+}
@@ -0,0 +1,95 @@
+// database_bench.cpp
+// 配置数据库基准：模拟大规模通道配置的写入与读取
+//  - replace(new)：空库写入全部通道
+//  - replace(same)：重复写入相同配置（逐行比较后不写入）
+//  - replace(1%)：1% 的通道修改端口
+//  - load：loadChannels 全量读取
+//  - changes：读取 1% 修改后的增量变更（运行中实例的热重载路径）
+// 用法: ./bench_database [channels] [db_path]
+#include "../database.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+std::vector<ChannelConfig> makeChannels(size_t count) {
+    std::vector<ChannelConfig> channels(count);
+    for (size_t i = 0; i < count; ++i) {
+        ChannelConfig& channel = channels[i];
+        channel.name = "Channel " + std::to_string(i + 1);
+        channel.input.type = "tcp_server";
+        channel.input.port = static_cast<uint16_t>(10000 + i % 50000);
+        channel.output.type = "tcp_client";
+        channel.output.ip = "10.0." + std::to_string(i / 256 % 256) + "." + std::to_string(i % 256);
+        channel.output.port = 502;
+    }
+    return channels;
+}
+
+void removeDatabase(const std::string& path) {
+    for (const char* suffix : {"", "-wal", "-shm"}) {
+        std::remove((path + suffix).c_str());
+    }
+}
+
+void report(const char* step, double ms, size_t rows) {
+    std::cout << std::left << std::setw(16) << step << std::setw(12) << ms << rows << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 50000;
+    std::string path = argc > 2 ? argv[2] : "bench_config.db";
+    removeDatabase(path);
+
+    auto channels = makeChannels(count);
+    bool ok = true;
+    {
+        Database db(path);
+        std::cout << "channels=" << count << std::endl;
+        std::cout << std::left << std::setw(16) << "step" << std::setw(12) << "ms" << "rows" << std::endl;
+        std::cout << std::fixed << std::setprecision(1);
+
+        auto start = Clock::now();
+        db.replaceChannels(channels);
+        report("replace(new)", elapsedMs(start), count);
+
+        start = Clock::now();
+        auto loaded = db.loadChannels();
+        report("load", elapsedMs(start), loaded.size());
+        ok = ok && loaded.size() == count;
+
+        const int64_t version = db.loadChangesSince(-1).version;
+        start = Clock::now();
+        db.replaceChannels(channels);
+        report("replace(same)", elapsedMs(start), 0);
+
+        size_t modified = 0;
+        for (size_t i = 0; i < count; i += 100) {
+            channels[i].output.port = 503;
+            ++modified;
+        }
+        start = Clock::now();
+        db.replaceChannels(channels);
+        report("replace(1%)", elapsedMs(start), modified);
+
+        start = Clock::now();
+        ChannelChanges changes = db.loadChangesSince(version);
+        report("changes", elapsedMs(start), changes.changed.size());
+        ok = ok && changes.changed.size() == modified && changes.removed.empty();
+    }
+    removeDatabase(path);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,115 @@
+// framer_bench.cpp
+// 分帧器基准：按随机长度（1 ~ 1500 字节）切分的字节流依次输入各分帧器，统计吞吐并校验帧数与帧内容
+//  - length / delimiter / fixed：帧长度 64 字节
+//  - gap：每段数据之间间隔超过帧间隔，每段输出一帧
+// 用法: ./bench_framer [megabytes]
+#include "../framer.h"
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+#include <cstdlib>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t kFrameSize = 64;
+
+// 每帧：2 字节长度（大端，不含长度字段）+ 填充 + '\n' 结尾
+std::vector<uint8_t> makeStream(size_t bytes) {
+    std::vector<uint8_t> stream(bytes / kFrameSize * kFrameSize);
+    for (size_t offset = 0; offset < stream.size(); offset += kFrameSize) {
+        stream[offset] = 0;
+        stream[offset + 1] = kFrameSize - 2;
+        for (size_t i = 2; i < kFrameSize - 1; ++i) stream[offset + i] = static_cast<uint8_t>('a' + i % 26);
+        stream[offset + kFrameSize - 1] = '\n';
+    }
+    return stream;
+}
+
+struct Run {
+    size_t frames = 0;
+    size_t bad = 0;    // 帧长度不符
+    size_t dropped = 0;
+    double seconds = 0;
+};
+
+Run feed(Framer& framer, const std::vector<uint8_t>& stream, const std::vector<size_t>& chunks, bool gaps,
+         size_t expectedSize) {
+    Run run;
+    framer.setFrameCallback([&](const uint8_t*, size_t len) {
+        ++run.frames;
+        if (expectedSize && len != expectedSize) ++run.bad;
+    });
+    framer.setDiscardCallback([&](const char*, size_t len) { run.dropped += len; });
+
+    // gap：以虚拟时间输入，每段之间相隔 1 秒
+    auto now = Clock::now();
+    const auto start = Clock::now();
+    size_t offset = 0;
+    for (size_t chunk : chunks) {
+        framer.feed(stream.data() + offset, chunk, now);
+        offset += chunk;
+        if (gaps) now += std::chrono::seconds(1);
+    }
+    framer.flushIdle(now + std::chrono::seconds(1));
+    run.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return run;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const size_t megabytes = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 64;
+    const std::vector<uint8_t> stream = makeStream(megabytes * 1024 * 1024);
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<size_t> length(1, 1500);
+    std::vector<size_t> chunks;
+    for (size_t offset = 0; offset < stream.size();) {
+        const size_t chunk = std::min(length(rng), stream.size() - offset);
+        chunks.push_back(chunk);
+        offset += chunk;
+    }
+
+    EndpointConfig lengthConfig;
+    lengthConfig.framing = "length";
+    EndpointConfig delimiterConfig;
+    delimiterConfig.framing = "delimiter";
+    delimiterConfig.frame_delimiter = "\n";
+    EndpointConfig fixedConfig;
+    fixedConfig.framing = "fixed";
+    fixedConfig.frame_size = kFrameSize;
+    EndpointConfig gapConfig;
+    gapConfig.framing = "gap";
+
+    struct Case {
+        const char* name;
+        const EndpointConfig& config;
+        bool gaps;
+        size_t expectedFrames;
+        size_t expectedSize;
+    };
+    const Case cases[] = {
+        {"length", lengthConfig, false, stream.size() / kFrameSize, kFrameSize},
+        {"delimiter", delimiterConfig, false, stream.size() / kFrameSize, kFrameSize},
+        {"fixed", fixedConfig, false, stream.size() / kFrameSize, kFrameSize},
+        {"gap", gapConfig, true, chunks.size(), 0},
+    };
+
+    std::cout << "bytes=" << stream.size() << " chunks=" << chunks.size() << std::endl;
+    std::cout << std::left << std::setw(12) << "framer" << std::setw(12) << "MB/s" << std::setw(12) << "frames"
+              << "ok" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    bool ok = true;
+    for (const Case& c : cases) {
+        auto framer = Framer::create(c.config);
+        const Run run = feed(*framer, stream, chunks, c.gaps, c.expectedSize);
+        const bool good = run.frames == c.expectedFrames && run.bad == 0 && run.dropped == 0;
+        ok = ok && good;
+        std::cout << std::left << std::setw(12) << c.name << std::setw(12) << stream.size() / run.seconds / 1e6
+                  << std::setw(12) << run.frames << (good ? "yes" : "NO") << std::endl;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,176 @@
+// io_backend_bench.cpp
+// I/O 后端对比基准（回环地址，真实端点对象）：
+//  - UDP 接收：UdpServerEndpoint 每秒交付的数据报数
+//  - TCP 接收：TcpServerEndpoint 每秒交付的字节数
+//  - UDP 广播：UdpServerEndpoint::writev 向多个客户端送达的数据报数
+// 用法: ./bench_io_backend <epoll|io_uring> [seconds] [clients]
+// Reactor 为进程单例，两种后端需分别运行一次（make bench-run 会依次运行）
+#include "../reactor.h"
+#include "../udp_server_endpoint.h"
+#include "../tcp_server_endpoint.h"
+#include "../udp_batch.h"
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <vector>
+#include <cstdlib>
+#include <unistd.h>
+#include <arpa/inet.h>
+
+namespace {
+
+constexpr uint16_t kUdpPort = 19731;
+constexpr uint16_t kTcpPort = 19732;
+constexpr uint16_t kFanoutPort = 19733;
+
+sockaddr_in loopback(uint16_t port) {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    return addr;
+}
+
+void quiet(Endpoint& endpoint) {
+    endpoint.setLogCallback([](const std::string&) {});
+    endpoint.setErrorCallback([](const std::string&) {});
+}
+
+double udpReceive(double seconds) {
+    UdpServerEndpoint server(kUdpPort);
+    quiet(server);
+    std::atomic<size_t> received{0};
+    server.setDataCallback([&](const uint8_t*, size_t) {
+        received.fetch_add(1, std::memory_order_relaxed);
+    });
+    if (!server.open()) {
+        std::cerr << "UDP server open failed" << std::endl;
+        std::exit(1);
+    }
+
+    int tx = socket(AF_INET, SOCK_DGRAM, 0);
+    std::vector<uint8_t> packet(64, 0x5A);
+    struct iovec iov{packet.data(), packet.size()};
+    std::vector<sockaddr_in> targets(UdpFanout::kBatchSize, loopback(kUdpPort));
+    UdpFanout fanout;
+
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + std::chrono::duration<double>(seconds);
+    while (std::chrono::steady_clock::now() < deadline) {
+        fanout.send(tx, &iov, 1, targets.data(), targets.size(), [](size_t, int) {});
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    const size_t total = received.load();
+
+    ::close(tx);
+    server.close();
+    return total / elapsed.count();
+}
+
+double tcpReceive(double seconds) {
+    TcpServerEndpoint server(kTcpPort);
+    quiet(server);
+    std::atomic<size_t> received{0};
+    server.setDataCallback([&](const uint8_t*, size_t len) {
+        received.fetch_add(len, std::memory_order_relaxed);
+    });
+    if (!server.open()) {
+        std::cerr << "TCP server open failed" << std::endl;
+        std::exit(1);
+    }
+
+    int tx = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr = loopback(kTcpPort);
+    if (connect(tx, (sockaddr*)&addr, sizeof(addr)) < 0) {
+        std::cerr << "TCP connect failed" << std::endl;
+        std::exit(1);
+    }
+
+    std::vector<uint8_t> chunk(4096, 0x5A);
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + std::chrono::duration<double>(seconds);
+    while (std::chrono::steady_clock::now() < deadline) {
+        if (send(tx, chunk.data(), chunk.size(), 0) < 0) break;
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    const size_t total = received.load();
+
+    ::close(tx);
+    server.close();
+    return total / elapsed.count();
+}
+
+double udpFanout(size_t clients, double seconds) {
+    UdpServerEndpoint server(kFanoutPort);
+    quiet(server);
+    if (!server.open()) {
+        std::cerr << "UDP fan-out server open failed" << std::endl;
+        std::exit(1);
+    }
+
+    // 每个客户端先发一个数据报完成注册
+    std::vector<int> sinks;
+    sockaddr_in serverAddr = loopback(kFanoutPort);
+    for (size_t i = 0; i < clients; ++i) {
+        int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+        int rcvbuf = 4 * 1024 * 1024;
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+        sendto(fd, "hi", 2, 0, (sockaddr*)&serverAddr, sizeof(serverAddr));
+        sinks.push_back(fd);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    std::atomic<bool> running{true};
+    std::atomic<size_t> delivered{0};
+    std::thread drainer([&] {
+        UdpRecvBatch batch(UdpServerEndpoint::kMaxDatagramSize);
+        while (running.load(std::memory_order_relaxed)) {
+            for (int fd : sinks) {
+                int n = batch.receive(fd);
+                if (n > 0) delivered.fetch_add(n, std::memory_order_relaxed);
+            }
+        }
+    });
+
+    uint8_t packet[64] = {0x5A};
+    struct iovec iov{packet, sizeof(packet)};
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + std::chrono::duration<double>(seconds);
+    while (std::chrono::steady_clock::now() < deadline) {
+        server.writev(&iov, 1);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    const size_t total = delivered.load();
+
+    running = false;
+    drainer.join();
+    for (int fd : sinks) ::close(fd);
+    server.close();
+    return total / elapsed.count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Reactor::Backend backend = Reactor::Backend::Epoll;
+    if (argc < 2 || !Reactor::parseBackend(argv[1], backend)) {
+        std::cerr << "Usage: " << argv[0] << " <epoll|io_uring> [seconds] [clients]" << std::endl;
+        return 1;
+    }
+    double seconds = argc > 2 ? std::strtod(argv[2], nullptr) : 1.0;
+    size_t clients = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 16;
+
+    Reactor::init(1, backend);
+    const bool uring = Reactor::getInstance().getLoop(0)->hasIoUring();
+
+    std::cout << "backend: " << (uring ? "io_uring" : "epoll") << std::endl;
+    std::cout << std::fixed << std::setprecision(0);
+    std::cout << std::left << std::setw(28) << "udp receive (packets/s)" << udpReceive(seconds) << std::endl;
+    std::cout << std::left << std::setw(28) << "tcp receive (MB/s)" << std::setprecision(1)
+              << tcpReceive(seconds) / (1024 * 1024) << std::setprecision(0) << std::endl;
+    std::cout << std::left << std::setw(28) << ("udp fan-out x" + std::to_string(clients) + " (packets/s)")
+              << udpFanout(clients, seconds) << std::endl;
+    return 0;
+}
@@ -0,0 +1,77 @@
+// latency_bench.cpp
+// 转发延迟直方图基准：
+//  - record：LatencyTracker 登记 + 写出确认 + 直方图计数的单次开销（热路径上每个包各一次）
+//  - accuracy：对数分布的样本，对比直方图分位数与排序得到的精确分位数
+// 用法: ./bench_latency [samples]
+#include "../latency_histogram.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+uint64_t exactQuantile(const std::vector<uint64_t>& sorted, uint64_t permille) {
+    const uint64_t rank = std::max<uint64_t>((sorted.size() * permille + 999) / 1000, 1);
+    return sorted[rank - 1];
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t samples = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+
+    // 每个样本：生产者登记 100 字节，消费者随即确认写出
+    LatencyTracker tracker;
+    LatencyHistogram histogram;
+    auto start = Clock::now();
+    for (size_t i = 0; i < samples; ++i) {
+        const auto now = Clock::now();
+        tracker.received(100, now);
+        tracker.written(100, now + std::chrono::nanoseconds(i & 0xFFFF), histogram);
+    }
+    const double recordNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / samples;
+    // 上面的时间包含两次 Clock::now()，单独测量后扣除
+    start = Clock::now();
+    volatile int64_t sink = 0;
+    for (size_t i = 0; i < samples; ++i) {
+        sink = sink + Clock::now().time_since_epoch().count();
+    }
+    const double clockNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / samples;
+
+    // 精度：10us ~ 10ms 的对数正态分布
+    std::mt19937_64 rng(42);
+    std::lognormal_distribution<double> distribution(std::log(100000.0), 1.0);
+    std::vector<uint64_t> values(samples);
+    LatencyHistogram accuracy;
+    for (auto& value : values) {
+        value = static_cast<uint64_t>(distribution(rng));
+        accuracy.record(value);
+    }
+    std::sort(values.begin(), values.end());
+    const LatencySummary summary = accuracy.summary();
+
+    std::cout << "samples=" << samples << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "record " << recordNs - clockNs << " ns/sample (clock " << clockNs << " ns)" << std::endl;
+    std::cout << std::left << std::setw(8) << "q" << std::setw(14) << "exact_ns" << std::setw(14) << "hist_ns"
+              << "error" << std::endl;
+    const char* const labels[3] = {"p50", "p99", "p99.9"};
+    const uint64_t permilles[3] = {500, 990, 999};
+    const uint64_t measured[3] = {summary.p50, summary.p99, summary.p999};
+    bool ok = summary.count == samples && summary.max == values.back();
+    for (int i = 0; i < 3; ++i) {
+        const uint64_t exact = exactQuantile(values, permilles[i]);
+        const double error = (static_cast<double>(measured[i]) - exact) / exact * 100;
+        // 取桶上界：不小于精确值，且相对误差不超过一个子桶（12.5%）
+        ok = ok && measured[i] >= exact && error <= 12.5;
+        std::cout << std::left << std::setw(8) << labels[i] << std::setw(14) << exact
+                  << std::setw(14) << measured[i] << "+" << error << "%" << std::endl;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,123 @@
+// log_bench.cpp
+// LogRecord 基准：对比旧的同步实现（全局互斥锁 + 每行 flush）与异步批量实现
+//  - 多个线程并发调用 LOG_BINARY（模拟各通道数据回调中的报文日志）
+//  - 统计调用方每次调用的平均耗时，以及全部写入磁盘的总耗时
+// 用法: ./bench_log [messages_per_thread] [threads] [payload]
+#include "../logrecord.h"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <cstdlib>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// 旧实现的写入路径，仅用于对比：格式化后持锁写入 ofstream 并立即 flush
+class SyncLog {
+public:
+    explicit SyncLog(const std::string& dir) : dir_(dir) {}
+
+    void logBinary(const std::string& channel, const std::string& prefix, const uint8_t* data, size_t len) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& file = files_[channel];
+        if (!file.is_open()) {
+            file.open(dir_ + "/" + channel + ".sync.txt", std::ios::out | std::ios::app | std::ios::binary);
+        }
+        file << timeStr() << " " << prefix << std::to_string(len) << " bytes: ";
+        for (size_t i = 0; i < len; i++) {
+            file << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(data[i]);
+            if (i < len - 1) file << " ";
+        }
+        file << '\n';
+        file.flush();
+    }
+
+private:
+    static std::string timeStr() {
+        auto now = std::chrono::system_clock::now();
+        auto now_time = std::chrono::system_clock::to_time_t(now);
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()) % 1000;
+        std::tm tm;
+        localtime_r(&now_time, &tm);
+        std::ostringstream oss;
+        oss << std::put_time(&tm, "%Y-%m-%d %H:%M:%S") << '.' << std::setfill('0') << std::setw(3) << ms.count();
+        return oss.str();
+    }
+
+    std::string dir_;
+    std::mutex mutex_;
+    std::map<std::string, std::ofstream> files_;
+};
+
+struct Result {
+    double call_ns;   // 调用方平均耗时
+    double total_sec; // 全部写出的耗时
+};
+
+template <typename Log>
+Result run(Log&& log, size_t messages, size_t threads, size_t payload) {
+    std::vector<uint8_t> packet(payload, 0x5A);
+    std::vector<double> call_ns(threads, 0);
+
+    auto start = Clock::now();
+    std::vector<std::thread> producers;
+    for (size_t t = 0; t < threads; ++t) {
+        producers.emplace_back([&, t] {
+            const std::string channel = "Channel " + std::to_string(t % 4 + 1);
+            auto begin = Clock::now();
+            for (size_t i = 0; i < messages; ++i) {
+                log(channel, packet.data(), packet.size());
+            }
+            call_ns[t] = std::chrono::duration<double, std::nano>(Clock::now() - begin).count() / messages;
+        });
+    }
+    for (auto& producer : producers) producer.join();
+    LogRecord::flush();
+    std::chrono::duration<double> total = Clock::now() - start;
+
+    double sum = 0;
+    for (double ns : call_ns) sum += ns;
+    return {sum / threads, total.count()};
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t messages = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 50000;
+    size_t threads = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 4;
+    size_t payload = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 64;
+
+    char dir_template[] = "/tmp/bench_log_XXXXXX";
+    const char* dir = mkdtemp(dir_template);
+    if (!dir) {
+        std::cerr << "mkdtemp failed" << std::endl;
+        return 1;
+    }
+    LogRecord::init(false, true, dir);
+
+    SyncLog sync(dir);
+    Result locked = run([&](const std::string& channel, const uint8_t* data, size_t len) {
+        sync.logBinary(channel, "[NODE1 RECV]", data, len);
+    }, messages, threads, payload);
+    Result async = run([](const std::string& channel, const uint8_t* data, size_t len) {
+        LOG_BINARY(channel, "[NODE1 RECV]", data, len);
+    }, messages, threads, payload);
+
+    std::cout << "threads=" << threads << " payload=" << payload << " dir=" << dir << std::endl;
+    std::cout << std::left << std::setw(10) << "log"
+              << std::setw(16) << "ns/call"
+              << "total s" << std::endl;
+    std::cout << std::fixed << std::setprecision(0);
+    std::cout << std::left << std::setw(10) << "sync" << std::setw(16) << locked.call_ns
+              << std::setprecision(3) << locked.total_sec << std::setprecision(0) << std::endl;
+    std::cout << std::left << std::setw(10) << "async" << std::setw(16) << async.call_ns
+              << std::setprecision(3) << async.total_sec << std::endl;
+    std::cout << "dropped " << LogRecord::droppedCount() << std::endl;
+    return 0;
+}
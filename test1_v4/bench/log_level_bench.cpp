@@ -0,0 +1,99 @@
+// log_level_bench.cpp
+// 日志级别过滤基准：统计未启用的日志调用在调用方的开销
+//  - compiled out：低于编译期级别下限的宏（本程序以 LOG_MIN_LEVEL=1 编译，CH_LOG_DEBUG 不生成代码）
+//  - runtime off：通道运行时级别高于调用级别，宏展开处一次 relaxed 原子读取后返回
+//  - packet off：通道级别为 info 时的 LOG_BINARY / LOG_BINARY_TEXT
+//  - format only：旧实现在判断前必须完成的格式化（vsnprintf 到 1KB 缓冲区），作为对照
+//  - enabled：实际写入文件日志（含入队，不含后台写出）
+// 用法: ./bench_log_level [iterations]
+#include "../logrecord.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// 阻止编译器把循环整体优化掉
+inline void barrier() {
+    asm volatile("" ::: "memory");
+}
+
+template <typename Fn>
+double measure(size_t iterations, Fn&& fn) {
+    auto start = Clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        fn(i);
+        barrier();
+    }
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / iterations;
+}
+
+__attribute__((noinline)) int formatOnly(char* buffer, size_t size, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(buffer, size, format, args);
+    va_end(args);
+    return len;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t iterations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+
+    char dir_template[] = "/tmp/bench_log_level_XXXXXX";
+    const char* dir = mkdtemp(dir_template);
+    if (!dir) {
+        std::cerr << "mkdtemp failed" << std::endl;
+        return 1;
+    }
+    LogRecord::init(false, true, dir);
+
+    LogChannel channel("Channel 1", LogLevel::WARNING);
+    std::vector<uint8_t> packet(64, 0x5A);
+    const std::string peer = "192.168.1.10:5000";
+
+    struct Row {
+        const char* name;
+        double ns;
+    };
+    std::vector<Row> rows;
+
+    rows.push_back({"compiled out", measure(iterations, [&](size_t i) {
+        CH_LOG_DEBUG(channel, "client %s sent %zu bytes (seq %zu)", peer.c_str(), packet.size(), i);
+    })});
+    rows.push_back({"runtime off", measure(iterations, [&](size_t i) {
+        CH_LOG_INFO(channel, "client %s sent %zu bytes (seq %zu)", peer.c_str(), packet.size(), i);
+    })});
+    channel.setLevel(LogLevel::INFO);
+    rows.push_back({"packet off", measure(iterations, [&](size_t) {
+        LOG_BINARY(channel, "[NODE1 RECV]", packet.data(), packet.size());
+        LOG_BINARY_TEXT(channel, "[NODE1->NODE2]", packet.data(), packet.size());
+    })});
+    rows.push_back({"format only", measure(iterations, [&](size_t i) {
+        char buffer[1024];
+        formatOnly(buffer, sizeof(buffer), "client %s sent %zu bytes (seq %zu)", peer.c_str(), packet.size(), i);
+    })});
+
+    // 实际写入：次数较少，避免队列长时间处于满状态
+    const size_t enabledIterations = std::min<size_t>(iterations, 200000);
+    rows.push_back({"enabled", measure(enabledIterations, [&](size_t i) {
+        CH_LOG_INFO(channel, "client %s sent %zu bytes (seq %zu)", peer.c_str(), packet.size(), i);
+    })});
+    LogRecord::flush();
+
+    std::cout << "LOG_MIN_LEVEL=" << LOG_MIN_LEVEL << " iterations=" << iterations << " dir=" << dir << std::endl;
+    std::cout << std::left << std::setw(16) << "case" << "ns/call" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    for (const Row& row : rows) {
+        std::cout << std::left << std::setw(16) << row.name << row.ns << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,69 @@
+// metrics_bench.cpp
+// 通道计数器基准：多个线程同时更新同一通道的计数器（模拟事件循环线程与转发线程）
+//  - shared：所有线程对同一组原子计数器做 fetch_add（同一缓存行来回迁移）
+//  - sharded：ChannelMetrics 按线程分片，读取时汇总
+// 用法: ./bench_metrics [updates_per_thread] [threads]
+#include "../channel_metrics.h"
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <cstdlib>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// 与分片前的写法相同：每个方向一组连续的原子计数器
+struct SharedCounters {
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> packets{0};
+};
+
+template <typename Fn>
+double run(size_t updates, size_t threads, Fn&& update) {
+    auto start = Clock::now();
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&] {
+            for (size_t i = 0; i < updates; ++i) {
+                update(i);
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / (updates * threads);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t updates = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 5000000;
+    size_t threads = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 4;
+
+    SharedCounters shared;
+    double sharedNs = run(updates, threads, [&](size_t i) {
+        shared.bytes.fetch_add(i & 0xFF, std::memory_order_relaxed);
+        shared.packets.fetch_add(1, std::memory_order_relaxed);
+    });
+
+    ChannelMetrics metrics;
+    double shardedNs = run(updates, threads, [&](size_t i) {
+        metrics.add(0, ChannelMetrics::BytesIn, i & 0xFF);
+        metrics.add(0, ChannelMetrics::PacketsIn);
+    });
+
+    auto readStart = Clock::now();
+    DirectionStats stats = metrics.read(0);
+    double readNs = std::chrono::duration<double, std::nano>(Clock::now() - readStart).count();
+
+    std::cout << "threads=" << threads << " updates/thread=" << updates << std::endl;
+    std::cout << std::left << std::setw(10) << "counters" << "ns/update" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << std::left << std::setw(10) << "shared" << sharedNs << std::endl;
+    std::cout << std::left << std::setw(10) << "sharded" << shardedNs << std::endl;
+    std::cout << "read " << std::setprecision(0) << readNs << " ns, packets "
+              << stats.packets_in << " (expected " << updates * threads << ")" << std::endl;
+    return stats.packets_in == shared.packets.load() ? 0 : 1;
+}
@@ -0,0 +1,120 @@
+// ring_buffer_bench.cpp
+// RingBuffer 微基准：对比旧的互斥锁实现与 SPSC 无锁实现
+// 用法: ./bench_ring_buffer [messages]
+#include "../ring_buffer.h"
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <chrono>
+#include <mutex>
+#include <vector>
+#include <cstdlib>
+
+namespace {
+
+// 旧实现（互斥锁保护），仅用于对比
+class MutexRingBuffer {
+public:
+    explicit MutexRingBuffer(size_t capacity)
+        : buffer_(capacity), capacity_(capacity) {}
+
+    bool push(const uint8_t* data, size_t size) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (size > capacity_ - count_) return false;
+        size_t first_part = std::min(size, capacity_ - write_pos_);
+        std::copy(data, data + first_part, buffer_.begin() + write_pos_);
+        if (size > first_part) {
+            std::copy(data + first_part, data + size, buffer_.begin());
+            write_pos_ = size - first_part;
+        } else {
+            write_pos_ += first_part;
+            if (write_pos_ >= capacity_) write_pos_ -= capacity_;
+        }
+        count_ += size;
+        return true;
+    }
+
+    size_t pop(uint8_t* data, size_t max_size) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (count_ == 0) return 0;
+        size_t to_read = std::min(count_, max_size);
+        size_t first_part = std::min(to_read, capacity_ - read_pos_);
+        std::copy(buffer_.begin() + read_pos_,
+                  buffer_.begin() + read_pos_ + first_part, data);
+        if (to_read > first_part) {
+            std::copy(buffer_.begin(), buffer_.begin() + (to_read - first_part),
+                      data + first_part);
+            read_pos_ = to_read - first_part;
+        } else {
+            read_pos_ += first_part;
+            if (read_pos_ >= capacity_) read_pos_ -= capacity_;
+        }
+        count_ -= to_read;
+        return to_read;
+    }
+
+    bool empty() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return count_ == 0;
+    }
+
+private:
+    std::vector<uint8_t> buffer_;
+    size_t capacity_;
+    size_t read_pos_ = 0;
+    size_t write_pos_ = 0;
+    size_t count_ = 0;
+    mutable std::mutex mutex_;
+};
+
+// 模拟 ProtocolChannel 的使用方式：生产者逐包 push，消费者每轮 pop 后检查 empty()
+template <typename Buffer>
+double run(size_t payload, size_t messages) {
+    Buffer ring(1024 * 1024);
+    std::vector<uint8_t> packet(payload, 0x5A);
+    const size_t total = payload * messages;
+
+    auto start = std::chrono::steady_clock::now();
+    std::thread consumer([&] {
+        uint8_t buffer[4096];
+        size_t received = 0;
+        while (received < total) {
+            size_t len;
+            while ((len = ring.pop(buffer, sizeof(buffer)))) {
+                received += len;
+            }
+            if (ring.empty()) std::this_thread::yield();
+        }
+    });
+
+    for (size_t i = 0; i < messages; ++i) {
+        while (!ring.push(packet.data(), packet.size())) {
+            std::this_thread::yield();
+        }
+    }
+    consumer.join();
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return messages / elapsed.count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t messages = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+
+    std::cout << std::left << std::setw(10) << "payload"
+              << std::setw(18) << "mutex msgs/s"
+              << std::setw(18) << "spsc msgs/s"
+              << "speedup" << std::endl;
+
+    for (size_t payload : {64, 1024, 4096}) {
+        double locked = run<MutexRingBuffer>(payload, messages);
+        double spsc = run<RingBuffer>(payload, messages);
+        std::cout << std::left << std::setw(10) << payload
+                  << std::setw(18) << std::fixed << std::setprecision(0) << locked
+                  << std::setw(18) << spsc
+                  << std::setprecision(2) << spsc / locked << "x" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,140 @@
+// scheduling_bench.cpp
+// 转发任务调度方式对比：共享调度（任意线程执行，工作窃取）与通道亲和调度（enqueueTo 固定线程）
+//  - 每个模拟通道持有一块私有状态（代替 RingBuffer 与端点状态），任务读写其中一段
+//  - 生产者按固定速率向随机通道提交任务，统计提交到完成的延迟分位数
+// 用法: ./bench_scheduling [tasks] [channels] [workers] [cpus]
+//   cpus 非空时工作线程依次绑定到这些 CPU（如 "0-3"）
+#include "../thread_pool.h"
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t kChannelState = 256 * 1024;
+constexpr size_t kTouchBytes = 16 * 1024;
+
+struct Channel {
+    std::vector<uint8_t> state = std::vector<uint8_t>(kChannelState, 1);
+    size_t offset = 0; // 仅在任务中访问（同一通道的任务可能并发，仅作负载模拟）
+};
+
+struct Result {
+    double tasks_per_sec;
+    double p50_us;
+    double p99_us;
+    double p999_us;
+};
+
+std::vector<int> parseCpus(const char* list) {
+    std::vector<int> cpus;
+    std::string s(list);
+    size_t pos = 0;
+    while (pos < s.size()) {
+        size_t comma = s.find(',', pos);
+        if (comma == std::string::npos) comma = s.size();
+        std::string item = s.substr(pos, comma - pos);
+        size_t dash = item.find('-');
+        int first = std::atoi(item.c_str());
+        int last = dash == std::string::npos ? first : std::atoi(item.c_str() + dash + 1);
+        for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+        pos = comma + 1;
+    }
+    return cpus;
+}
+
+Result run(bool affine, size_t tasks, size_t channel_count, size_t workers, const std::vector<int>& cpus) {
+    ThreadPool pool(workers);
+    for (size_t i = 0; i < cpus.size() && i < workers; ++i) {
+        pool.pinWorker(i, cpus[i]);
+    }
+
+    std::vector<Channel> channels(channel_count);
+    std::vector<uint32_t> latency_ns(tasks, 0);
+    std::atomic<size_t> done{0};
+    std::atomic<uint64_t> checksum{0};
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<size_t> pick(0, channel_count - 1);
+
+    auto start = Clock::now();
+    for (size_t i = 0; i < tasks; ++i) {
+        const size_t c = pick(rng);
+        Channel* channel = &channels[c];
+        const auto submitted = Clock::now();
+        auto task = [channel, submitted, &latency_ns, &done, &checksum, i] {
+            uint64_t sum = 0;
+            uint8_t* p = channel->state.data() + channel->offset;
+            for (size_t k = 0; k < kTouchBytes; k += 64) {
+                sum += p[k];
+                p[k] = static_cast<uint8_t>(sum);
+            }
+            channel->offset = (channel->offset + kTouchBytes) % kChannelState;
+            checksum.fetch_add(sum, std::memory_order_relaxed);
+            latency_ns[i] = static_cast<uint32_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - submitted).count());
+            done.fetch_add(1, std::memory_order_release);
+        };
+        if (affine) {
+            pool.enqueueTo(c % workers, std::move(task));
+        } else {
+            pool.enqueue(std::move(task));
+        }
+
+        // 控制在途任务数量，模拟持续而非突发的流量
+        while (i + 1 - done.load(std::memory_order_acquire) > workers * 8) {
+            std::this_thread::yield();
+        }
+    }
+    while (done.load(std::memory_order_acquire) < tasks) {
+        std::this_thread::yield();
+    }
+    std::chrono::duration<double> elapsed = Clock::now() - start;
+
+    std::sort(latency_ns.begin(), latency_ns.end());
+    auto percentile = [&](double q) {
+        return latency_ns[static_cast<size_t>(q * (tasks - 1))] / 1000.0;
+    };
+    return {tasks / elapsed.count(), percentile(0.50), percentile(0.99), percentile(0.999)};
+}
+
+void print(const char* name, const Result& r) {
+    std::cout << std::left << std::setw(10) << name
+              << std::setw(14) << std::fixed << std::setprecision(0) << r.tasks_per_sec
+              << std::setw(12) << std::setprecision(1) << r.p50_us
+              << std::setw(12) << r.p99_us
+              << r.p999_us << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t tasks = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+    size_t channels = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 16;
+    size_t workers = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 4;
+    std::vector<int> cpus = argc > 4 ? parseCpus(argv[4]) : std::vector<int>{};
+    if (tasks == 0 || channels == 0 || workers == 0) {
+        std::cerr << "Usage: " << argv[0] << " [tasks] [channels] [workers] [cpus]" << std::endl;
+        return 1;
+    }
+
+    std::cout << "channels=" << channels << " workers=" << workers
+              << (cpus.empty() ? "" : " pinned") << std::endl;
+    std::cout << std::left << std::setw(10) << "mode"
+              << std::setw(14) << "tasks/s"
+              << std::setw(12) << "p50 us"
+              << std::setw(12) << "p99 us"
+              << "p99.9 us" << std::endl;
+    print("shared", run(false, tasks, channels, workers, cpus));
+    print("affine", run(true, tasks, channels, workers, cpus));
+    return 0;
+}
@@ -0,0 +1,79 @@
+// stats_bench.cpp
+// 统计接口基准：模拟上千个通道，统计一次抓取在统计线程中的开销
+//  - snapshot：汇总各通道的分片计数器（ChannelMetrics::read）
+//  - prometheus / json：格式化输出
+// 用法: ./bench_stats [channels] [rounds]
+#include "../stats_server.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <string>
+#include <cstdlib>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedUs(Clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t channels = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000;
+    size_t rounds = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 20;
+
+    std::vector<std::unique_ptr<ChannelMetrics>> metrics;
+    for (size_t i = 0; i < channels; ++i) {
+        metrics.push_back(std::make_unique<ChannelMetrics>());
+        for (int direction = 0; direction < 2; ++direction) {
+            metrics[i]->add(direction, ChannelMetrics::BytesIn, 1000 * (i + 1));
+            metrics[i]->add(direction, ChannelMetrics::PacketsIn, i + 1);
+            metrics[i]->updateHighWater(direction, 4096);
+        }
+    }
+
+    double snapshotUs = 0;
+    double prometheusUs = 0;
+    double jsonUs = 0;
+    size_t prometheusSize = 0;
+    size_t jsonSize = 0;
+    for (size_t round = 0; round < rounds; ++round) {
+        auto start = Clock::now();
+        StatsSnapshot snapshot;
+        snapshot.pool_threads = 12;
+        snapshot.channels.reserve(channels);
+        for (size_t i = 0; i < channels; ++i) {
+            ChannelStats stats;
+            stats.name = "Channel " + std::to_string(i + 1);
+            stats.ring_capacity = 1024 * 1024;
+            stats.directions[0] = metrics[i]->read(0);
+            stats.directions[1] = metrics[i]->read(1);
+            stats.endpoints[0].type = "tcp_server";
+            stats.endpoints[0].connected = true;
+            stats.endpoints[0].clients = 1;
+            stats.endpoints[1].type = "tcp_client";
+            snapshot.channels.push_back(std::move(stats));
+        }
+        snapshotUs += elapsedUs(start);
+
+        start = Clock::now();
+        prometheusSize = StatsServer::renderPrometheus(snapshot).size();
+        prometheusUs += elapsedUs(start);
+
+        start = Clock::now();
+        jsonSize = StatsServer::renderJson(snapshot).size();
+        jsonUs += elapsedUs(start);
+    }
+
+    std::cout << "channels=" << channels << " rounds=" << rounds << std::endl;
+    std::cout << std::left << std::setw(12) << "step" << std::setw(12) << "us/scrape" << "bytes" << std::endl;
+    std::cout << std::fixed << std::setprecision(0);
+    std::cout << std::left << std::setw(12) << "snapshot" << std::setw(12) << snapshotUs / rounds << "-" << std::endl;
+    std::cout << std::left << std::setw(12) << "prometheus" << std::setw(12) << prometheusUs / rounds << prometheusSize << std::endl;
+    std::cout << std::left << std::setw(12) << "json" << std::setw(12) << jsonUs / rounds << jsonSize << std::endl;
+    return 0;
+}
@@ -0,0 +1,143 @@
+// thread_pool_bench.cpp
+// ThreadPool 微基准：对比旧的单队列（互斥锁 + 条件变量 + std::function）实现与工作窃取实现
+//  - 多个生产者线程并发提交小任务（模拟多个通道的事件循环调用 scheduleForward）
+//  - 统计每个任务的堆分配次数（替换全局 operator new 计数）
+// 用法: ./bench_thread_pool [tasks] [producers] [workers]
+#include "../thread_pool.h"
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <chrono>
+#include <queue>
+#include <functional>
+#include <vector>
+#include <cstdlib>
+#include <new>
+
+namespace {
+std::atomic<size_t> g_allocations{0};
+} // namespace
+
+void* operator new(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+namespace {
+
+// 旧实现，仅用于对比
+class MutexThreadPool {
+public:
+    explicit MutexThreadPool(size_t num_threads) : running_(true) {
+        for (size_t i = 0; i < num_threads; ++i) {
+            workers_.emplace_back([this] {
+                while (running_) {
+                    std::function<void()> task;
+                    {
+                        std::unique_lock<std::mutex> lock(queue_mutex_);
+                        condition_.wait(lock, [this] {
+                            return !tasks_.empty() || !running_;
+                        });
+                        if (!running_ && tasks_.empty()) return;
+                        task = std::move(tasks_.front());
+                        tasks_.pop();
+                    }
+                    task();
+                }
+            });
+        }
+    }
+
+    ~MutexThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            running_ = false;
+        }
+        condition_.notify_all();
+        for (auto& worker : workers_) worker.join();
+    }
+
+    template<typename F>
+    void enqueue(F&& f) {
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            tasks_.emplace(std::forward<F>(f));
+        }
+        condition_.notify_one();
+    }
+
+private:
+    std::vector<std::thread> workers_;
+    std::queue<std::function<void()>> tasks_;
+    std::mutex queue_mutex_;
+    std::condition_variable condition_;
+    std::atomic<bool> running_;
+};
+
+struct Result {
+    double tasks_per_sec;
+    double allocs_per_task;
+};
+
+// 捕获与 scheduleForward 相当：对象指针 + 方向下标，外加若干字节负载
+template <typename Pool>
+Result run(size_t tasks, size_t producers, size_t workers) {
+    Pool pool(workers);
+    std::atomic<size_t> done{0};
+    const size_t per_producer = tasks / producers;
+    const size_t total = per_producer * producers;
+
+    const size_t allocs_before = g_allocations.load();
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (size_t p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p] {
+            for (size_t i = 0; i < per_producer; ++i) {
+                int index = static_cast<int>(i & 1);
+                uint64_t payload[4] = {p, i, 0, 0};
+                pool.enqueue([&done, index, payload] {
+                    if (index >= 0 && payload[0] != ~0ull) {
+                        done.fetch_add(1, std::memory_order_relaxed);
+                    }
+                });
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    while (done.load(std::memory_order_acquire) < total) {
+        std::this_thread::yield();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    const size_t allocs = g_allocations.load() - allocs_before;
+    return {total / elapsed.count(), static_cast<double>(allocs) / total};
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t tasks = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    size_t producers = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 4;
+    size_t workers = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 4;
+
+    Result locked = run<MutexThreadPool>(tasks, producers, workers);
+    Result stealing = run<ThreadPool>(tasks, producers, workers);
+
+    std::cout << "producers=" << producers << " workers=" << workers << std::endl;
+    std::cout << std::left << std::setw(22) << "pool"
+              << std::setw(16) << "tasks/s"
+              << "allocs/task" << std::endl;
+    std::cout << std::fixed;
+    std::cout << std::left << std::setw(22) << "mutex + std::function"
+              << std::setw(16) << std::setprecision(0) << locked.tasks_per_sec
+              << std::setprecision(2) << locked.allocs_per_task << std::endl;
+    std::cout << std::left << std::setw(22) << "work stealing"
+              << std::setw(16) << std::setprecision(0) << stealing.tasks_per_sec
+              << std::setprecision(2) << stealing.allocs_per_task << std::endl;
+    std::cout << "speedup " << std::setprecision(2)
+              << stealing.tasks_per_sec / locked.tasks_per_sec << "x" << std::endl;
+    return 0;
+}
@@ -0,0 +1,173 @@
+// udp_batch_bench.cpp
+// UDP 批量收发基准（回环地址）：
+//  - 接收：逐包 recvfrom 对比 recvmmsg（UdpRecvBatch）
+//  - 广播：逐客户端 sendto 对比一次 sendmmsg（UdpFanout）
+// 用法: ./bench_udp_batch [seconds] [clients]
+#include "../udp_batch.h"
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <vector>
+#include <cstdlib>
+#include <unistd.h>
+#include <arpa/inet.h>
+
+namespace {
+
+constexpr size_t kDatagramSize = 4096;
+
+int bindLoopback(sockaddr_in& addr) {
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+    if (fd < 0) return -1;
+    int rcvbuf = 4 * 1024 * 1024;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+    addr = sockaddr_in{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    socklen_t len = sizeof(addr);
+    if (bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0 ||
+        getsockname(fd, (sockaddr*)&addr, &len) < 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// 接收端吞吐：每轮先灌满接收缓冲区，只统计接收端取空这些数据报的耗时
+template <typename Receiver>
+double runReceive(size_t payload, double seconds, Receiver&& receive) {
+    constexpr size_t kRoundPackets = 1024;
+
+    sockaddr_in addr;
+    int rx = bindLoopback(addr);
+    int tx = socket(AF_INET, SOCK_DGRAM, 0);
+    if (rx < 0 || tx < 0) {
+        std::cerr << "socket setup failed" << std::endl;
+        std::exit(1);
+    }
+
+    std::vector<uint8_t> packet(payload, 0x5A);
+    struct iovec iov{packet.data(), packet.size()};
+    std::vector<sockaddr_in> targets(kRoundPackets, addr);
+    UdpFanout fanout;
+
+    size_t received = 0;
+    std::chrono::duration<double> elapsed{0};
+    while (elapsed.count() < seconds) {
+        fanout.send(tx, &iov, 1, targets.data(), targets.size(), [](size_t, int) {});
+
+        auto start = std::chrono::steady_clock::now();
+        size_t n;
+        while ((n = receive(rx)) > 0) {
+            received += n;
+        }
+        elapsed += std::chrono::steady_clock::now() - start;
+    }
+
+    ::close(tx);
+    ::close(rx);
+    return received / elapsed.count();
+}
+
+size_t receiveSingle(int fd) {
+    uint8_t buffer[kDatagramSize];
+    sockaddr_in from;
+    socklen_t len = sizeof(from);
+    return recvfrom(fd, buffer, sizeof(buffer), 0, (sockaddr*)&from, &len) > 0 ? 1 : 0;
+}
+
+// 广播吞吐：同一数据报发往 clients 个地址，统计每秒送出的数据报数
+template <typename Sender>
+double runFanout(size_t clients, double seconds, Sender&& send) {
+    std::vector<int> sinks;
+    std::vector<sockaddr_in> addrs(clients);
+    for (size_t i = 0; i < clients; ++i) {
+        int fd = bindLoopback(addrs[i]);
+        if (fd < 0) {
+            std::cerr << "socket setup failed" << std::endl;
+            std::exit(1);
+        }
+        sinks.push_back(fd);
+    }
+    int tx = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+
+    // 接收端持续清空，避免接收缓冲区溢出影响发送路径
+    std::atomic<bool> running{true};
+    std::thread drainer([&] {
+        UdpRecvBatch batch(kDatagramSize);
+        while (running.load(std::memory_order_relaxed)) {
+            for (int fd : sinks) batch.receive(fd);
+        }
+    });
+
+    uint8_t packet[64] = {0x5A};
+    struct iovec iov{packet, sizeof(packet)};
+    size_t sent = 0;
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + std::chrono::duration<double>(seconds);
+    while (std::chrono::steady_clock::now() < deadline) {
+        sent += send(tx, &iov, addrs);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    running = false;
+    drainer.join();
+    ::close(tx);
+    for (int fd : sinks) ::close(fd);
+    return sent / elapsed.count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    double seconds = argc > 1 ? std::strtod(argv[1], nullptr) : 1.0;
+    size_t clients = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 16;
+
+    std::cout << "Receive (packets/s)" << std::endl;
+    std::cout << std::left << std::setw(10) << "payload"
+              << std::setw(18) << "recvfrom"
+              << std::setw(18) << "recvmmsg"
+              << "speedup" << std::endl;
+
+    UdpRecvBatch batch(kDatagramSize);
+    for (size_t payload : {64, 512, 1400}) {
+        double single = runReceive(payload, seconds, receiveSingle);
+        double batched = runReceive(payload, seconds, [&](int fd) {
+            int n = batch.receive(fd);
+            return n > 0 ? static_cast<size_t>(n) : 0;
+        });
+        std::cout << std::left << std::setw(10) << payload
+                  << std::setw(18) << std::fixed << std::setprecision(0) << single
+                  << std::setw(18) << batched
+                  << std::setprecision(2) << batched / single << "x" << std::endl;
+    }
+
+    std::cout << std::endl << "Fan-out to " << clients << " clients (packets/s)" << std::endl;
+    double single = runFanout(clients, seconds,
+        [](int fd, const struct iovec* iov, const std::vector<sockaddr_in>& addrs) {
+            size_t sent = 0;
+            for (const auto& addr : addrs) {
+                if (sendto(fd, iov->iov_base, iov->iov_len, 0,
+                           (const sockaddr*)&addr, sizeof(addr)) >= 0) {
+                    ++sent;
+                }
+            }
+            return sent;
+        });
+    UdpFanout fanout;
+    double batched = runFanout(clients, seconds,
+        [&](int fd, const struct iovec* iov, const std::vector<sockaddr_in>& addrs) {
+            return fanout.send(fd, iov, 1, addrs.data(), addrs.size(), [](size_t, int) {});
+        });
+    std::cout << std::left << std::setw(18) << "sendto"
+              << std::setw(18) << "sendmmsg"
+              << "speedup" << std::endl;
+    std::cout << std::left << std::setw(18) << std::fixed << std::setprecision(0) << single
+              << std::setw(18) << batched
+              << std::setprecision(2) << batched / single << "x" << std::endl;
+    return 0;
+}
@@ -1,35 +1,233 @@
 // channel_manager.cpp
 #include "channel_manager.h"
+#include "reactor.h"
 #include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <cstdlib>
+#include <sched.h>
+
+namespace {
+// 重平衡周期与触发条件：最忙线程的转发耗时至少是最闲线程的 2 倍，
+// 且差值超过周期的 5% 时才迁移，每周期最多迁移一个通道，避免来回抖动
+constexpr std::chrono::milliseconds kRebalanceInterval{5000};
+constexpr uint64_t kSkewRatio = 2;
+constexpr uint64_t kMinImbalancePercent = 5;
+} // namespace
+
+ChannelManager::ChannelManager(size_t thread_pool_size, Scheduling scheduling,
+                               const std::vector<int>& worker_cpus)
+    : thread_pool_(thread_pool_size), scheduling_(scheduling) {
+    if (!worker_cpus.empty()) {
+        for (size_t i = 0; i < thread_pool_.size(); ++i) {
+            int cpu = worker_cpus[i % worker_cpus.size()];
+            if (!thread_pool_.pinWorker(i, cpu)) {
+                LOG_WARNING("Failed to pin worker %zu to CPU %d: %s", i, cpu, strerror(errno));
+            }
+        }
+    }
+
+    if (scheduling_ == Scheduling::Affine) {
+        rebalance_loop_ = Reactor::getInstance().getLoop(0);
+        rebalance_timer_ = rebalance_loop_->runEvery(kRebalanceInterval, [this] { rebalance(); });
+    }
+    LOG_INFO("Thread pool: %zu workers, %s scheduling%s", thread_pool_.size(),
+             scheduling_ == Scheduling::Affine ? "affine" : "shared",
+             worker_cpus.empty() ? "" : ", workers pinned");
+}
+
+ChannelManager::~ChannelManager() {
+    // 先停止重平衡定时器（会等待正在执行的回调结束），再销毁通道与线程池
+    if (rebalance_timer_) {
+        rebalance_loop_->cancelTimer(rebalance_timer_);
+        rebalance_timer_ = 0;
+    }
+}
+
+bool ChannelManager::parseScheduling(const std::string& name, Scheduling& scheduling) {
+    if (name == "shared") {
+        scheduling = Scheduling::Shared;
+    } else if (name == "affine") {
+        scheduling = Scheduling::Affine;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool ChannelManager::parseCpuList(const std::string& list, std::vector<int>& cpus) {
+    std::vector<int> result;
+    size_t pos = 0;
+    while (pos <= list.size()) {
+        size_t comma = list.find(',', pos);
+        if (comma == std::string::npos) comma = list.size();
+        const std::string item = list.substr(pos, comma - pos);
+        pos = comma + 1;
+
+        // 单个 CPU（"3"）或闭区间（"0-3"）
+        char* end = nullptr;
+        long first = std::strtol(item.c_str(), &end, 10);
+        long last = first;
+        if (end == item.c_str()) return false;
+        if (*end == '-') {
+            const char* second = end + 1;
+            last = std::strtol(second, &end, 10);
+            if (end == second) return false;
+        }
+        if (*end != '\0' || first < 0 || last < first || last >= CPU_SETSIZE) return false;
+        for (long cpu = first; cpu <= last; ++cpu) {
+            result.push_back(static_cast<int>(cpu));
+        }
+    }
+    cpus = std::move(result);
+    return true;
+}
 
 void ChannelManager::addChannel(std::unique_ptr<ProtocolChannel> channel) {
     std::lock_guard<std::mutex> lock(mutex_);
+    if (scheduling_ == Scheduling::Affine) {
+        channel->setHomeWorker(leastLoadedWorker());
+    }
     channel->start();
     channels_.push_back(std::move(channel));
-    LOG_INFO("Added channel: %s", channels_.back()->getName().c_str());
+    if (scheduling_ == Scheduling::Affine) {
+        LOG_INFO("Added channel: %s (worker %d)", channels_.back()->getName().c_str(),
+                 channels_.back()->homeWorker());
+    } else {
+        LOG_INFO("Added channel: %s", channels_.back()->getName().c_str());
+    }
 }
 
-void ChannelManager::stopAll() {
+int ChannelManager::leastLoadedWorker() const {
+    std::vector<size_t> counts(thread_pool_.size(), 0);
+    for (const auto& channel : channels_) {
+        int home = channel->homeWorker();
+        if (home >= 0 && static_cast<size_t>(home) < counts.size()) ++counts[home];
+    }
+    return static_cast<int>(std::min_element(counts.begin(), counts.end()) - counts.begin());
+}
+
+void ChannelManager::rebalance() {
     std::lock_guard<std::mutex> lock(mutex_);
+    const size_t workers = thread_pool_.size();
+    if (workers < 2 || channels_.size() < 2) {
+        for (auto& channel : channels_) channel->takeBusyNanos();
+        return;
+    }
+
+    std::vector<uint64_t> load(workers, 0);
+    std::vector<uint64_t> busy(channels_.size(), 0);
+    for (size_t i = 0; i < channels_.size(); ++i) {
+        busy[i] = channels_[i]->takeBusyNanos();
+        int home = channels_[i]->homeWorker();
+        if (home >= 0 && static_cast<size_t>(home) < workers) load[home] += busy[i];
+    }
+
+    auto range = std::minmax_element(load.begin(), load.end());
+    const size_t idlest = range.first - load.begin();
+    const size_t busiest = range.second - load.begin();
+    const uint64_t gap = load[busiest] - load[idlest];
+    const uint64_t period = std::chrono::duration_cast<std::chrono::nanoseconds>(kRebalanceInterval).count();
+    if (gap * 100 < period * kMinImbalancePercent || load[busiest] < load[idlest] * kSkewRatio) {
+        return;
+    }
+
+    // 迁移最忙线程上负载最接近差值一半的通道，迁移后两线程负载最接近；
+    // 负载不小于差值的通道迁走只会把热点换个线程，不考虑
+    size_t best = channels_.size();
+    uint64_t best_distance = 0;
+    for (size_t i = 0; i < channels_.size(); ++i) {
+        if (channels_[i]->homeWorker() != static_cast<int>(busiest) || busy[i] == 0 || busy[i] >= gap) {
+            continue;
+        }
+        const uint64_t twice = busy[i] * 2;
+        const uint64_t distance = twice > gap ? twice - gap : gap - twice;
+        if (best == channels_.size() || distance < best_distance) {
+            best = i;
+            best_distance = distance;
+        }
+    }
+    if (best == channels_.size()) return;
+
+    // 正在执行的转发任务仍在原线程完成，之后提交的任务投递到新线程
+    channels_[best]->setHomeWorker(static_cast<int>(idlest));
+    LOG_INFO("Rebalance: channel %s moved from worker %zu (%.1f ms busy) to worker %zu (%.1f ms busy)",
+             channels_[best]->getName().c_str(), busiest, load[busiest] / 1e6, idlest, load[idlest] / 1e6);
+}
+
+void ChannelManager::stopAll() {
+    // 停止通道会等待事件循环（关闭端点时 removeFd / runAndWait），而重平衡定时器在事件循环中获取 mutex_：
+    // 持锁只取出通道，释放锁后再停止
+    std::vector<std::unique_ptr<ProtocolChannel>> channels;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        channels.swap(channels_);
+    }
     LOG_INFO("Stopping all channels...");
-    for (auto& channel : channels_) {
+    for (auto& channel : channels) {
         channel->stop();
     }
-    channels_.clear();
+    channels.clear();
     LOG_INFO("All channels stopped");
 }
 
-void ChannelManager::removeChannel(const std::string& name) {
+std::vector<ChannelStats> ChannelManager::snapshot() {
     std::lock_guard<std::mutex> lock(mutex_);
-    auto it = std::find_if(channels_.begin(), channels_.end(),
-        [&](const auto& channel) { 
-            return channel->getName() == name; 
-        });
-    
-    if (it != channels_.end()) {
+    std::vector<ChannelStats> result;
+    result.reserve(channels_.size());
+    for (const auto& channel : channels_) {
+        result.push_back(channel->stats());
+    }
+    return result;
+}
+
+bool ChannelManager::setChannelLogLevel(const std::string& name, LogLevel level) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& channel : channels_) {
+        if (channel->getName() == name) {
+            return channel->setLogLevel(level);
+        }
+    }
+    return false;
+}
+
+bool ChannelManager::replaceEndpoint(const std::string& name, int node, const EndpointConfig& config) {
+    ProtocolChannel* target = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& channel : channels_) {
+            if (channel->getName() == name) {
+                target = channel.get();
+                break;
+            }
+        }
+    }
+    // 替换过程会等待转发任务与事件循环，不持有 mutex_（重平衡定时器在事件循环中获取该锁）；
+    // 通道只会被调用线程移除，释放锁后指针仍然有效
+    return target != nullptr && target->replaceEndpoint(node, config);
+}
+
+void ChannelManager::removeChannel(const std::string& name) {
+    // 与 stopAll 相同：持锁只从列表中取出通道，释放锁后再停止
+    std::unique_ptr<ProtocolChannel> removed;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = std::find_if(channels_.begin(), channels_.end(),
+            [&](const auto& channel) { 
+                return channel->getName() == name; 
+            });
+        if (it != channels_.end()) {
+            removed = std::move(*it);
+            channels_.erase(it);
+        }
+    }
+
+    if (removed) {
         LOG_INFO("Removing channel: %s", name.c_str());
-        (*it)->stop();
-        channels_.erase(it);
+        removed->stop();
+        removed.reset();
         LOG_INFO("Removed channel: %s", name.c_str());
     }else {
         LOG_WARNING("Attempted to remove non-existent channel: %s", name.c_str());
@@ -2,23 +2,55 @@
 #include <vector>
 #include <memory>
 #include <mutex>
+#include <string>
 #include <unordered_map>
 #include "protocol_channel.h"
 #include "thread_pool.h"
+#include "event_loop.h"
 #include "logrecord.h"
 class ChannelManager {
 public:
-    ChannelManager(size_t thread_pool_size = 12) 
-        : thread_pool_(thread_pool_size) {}
-    
+    // 转发任务调度方式
+    enum class Scheduling {
+        Shared, // 任意工作线程执行（工作窃取）
+        Affine  // 每个通道绑定一个 home 工作线程，负载明显倾斜时由重平衡迁移
+    };
+
+    // worker_cpus 非空时工作线程 i 绑定到 worker_cpus[i % size]
+    ChannelManager(size_t thread_pool_size = 12,
+                   Scheduling scheduling = Scheduling::Shared,
+                   const std::vector<int>& worker_cpus = {});
+    ~ChannelManager();
+
     void addChannel(std::unique_ptr<ProtocolChannel> channel);
     void stopAll();
     void removeChannel(const std::string& name);
- 
+    // 全部通道的统计快照（计数器在读取时汇总，不影响转发路径）
+    std::vector<ChannelStats> snapshot();
+    // 修改通道日志级别（通道不存在、或需要重建通道以切换零拷贝模式时返回 false）
+    bool setChannelLogLevel(const std::string& name, LogLevel level);
+    // 原地替换通道的一个端点（node: 0 = input，1 = output），失败时返回 false（需重建通道）
+    // 与 addChannel / removeChannel 由同一线程调用
+    bool replaceEndpoint(const std::string& name, int node, const EndpointConfig& config);
+
     ThreadPool& getThreadPool() { return thread_pool_; }
+    Scheduling scheduling() const { return scheduling_; }
+
+    // 解析调度方式名称（"shared" / "affine"），无法识别时返回 false
+    static bool parseScheduling(const std::string& name, Scheduling& scheduling);
+    // 解析 CPU 列表（如 "0-3,6"），格式错误时返回 false
+    static bool parseCpuList(const std::string& list, std::vector<int>& cpus);
 
 private:
+    // 选择绑定通道最少的工作线程（需持有 mutex_）
+    int leastLoadedWorker() const;
+    // 定时器回调：按上一周期的转发耗时比较各工作线程负载，倾斜时迁移一个通道
+    void rebalance();
+
     std::mutex mutex_;
     std::vector<std::unique_ptr<ProtocolChannel>> channels_;
     ThreadPool thread_pool_;
-};
\ No newline at end of file
+    Scheduling scheduling_;
+    EventLoop* rebalance_loop_ = nullptr;
+    EventLoop::TimerId rebalance_timer_ = 0;
+};
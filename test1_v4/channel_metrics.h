@@ -0,0 +1,134 @@
+// channel_metrics.h
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include "latency_histogram.h"
+
+// 单个转发方向的统计快照（0 = NODE1->NODE2, 1 = NODE2->NODE1）
+struct DirectionStats {
+    uint64_t bytes_in = 0;        // 从源端点收到的字节数
+    uint64_t packets_in = 0;      // 源端点数据回调次数（零拷贝模式为 splice 次数）
+    uint64_t bytes_out = 0;       // 目标端点已接收的字节数
+    uint64_t packets_out = 0;     // 成功写入目标端点的次数
+    uint64_t drops = 0;           // 丢弃次数（缓冲区满 / 目标忙）
+    uint64_t dropped_bytes = 0;
+    uint64_t ring_high_water = 0; // 缓冲区占用最高值（零拷贝模式为管道积压），字节
+    uint64_t forward_runs = 0;    // 转发任务执行次数
+    uint64_t write_blocked = 0;   // 目标暂时不可写（EAGAIN / 部分写入）次数
+    uint64_t write_errors = 0;    // 目标端点上报的错误及转发异常
+    LatencySummary latency;       // 接收 -> 目标端点接收的延迟（纳秒）
+};
+
+// 端点状态快照（各字段只对相应类型的端点有意义，其余为 0）
+struct EndpointStats {
+    std::string type;          // 配置中的端点类型，如 "tcp_server"
+    bool connected = false;
+    uint64_t clients = 0;      // 当前客户端连接数（TCP 服务端）
+    uint64_t accepted = 0;     // 累计接受的连接数（TCP 服务端）
+    uint64_t reconnects = 0;   // 断开或连接失败后的重连次数（TCP 客户端）
+    uint64_t queued_bytes = 0; // 发送队列积压字节数（TCP 客户端）
+    uint64_t rx_wakeups = 0;   // 读事件次数（串口）
+    uint64_t rx_reads = 0;     // read 调用次数（串口）
+    LatencySummary rx_drain_time; // 每次读事件取出的数据的线路时间（串口）：取出字节数 × 每字节线路时间，纳秒
+};
+
+// Modbus TCP <-> RTU 转换统计（通道配置了 conversion 时有效）
+struct ModbusStats {
+    uint64_t requests = 0;   // 收到的 TCP 请求
+    uint64_t responses = 0;  // 转发给 TCP 端的 RTU 响应
+    uint64_t timeouts = 0;   // RTU 从站响应超时
+    uint64_t crc_errors = 0; // CRC 校验失败的 RTU 帧
+    uint64_t exceptions = 0; // 网关生成的异常响应（超时 / 队列满）
+};
+
+// 通道统计快照
+struct ChannelStats {
+    std::string name;
+    size_t ring_capacity = 0; // 每个方向的缓冲区容量（字节）
+    std::array<DirectionStats, 2> directions;
+    std::array<EndpointStats, 2> endpoints; // 0 = NODE1（输入），1 = NODE2（输出）
+    std::string conversion;                 // 协议转换（空表示透传）
+    ModbusStats modbus;
+};
+
+// 通道计数器：按线程分片，每个分片独占缓存行，写入方只做本分片的 relaxed 原子加，
+// 读取时汇总全部分片。事件循环线程与转发线程更新同一通道的计数器时互不争用缓存行
+class ChannelMetrics {
+public:
+    enum Counter {
+        BytesIn,
+        PacketsIn,
+        BytesOut,
+        PacketsOut,
+        Drops,
+        DroppedBytes,
+        ForwardRuns,
+        WriteBlocked,
+        WriteErrors,
+        kCounterCount
+    };
+
+    ChannelMetrics() = default;
+    ChannelMetrics(const ChannelMetrics&) = delete;
+    ChannelMetrics& operator=(const ChannelMetrics&) = delete;
+
+    void add(int direction, Counter counter, uint64_t value = 1) {
+        shards_[shardIndex()][direction].counters[counter].fetch_add(value, std::memory_order_relaxed);
+    }
+
+    // 记录占用值，只在超过本分片最高值时写入
+    void updateHighWater(int direction, uint64_t value) {
+        std::atomic<uint64_t>& high = shards_[shardIndex()][direction].high_water;
+        uint64_t current = high.load(std::memory_order_relaxed);
+        while (value > current &&
+               !high.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    // 汇总全部分片（计数器求和，最高值取最大）
+    DirectionStats read(int direction) const {
+        uint64_t sums[kCounterCount] = {};
+        uint64_t high = 0;
+        for (const auto& shard : shards_) {
+            const Slot& slot = shard[direction];
+            for (int i = 0; i < kCounterCount; ++i) {
+                sums[i] += slot.counters[i].load(std::memory_order_relaxed);
+            }
+            high = std::max(high, slot.high_water.load(std::memory_order_relaxed));
+        }
+
+        DirectionStats stats;
+        stats.bytes_in = sums[BytesIn];
+        stats.packets_in = sums[PacketsIn];
+        stats.bytes_out = sums[BytesOut];
+        stats.packets_out = sums[PacketsOut];
+        stats.drops = sums[Drops];
+        stats.dropped_bytes = sums[DroppedBytes];
+        stats.ring_high_water = high;
+        stats.forward_runs = sums[ForwardRuns];
+        stats.write_blocked = sums[WriteBlocked];
+        stats.write_errors = sums[WriteErrors];
+        return stats;
+    }
+
+private:
+    static constexpr size_t kShards = 8; // 2 的幂；线程数更多时多个线程共用分片（仍为原子加，结果正确）
+
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> counters[kCounterCount] = {};
+        std::atomic<uint64_t> high_water{0};
+    };
+
+    // 线程首次更新计数器时按顺序分配分片
+    static size_t shardIndex() {
+        static std::atomic<size_t> next{0};
+        thread_local const size_t index = next.fetch_add(1, std::memory_order_relaxed) & (kShards - 1);
+        return index;
+    }
+
+    std::array<std::array<Slot, 2>, kShards> shards_;
+};
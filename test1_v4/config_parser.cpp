@@ -49,6 +49,48 @@ EndpointConfig ConfigParserFactory::parseEndpoint(const nlohmann::json& j) {
     if (j.contains("baud_rate")) {
         config.baud_rate = j["baud_rate"].get<uint32_t>();
     }
+    if (j.contains("low_latency")) {
+        config.low_latency = j["low_latency"].get<bool>();
+    }
+    if (j.contains("vmin")) {
+        config.vmin = j["vmin"].get<uint32_t>();
+    }
+    if (j.contains("vtime")) {
+        config.vtime = j["vtime"].get<uint32_t>();
+    }
+    if (j.contains("write_high_watermark")) {
+        config.write_high_watermark = j["write_high_watermark"].get<uint32_t>();
+    }
+    if (j.contains("write_low_watermark")) {
+        config.write_low_watermark = j["write_low_watermark"].get<uint32_t>();
+    }
+    if (j.contains("client_idle_timeout")) {
+        config.client_idle_timeout = j["client_idle_timeout"].get<uint32_t>();
+    }
+    if (j.contains("framing")) {
+        config.framing = j["framing"].get<std::string>();
+    }
+    if (j.contains("frame_length_offset")) {
+        config.frame_length_offset = j["frame_length_offset"].get<uint32_t>();
+    }
+    if (j.contains("frame_length_size")) {
+        config.frame_length_size = j["frame_length_size"].get<uint32_t>();
+    }
+    if (j.contains("frame_length_adjust")) {
+        config.frame_length_adjust = j["frame_length_adjust"].get<int32_t>();
+    }
+    if (j.contains("frame_delimiter")) {
+        config.frame_delimiter = j["frame_delimiter"].get<std::string>();
+    }
+    if (j.contains("frame_size")) {
+        config.frame_size = j["frame_size"].get<uint32_t>();
+    }
+    if (j.contains("frame_gap_us")) {
+        config.frame_gap_us = j["frame_gap_us"].get<uint32_t>();
+    }
+    if (j.contains("max_frame_size")) {
+        config.max_frame_size = j["max_frame_size"].get<uint32_t>();
+    }
     
     return config;
 }
@@ -66,6 +108,21 @@ std::vector<ChannelConfig> ConfigParserFactory::parseJson(const nlohmann::json&
         config.name = channel["name"].get<std::string>();
         config.input = parseEndpoint(channel["input"]);
         config.output = parseEndpoint(channel["output"]);
+        if (channel.contains("zero_copy")) {
+            config.zero_copy = channel["zero_copy"].get<bool>();
+        }
+        if (channel.contains("flow_control")) {
+            config.flow_control = channel["flow_control"].get<std::string>();
+        }
+        if (channel.contains("log_level")) {
+            config.log_level = channel["log_level"].get<std::string>();
+        }
+        if (channel.contains("conversion")) {
+            config.conversion = channel["conversion"].get<std::string>();
+        }
+        if (channel.contains("modbus_timeout_ms")) {
+            config.modbus_timeout_ms = channel["modbus_timeout_ms"].get<uint32_t>();
+        }
         channels.push_back(config);
     }
     
@@ -104,6 +161,20 @@ std::vector<ChannelConfig> YamlConfigParser::parse(const std::string& filename)
         if (input["ip"]) chConfig.input.ip = input["ip"].as<std::string>();
         if (input["serial_port"]) chConfig.input.serial_port = input["serial_port"].as<std::string>();
         if (input["baud_rate"]) chConfig.input.baud_rate = input["baud_rate"].as<uint32_t>();
+        if (input["low_latency"]) chConfig.input.low_latency = input["low_latency"].as<bool>();
+        if (input["vmin"]) chConfig.input.vmin = input["vmin"].as<uint32_t>();
+        if (input["vtime"]) chConfig.input.vtime = input["vtime"].as<uint32_t>();
+        if (input["write_high_watermark"]) chConfig.input.write_high_watermark = input["write_high_watermark"].as<uint32_t>();
+        if (input["write_low_watermark"]) chConfig.input.write_low_watermark = input["write_low_watermark"].as<uint32_t>();
+        if (input["client_idle_timeout"]) chConfig.input.client_idle_timeout = input["client_idle_timeout"].as<uint32_t>();
+        if (input["framing"]) chConfig.input.framing = input["framing"].as<std::string>();
+        if (input["frame_length_offset"]) chConfig.input.frame_length_offset = input["frame_length_offset"].as<uint32_t>();
+        if (input["frame_length_size"]) chConfig.input.frame_length_size = input["frame_length_size"].as<uint32_t>();
+        if (input["frame_length_adjust"]) chConfig.input.frame_length_adjust = input["frame_length_adjust"].as<int32_t>();
+        if (input["frame_delimiter"]) chConfig.input.frame_delimiter = input["frame_delimiter"].as<std::string>();
+        if (input["frame_size"]) chConfig.input.frame_size = input["frame_size"].as<uint32_t>();
+        if (input["frame_gap_us"]) chConfig.input.frame_gap_us = input["frame_gap_us"].as<uint32_t>();
+        if (input["max_frame_size"]) chConfig.input.max_frame_size = input["max_frame_size"].as<uint32_t>();
         
         // 解析输出端点
         YAML::Node output = channel["output"];
@@ -112,6 +183,26 @@ std::vector<ChannelConfig> YamlConfigParser::parse(const std::string& filename)
         if (output["ip"]) chConfig.output.ip = output["ip"].as<std::string>();
         if (output["serial_port"]) chConfig.output.serial_port = output["serial_port"].as<std::string>();
         if (output["baud_rate"]) chConfig.output.baud_rate = output["baud_rate"].as<uint32_t>();
+        if (output["low_latency"]) chConfig.output.low_latency = output["low_latency"].as<bool>();
+        if (output["vmin"]) chConfig.output.vmin = output["vmin"].as<uint32_t>();
+        if (output["vtime"]) chConfig.output.vtime = output["vtime"].as<uint32_t>();
+        if (output["write_high_watermark"]) chConfig.output.write_high_watermark = output["write_high_watermark"].as<uint32_t>();
+        if (output["write_low_watermark"]) chConfig.output.write_low_watermark = output["write_low_watermark"].as<uint32_t>();
+        if (output["client_idle_timeout"]) chConfig.output.client_idle_timeout = output["client_idle_timeout"].as<uint32_t>();
+        if (output["framing"]) chConfig.output.framing = output["framing"].as<std::string>();
+        if (output["frame_length_offset"]) chConfig.output.frame_length_offset = output["frame_length_offset"].as<uint32_t>();
+        if (output["frame_length_size"]) chConfig.output.frame_length_size = output["frame_length_size"].as<uint32_t>();
+        if (output["frame_length_adjust"]) chConfig.output.frame_length_adjust = output["frame_length_adjust"].as<int32_t>();
+        if (output["frame_delimiter"]) chConfig.output.frame_delimiter = output["frame_delimiter"].as<std::string>();
+        if (output["frame_size"]) chConfig.output.frame_size = output["frame_size"].as<uint32_t>();
+        if (output["frame_gap_us"]) chConfig.output.frame_gap_us = output["frame_gap_us"].as<uint32_t>();
+        if (output["max_frame_size"]) chConfig.output.max_frame_size = output["max_frame_size"].as<uint32_t>();
+        
+        if (channel["zero_copy"]) chConfig.zero_copy = channel["zero_copy"].as<bool>();
+        if (channel["flow_control"]) chConfig.flow_control = channel["flow_control"].as<std::string>();
+        if (channel["log_level"]) chConfig.log_level = channel["log_level"].as<std::string>();
+        if (channel["conversion"]) chConfig.conversion = channel["conversion"].as<std::string>();
+        if (channel["modbus_timeout_ms"]) chConfig.modbus_timeout_ms = channel["modbus_timeout_ms"].as<uint32_t>();
         
         channels.push_back(chConfig);
     }
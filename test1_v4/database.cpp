@@ -2,25 +2,74 @@
 #include <stdexcept>
 #include <iostream>
 #include <cstdint>
+#include <iterator>
+#include <unordered_set>
+
+namespace {
+constexpr int kBusyTimeoutMs = 2000;
+
+// 缓存语句的使用范围：离开时复位并清除绑定，编译结果留给下次使用
+class StatementScope {
+public:
+    explicit StatementScope(sqlite3_stmt* stmt) : stmt_(stmt) {}
+    ~StatementScope() {
+        sqlite3_reset(stmt_);
+        sqlite3_clear_bindings(stmt_);
+    }
+    StatementScope(const StatementScope&) = delete;
+    StatementScope& operator=(const StatementScope&) = delete;
+
+private:
+    sqlite3_stmt* stmt_;
+};
+} // namespace
+
 Database::Database(const std::string& db_path) {
     if (sqlite3_open(db_path.c_str(), &db_) != SQLITE_OK) {
         throw std::runtime_error("Cannot open database: " + std::string(sqlite3_errmsg(db_)));
     }
+    // 其他连接（--update）提交期间读取会遇到 SQLITE_BUSY，等待而不是返回不完整的结果
+    sqlite3_busy_timeout(db_, kBusyTimeoutMs);
     initDatabase();
 }
 
 Database::~Database() {
+    for (auto& entry : statements_) {
+        sqlite3_finalize(entry.second);
+    }
     sqlite3_close(db_);
 }
 
+sqlite3_stmt* Database::statement(const std::string& sql) {
+    auto it = statements_.find(sql);
+    if (it != statements_.end()) return it->second;
+
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v3(db_, sql.c_str(), -1, SQLITE_PREPARE_PERSISTENT, &stmt, nullptr) != SQLITE_OK) {
+        throw std::runtime_error(sqlite3_errmsg(db_));
+    }
+    statements_.emplace(sql, stmt);
+    return stmt;
+}
+
 void Database::initDatabase() {
+    // WAL：读取（运行中实例的变更检查）与写入（--update）互不阻塞；
+    // synchronous = NORMAL 在 WAL 下只影响掉电时最后一个事务的持久性
     executeSQL(R"(
         PRAGMA encoding = 'UTF-8';
         PRAGMA foreign_keys = ON;
+        PRAGMA journal_mode = WAL;
+        PRAGMA synchronous = NORMAL;
         
         CREATE TABLE IF NOT EXISTS channels (
             id INTEGER PRIMARY KEY,
-            name TEXT NOT NULL UNIQUE
+            name TEXT NOT NULL UNIQUE,
+            zero_copy INTEGER NOT NULL DEFAULT 0,
+            flow_control TEXT NOT NULL DEFAULT 'backpressure',
+            log_level TEXT NOT NULL DEFAULT 'debug',
+            conversion TEXT NOT NULL DEFAULT '',
+            modbus_timeout_ms INTEGER NOT NULL DEFAULT 0,
+            version INTEGER NOT NULL DEFAULT 0
         );
         
         CREATE TABLE IF NOT EXISTS endpoints (
@@ -32,9 +81,124 @@ void Database::initDatabase() {
             ip TEXT,
             serial_port TEXT,
             baud_rate INTEGER,
+            low_latency INTEGER,
+            vmin INTEGER,
+            vtime INTEGER,
+            framing TEXT,
+            frame_length_offset INTEGER,
+            frame_length_size INTEGER,
+            frame_length_adjust INTEGER,
+            frame_delimiter TEXT,
+            frame_size INTEGER,
+            frame_gap_us INTEGER,
+            max_frame_size INTEGER,
+            write_high_watermark INTEGER,
+            write_low_watermark INTEGER,
+            client_idle_timeout INTEGER,
             FOREIGN KEY(channel_id) REFERENCES channels(id) ON DELETE CASCADE
         );
     )");
+
+    // 旧版本数据库升级：补齐新增列
+    addColumnIfMissing("channels", "zero_copy", "INTEGER NOT NULL DEFAULT 0");
+    addColumnIfMissing("channels", "flow_control", "TEXT NOT NULL DEFAULT 'backpressure'");
+    addColumnIfMissing("channels", "log_level", "TEXT NOT NULL DEFAULT 'debug'");
+    addColumnIfMissing("channels", "conversion", "TEXT NOT NULL DEFAULT ''");
+    addColumnIfMissing("channels", "modbus_timeout_ms", "INTEGER NOT NULL DEFAULT 0");
+    addColumnIfMissing("endpoints", "write_high_watermark", "INTEGER");
+    addColumnIfMissing("endpoints", "write_low_watermark", "INTEGER");
+    addColumnIfMissing("endpoints", "client_idle_timeout", "INTEGER");
+    addColumnIfMissing("endpoints", "low_latency", "INTEGER");
+    addColumnIfMissing("endpoints", "vmin", "INTEGER");
+    addColumnIfMissing("endpoints", "vtime", "INTEGER");
+    addColumnIfMissing("endpoints", "framing", "TEXT");
+    addColumnIfMissing("endpoints", "frame_length_offset", "INTEGER");
+    addColumnIfMissing("endpoints", "frame_length_size", "INTEGER");
+    addColumnIfMissing("endpoints", "frame_length_adjust", "INTEGER");
+    addColumnIfMissing("endpoints", "frame_delimiter", "TEXT");
+    addColumnIfMissing("endpoints", "frame_size", "INTEGER");
+    addColumnIfMissing("endpoints", "frame_gap_us", "INTEGER");
+    addColumnIfMissing("endpoints", "max_frame_size", "INTEGER");
+    addColumnIfMissing("channels", "version", "INTEGER NOT NULL DEFAULT 0");
+
+    // 变更跟踪：全局配置版本 + 每个通道最后修改时的版本 + 已删除通道的记录
+    // 由触发器维护，任何写入方（--update、sqlite3 命令行）修改后都能增量读取
+    // channels_after_update 的列清单随通道配置增加，每次启动重新创建（旧数据库中的触发器不含新列）
+    executeSQL(R"(
+        CREATE TABLE IF NOT EXISTS config_version (
+            id INTEGER PRIMARY KEY CHECK(id = 1),
+            value INTEGER NOT NULL
+        );
+        INSERT OR IGNORE INTO config_version (id, value) VALUES (1, 0);
+
+        CREATE TABLE IF NOT EXISTS deleted_channels (
+            name TEXT PRIMARY KEY,
+            version INTEGER NOT NULL
+        );
+
+        CREATE INDEX IF NOT EXISTS idx_channels_version ON channels(version);
+        DROP INDEX IF EXISTS idx_endpoints_channel;
+        CREATE UNIQUE INDEX IF NOT EXISTS idx_endpoints_channel_role ON endpoints(channel_id, role);
+
+        CREATE TRIGGER IF NOT EXISTS channels_after_insert AFTER INSERT ON channels BEGIN
+            UPDATE config_version SET value = value + 1;
+            UPDATE channels SET version = (SELECT value FROM config_version) WHERE id = NEW.id;
+            DELETE FROM deleted_channels WHERE name = NEW.name;
+        END;
+
+        DROP TRIGGER IF EXISTS channels_after_update;
+        CREATE TRIGGER channels_after_update
+        AFTER UPDATE OF name, zero_copy, flow_control, log_level, conversion, modbus_timeout_ms ON channels BEGIN
+            UPDATE config_version SET value = value + 1;
+            UPDATE channels SET version = (SELECT value FROM config_version) WHERE id = NEW.id;
+            INSERT OR REPLACE INTO deleted_channels (name, version)
+                SELECT OLD.name, (SELECT value FROM config_version) WHERE OLD.name <> NEW.name;
+        END;
+
+        CREATE TRIGGER IF NOT EXISTS channels_after_delete AFTER DELETE ON channels BEGIN
+            UPDATE config_version SET value = value + 1;
+            INSERT OR REPLACE INTO deleted_channels (name, version)
+                VALUES (OLD.name, (SELECT value FROM config_version));
+        END;
+
+        CREATE TRIGGER IF NOT EXISTS endpoints_after_insert AFTER INSERT ON endpoints BEGIN
+            UPDATE config_version SET value = value + 1;
+            UPDATE channels SET version = (SELECT value FROM config_version) WHERE id = NEW.channel_id;
+        END;
+
+        CREATE TRIGGER IF NOT EXISTS endpoints_after_update AFTER UPDATE ON endpoints BEGIN
+            UPDATE config_version SET value = value + 1;
+            UPDATE channels SET version = (SELECT value FROM config_version)
+                WHERE id IN (OLD.channel_id, NEW.channel_id);
+        END;
+
+        CREATE TRIGGER IF NOT EXISTS endpoints_after_delete AFTER DELETE ON endpoints BEGIN
+            UPDATE config_version SET value = value + 1;
+            UPDATE channels SET version = (SELECT value FROM config_version) WHERE id = OLD.channel_id;
+        END;
+    )");
+}
+
+void Database::addColumnIfMissing(const std::string& table, const std::string& column,
+                                  const std::string& definition) {
+    sqlite3_stmt* stmt;
+    std::string sql = "PRAGMA table_info(" + table + ");";
+    if (sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        throw std::runtime_error(sqlite3_errmsg(db_));
+    }
+
+    bool exists = false;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        if (column == reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1))) {
+            exists = true;
+            break;
+        }
+    }
+    sqlite3_finalize(stmt);
+
+    if (!exists) {
+        executeSQL("ALTER TABLE " + table + " ADD COLUMN " + column + " " + definition + ";");
+    }
 }
 
 void Database::executeSQL(const std::string& sql) {
@@ -46,150 +210,381 @@ void Database::executeSQL(const std::string& sql) {
     }
 }
 
-std::vector<ChannelConfig> Database::loadChannels() {
-    const char* sql = R"(
-        SELECT c.name, 
-               i.type AS input_type, i.port AS input_port, i.ip AS input_ip,
-               i.serial_port AS input_serial_port, i.baud_rate AS input_baud,
-               
-               o.type AS output_type, o.port AS output_port, o.ip AS output_ip,
-               o.serial_port AS output_serial_port, o.baud_rate AS output_baud
-               
-        FROM channels c
-        JOIN endpoints i ON c.id = i.channel_id AND i.role = 'input'
-        JOIN endpoints o ON c.id = o.channel_id AND o.role = 'output'
-    )";
-
-    sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+int64_t Database::queryInt64(const std::string& sql) {
+    sqlite3_stmt* stmt = statement(sql);
+    StatementScope scope(stmt);
+    int64_t value = 0;
+    const int rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+        value = sqlite3_column_int64(stmt, 0);
+    } else if (rc != SQLITE_DONE) {
         throw std::runtime_error(sqlite3_errmsg(db_));
     }
-    
-    std::vector<ChannelConfig> channels;
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        ChannelConfig config;
-        config.name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
-        
-        // 输入端点配置
-        config.input.type = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-        if (sqlite3_column_type(stmt, 2) != SQLITE_NULL) 
-            config.input.port = sqlite3_column_int(stmt, 2);
-        if (sqlite3_column_type(stmt, 3) != SQLITE_NULL) 
-            config.input.ip = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
-        if (sqlite3_column_type(stmt, 4) != SQLITE_NULL) 
-            config.input.serial_port = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4));
-        if (sqlite3_column_type(stmt, 5) != SQLITE_NULL) 
-            config.input.baud_rate = sqlite3_column_int(stmt, 5);
-        
-        // 输出端点配置
-        config.output.type = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 6));
-        if (sqlite3_column_type(stmt, 7) != SQLITE_NULL) 
-            config.output.port = sqlite3_column_int(stmt, 7);
-        if (sqlite3_column_type(stmt, 8) != SQLITE_NULL) 
-            config.output.ip = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 8));
-        if (sqlite3_column_type(stmt, 9) != SQLITE_NULL) 
-            config.output.serial_port = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 9));
-        if (sqlite3_column_type(stmt, 10) != SQLITE_NULL) 
-            config.output.baud_rate = sqlite3_column_int(stmt, 10);
-        
-        channels.push_back(config);
-    }
-    
-    sqlite3_finalize(stmt);
-    return channels;
+    return value;
 }
 
-void Database::saveChannels(const std::vector<ChannelConfig>& channels) {
-    // 移除了事务开始和提交/回滚的代码
-    // 准备插入通道的语句
-    sqlite3_stmt* channelStmt;
-    const char* channelSql = "INSERT INTO channels (name) VALUES (?);";
-    if (sqlite3_prepare_v2(db_, channelSql, -1, &channelStmt, nullptr) != SQLITE_OK) {
-        throw std::runtime_error(sqlite3_errmsg(db_));
-    }
-    
-    // 准备插入端点的语句
-    sqlite3_stmt* endpointStmt;
-    const char* endpointSql = R"(
-        INSERT INTO endpoints 
-        (channel_id, role, type, port, ip, serial_port, baud_rate)
-        VALUES (?, ?, ?, ?, ?, ?, ?);
-    )";
-    if (sqlite3_prepare_v2(db_, endpointSql, -1, &endpointStmt, nullptr) != SQLITE_OK) {
-        sqlite3_finalize(channelStmt);
-        throw std::runtime_error(sqlite3_errmsg(db_));
+int64_t Database::dataVersion() {
+    return queryInt64("PRAGMA data_version;");
+}
+
+namespace {
+// 端点列（input/output 两次 JOIN 使用相同的列顺序）
+const char* const kEndpointColumns[] = {
+    "type", "port", "ip", "serial_port", "baud_rate",
+    "write_high_watermark", "write_low_watermark", "client_idle_timeout",
+    "low_latency", "vmin", "vtime",
+    "framing", "frame_length_offset", "frame_length_size", "frame_length_adjust",
+    "frame_delimiter", "frame_size", "frame_gap_us", "max_frame_size"
+};
+
+std::string endpointSelectList(const std::string& alias) {
+    std::string list;
+    for (const char* column : kEndpointColumns) {
+        if (!list.empty()) list += ", ";
+        list += alias + "." + column;
     }
-    
-    for (const auto& channel : channels) {
-        // 插入通道
-        sqlite3_bind_text(channelStmt, 1, channel.name.c_str(), -1, SQLITE_TRANSIENT);
-        if (sqlite3_step(channelStmt) != SQLITE_DONE) {
-            throw std::runtime_error("Failed to insert channel: " + channel.name);
+    return list;
+}
+
+// 通道查询：innerJoin 为 false 时使用 LEFT JOIN（端点缺失的通道也返回，端点列为 NULL）
+std::string channelSelect(bool innerJoin, const char* where) {
+    const std::string join = innerJoin ? "JOIN" : "LEFT JOIN";
+    return "SELECT c.name, c.zero_copy, c.flow_control, c.log_level, " + endpointSelectList("i") + ", " +
+           endpointSelectList("o") + ", c.conversion, c.modbus_timeout_ms FROM channels c " +
+           join + " endpoints i ON c.id = i.channel_id AND i.role = 'input' " +
+           join + " endpoints o ON c.id = o.channel_id AND o.role = 'output' " + where + ";";
+}
+
+// 通道 upsert：内容相同时不执行 UPDATE（不触发版本更新）
+const char* const kUpsertChannelSql = R"(
+    INSERT INTO channels (name, zero_copy, flow_control, log_level, conversion, modbus_timeout_ms)
+    VALUES (?, ?, ?, ?, ?, ?)
+    ON CONFLICT(name) DO UPDATE SET
+        zero_copy = excluded.zero_copy, flow_control = excluded.flow_control, log_level = excluded.log_level,
+        conversion = excluded.conversion, modbus_timeout_ms = excluded.modbus_timeout_ms
+    WHERE zero_copy IS NOT excluded.zero_copy OR flow_control IS NOT excluded.flow_control
+        OR log_level IS NOT excluded.log_level OR conversion IS NOT excluded.conversion
+        OR modbus_timeout_ms IS NOT excluded.modbus_timeout_ms;
+)";
+
+// 端点 upsert：按 (channel_id, role) 唯一索引更新，通道 id 按名称查找
+std::string upsertEndpointSql() {
+    std::string columns;
+    std::string placeholders;
+    std::string assignments;
+    std::string changed;
+    for (const char* column : kEndpointColumns) {
+        const std::string name = column;
+        columns += ", " + name;
+        placeholders += ", ?";
+        if (!assignments.empty()) {
+            assignments += ", ";
+            changed += " OR ";
         }
-        sqlite3_int64 channelId = sqlite3_last_insert_rowid(db_);
-        sqlite3_reset(channelStmt);
-        
-        // 插入输入端点
-        insertEndpoint(endpointStmt, channelId, "input", channel.input);
-        
-        // 插入输出端点
-        insertEndpoint(endpointStmt, channelId, "output", channel.output);
+        assignments += name + " = excluded." + name;
+        changed += name + " IS NOT excluded." + name;
     }
-    
-    sqlite3_finalize(channelStmt);
-    sqlite3_finalize(endpointStmt);
+    return "INSERT INTO endpoints (channel_id, role" + columns + ") "
+           "VALUES ((SELECT id FROM channels WHERE name = ?), ?" + placeholders + ") "
+           "ON CONFLICT(channel_id, role) DO UPDATE SET " + assignments + " WHERE " + changed + ";";
 }
 
-void Database::insertEndpoint(sqlite3_stmt* stmt, sqlite3_int64 channelId, 
-                             const std::string& role, const EndpointConfig& config) {
-    sqlite3_bind_int64(stmt, 1, channelId);
-    sqlite3_bind_text(stmt, 2, role.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 3, config.type.c_str(), -1, SQLITE_TRANSIENT);
-    
-    // 绑定端口
-    if (config.port > 0) {
-        sqlite3_bind_int(stmt, 4, config.port);
-    } else {
-        sqlite3_bind_null(stmt, 4);
+// 从查询结果的 col 列开始读取端点配置，col 前移到下一个端点之后
+void readEndpoint(sqlite3_stmt* stmt, int& col, EndpointConfig& config) {
+    config.type = reinterpret_cast<const char*>(sqlite3_column_text(stmt, col++));
+    if (sqlite3_column_type(stmt, col) != SQLITE_NULL) 
+        config.port = sqlite3_column_int(stmt, col);
+    ++col;
+    if (sqlite3_column_type(stmt, col) != SQLITE_NULL) 
+        config.ip = reinterpret_cast<const char*>(sqlite3_column_text(stmt, col));
+    ++col;
+    if (sqlite3_column_type(stmt, col) != SQLITE_NULL) 
+        config.serial_port = reinterpret_cast<const char*>(sqlite3_column_text(stmt, col));
+    ++col;
+    if (sqlite3_column_type(stmt, col) != SQLITE_NULL) 
+        config.baud_rate = sqlite3_column_int(stmt, col);
+    ++col;
+    if (sqlite3_column_type(stmt, col) != SQLITE_NULL) 
+        config.write_high_watermark = sqlite3_column_int64(stmt, col);
+    ++col;
+    if (sqlite3_column_type(stmt, col) != SQLITE_NULL) 
+        config.write_low_watermark = sqlite3_column_int64(stmt, col);
+    ++col;
+    if (sqlite3_column_type(stmt, col) != SQLITE_NULL) 
+        config.client_idle_timeout = sqlite3_column_int64(stmt, col);
+    ++col;
+    if (sqlite3_column_type(stmt, col) != SQLITE_NULL)
+        config.low_latency = sqlite3_column_int(stmt, col) != 0;
+    ++col;
+    if (sqlite3_column_type(stmt, col) != SQLITE_NULL)
+        config.vmin = sqlite3_column_int64(stmt, col);
+    ++col;
+    if (sqlite3_column_type(stmt, col) != SQLITE_NULL)
+        config.vtime = sqlite3_column_int64(stmt, col);
+    ++col;
+    // 分帧参数
+    if (sqlite3_column_type(stmt, col) != SQLITE_NULL)
+        config.framing = reinterpret_cast<const char*>(sqlite3_column_text(stmt, col));
+    ++col;
+    if (sqlite3_column_type(stmt, col) != SQLITE_NULL)
+        config.frame_length_offset = sqlite3_column_int64(stmt, col);
+    ++col;
+    if (sqlite3_column_type(stmt, col) != SQLITE_NULL)
+        config.frame_length_size = sqlite3_column_int64(stmt, col);
+    ++col;
+    if (sqlite3_column_type(stmt, col) != SQLITE_NULL)
+        config.frame_length_adjust = sqlite3_column_int(stmt, col);
+    ++col;
+    if (sqlite3_column_type(stmt, col) != SQLITE_NULL) {
+        // 分隔符可能包含 NUL，按字节数读取
+        config.frame_delimiter.assign(reinterpret_cast<const char*>(sqlite3_column_blob(stmt, col)),
+                                      sqlite3_column_bytes(stmt, col));
     }
-    
+    ++col;
+    if (sqlite3_column_type(stmt, col) != SQLITE_NULL)
+        config.frame_size = sqlite3_column_int64(stmt, col);
+    ++col;
+    if (sqlite3_column_type(stmt, col) != SQLITE_NULL)
+        config.frame_gap_us = sqlite3_column_int64(stmt, col);
+    ++col;
+    if (sqlite3_column_type(stmt, col) != SQLITE_NULL)
+        config.max_frame_size = sqlite3_column_int64(stmt, col);
+    ++col;
+}
+
+// channelSelect 查询中输出端点的 type 列
+constexpr int kOutputTypeCol = 4 + static_cast<int>(std::size(kEndpointColumns));
+
+// 读取 channelSelect 查询的一行
+ChannelConfig readChannel(sqlite3_stmt* stmt) {
+    ChannelConfig config;
+    config.name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+    config.zero_copy = sqlite3_column_int(stmt, 1) != 0;
+    config.flow_control = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
+    config.log_level = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
+
+    int col = 4;
+    // 输入端点配置
+    readEndpoint(stmt, col, config.input);
+    // 输出端点配置
+    readEndpoint(stmt, col, config.output);
+    // 端点列之后的通道列
+    config.conversion = reinterpret_cast<const char*>(sqlite3_column_text(stmt, col++));
+    config.modbus_timeout_ms = static_cast<uint32_t>(sqlite3_column_int64(stmt, col++));
+    return config;
+}
+
+// 绑定端点列（从参数 index 开始，0 / 空值绑定为 NULL）
+void bindEndpoint(sqlite3_stmt* stmt, int index, const EndpointConfig& config) {
+    sqlite3_bind_text(stmt, index++, config.type.c_str(), -1, SQLITE_TRANSIENT);
+    // 绑定端口
+    if (config.port > 0) sqlite3_bind_int(stmt, index, config.port);
+    ++index;
     // 绑定IP
-    if (!config.ip.empty()) {
-        sqlite3_bind_text(stmt, 5, config.ip.c_str(), -1, SQLITE_TRANSIENT);
-    } else {
-        sqlite3_bind_null(stmt, 5);
-    }
-    
+    if (!config.ip.empty()) sqlite3_bind_text(stmt, index, config.ip.c_str(), -1, SQLITE_TRANSIENT);
+    ++index;
     // 绑定串口
-    if (!config.serial_port.empty()) {
-        sqlite3_bind_text(stmt, 6, config.serial_port.c_str(), -1, SQLITE_TRANSIENT);
-    } else {
-        sqlite3_bind_null(stmt, 6);
-    }
-    
+    if (!config.serial_port.empty()) sqlite3_bind_text(stmt, index, config.serial_port.c_str(), -1, SQLITE_TRANSIENT);
+    ++index;
     // 绑定波特率
-    if (config.baud_rate > 0) {
-        sqlite3_bind_int(stmt, 7, config.baud_rate);
-    } else {
-        sqlite3_bind_null(stmt, 7);
+    if (config.baud_rate > 0) sqlite3_bind_int(stmt, index, config.baud_rate);
+    ++index;
+    // 绑定发送队列水位
+    if (config.write_high_watermark > 0) sqlite3_bind_int64(stmt, index, config.write_high_watermark);
+    ++index;
+    if (config.write_low_watermark > 0) sqlite3_bind_int64(stmt, index, config.write_low_watermark);
+    ++index;
+    // 绑定UDP客户端空闲超时
+    if (config.client_idle_timeout > 0) sqlite3_bind_int64(stmt, index, config.client_idle_timeout);
+    ++index;
+    // 绑定串口接收参数
+    if (config.low_latency) sqlite3_bind_int(stmt, index, 1);
+    ++index;
+    if (config.vmin > 0) sqlite3_bind_int64(stmt, index, config.vmin);
+    ++index;
+    if (config.vtime > 0) sqlite3_bind_int64(stmt, index, config.vtime);
+    ++index;
+    // 绑定分帧参数
+    if (!config.framing.empty()) sqlite3_bind_text(stmt, index, config.framing.c_str(), -1, SQLITE_TRANSIENT);
+    ++index;
+    if (config.frame_length_offset > 0) sqlite3_bind_int64(stmt, index, config.frame_length_offset);
+    ++index;
+    if (config.frame_length_size > 0) sqlite3_bind_int64(stmt, index, config.frame_length_size);
+    ++index;
+    if (config.frame_length_adjust != 0) sqlite3_bind_int(stmt, index, config.frame_length_adjust);
+    ++index;
+    if (!config.frame_delimiter.empty()) {
+        sqlite3_bind_text(stmt, index, config.frame_delimiter.data(), static_cast<int>(config.frame_delimiter.size()),
+                          SQLITE_TRANSIENT);
+    }
+    ++index;
+    if (config.frame_size > 0) sqlite3_bind_int64(stmt, index, config.frame_size);
+    ++index;
+    if (config.frame_gap_us > 0) sqlite3_bind_int64(stmt, index, config.frame_gap_us);
+    ++index;
+    if (config.max_frame_size > 0) sqlite3_bind_int64(stmt, index, config.max_frame_size);
+    ++index;
+}
+} // namespace
+
+std::vector<ChannelConfig> Database::loadChannels() {
+    static const std::string sql = channelSelect(true, "");
+    sqlite3_stmt* stmt = statement(sql);
+    StatementScope scope(stmt);
+
+    std::vector<ChannelConfig> channels;
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        channels.push_back(readChannel(stmt));
+    }
+    if (rc != SQLITE_DONE) throw std::runtime_error(sqlite3_errmsg(db_));
+    return channels;
+}
+
+bool Database::loadChannel(const std::string& name, ChannelConfig& config) {
+    static const std::string sql = channelSelect(false, "WHERE c.name = ?");
+    sqlite3_stmt* stmt = statement(sql);
+    StatementScope scope(stmt);
+    sqlite3_bind_text(stmt, 1, name.c_str(), -1, SQLITE_TRANSIENT);
+
+    const int rc = sqlite3_step(stmt);
+    if (rc == SQLITE_DONE) return false;
+    if (rc != SQLITE_ROW) throw std::runtime_error(sqlite3_errmsg(db_));
+    // 输入 / 输出端点的 type 列为 NULL：端点缺失
+    if (sqlite3_column_type(stmt, 4) == SQLITE_NULL || sqlite3_column_type(stmt, kOutputTypeCol) == SQLITE_NULL) {
+        return false;
+    }
+    config = readChannel(stmt);
+    return true;
+}
+
+ChannelChanges Database::loadChangesSince(int64_t version) {
+    // LEFT JOIN：端点被删除后通道仍会出现在变更中，按已删除处理
+    static const std::string changedSql = channelSelect(false, "WHERE c.version > ?");
+    static const std::string removedSql = "SELECT name FROM deleted_channels WHERE version > ?;";
+
+    ChannelChanges changes;
+    executeSQL("BEGIN;");
+    try {
+        changes.version = queryInt64("SELECT value FROM config_version;");
+
+        sqlite3_stmt* stmt = statement(changedSql);
+        {
+            StatementScope scope(stmt);
+            sqlite3_bind_int64(stmt, 1, version);
+            int rc;
+            while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+                // 输入 / 输出端点的 type 列为 NULL：端点缺失
+                if (sqlite3_column_type(stmt, 4) == SQLITE_NULL ||
+                    sqlite3_column_type(stmt, kOutputTypeCol) == SQLITE_NULL) {
+                    changes.removed.push_back(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0)));
+                    continue;
+                }
+                changes.changed.push_back(readChannel(stmt));
+            }
+            if (rc != SQLITE_DONE) throw std::runtime_error(sqlite3_errmsg(db_));
+        }
+
+        if (version >= 0) {
+            stmt = statement(removedSql);
+            StatementScope scope(stmt);
+            sqlite3_bind_int64(stmt, 1, version);
+            int rc;
+            while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+                changes.removed.push_back(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0)));
+            }
+            if (rc != SQLITE_DONE) throw std::runtime_error(sqlite3_errmsg(db_));
+        }
+        executeSQL("COMMIT;");
+    } catch (...) {
+        executeSQL("ROLLBACK;");
+        throw;
+    }
+    return changes;
+}
+
+void Database::saveChannels(const std::vector<ChannelConfig>& channels) {
+    // 不开启事务：由调用方决定（replaceChannels 在同一个事务中调用）
+    for (const auto& channel : channels) {
+        upsertChannel(channel);
     }
-    
+}
+
+void Database::upsertChannel(const ChannelConfig& channel) {
+    sqlite3_stmt* stmt = statement(kUpsertChannelSql);
+    {
+        StatementScope scope(stmt);
+        sqlite3_bind_text(stmt, 1, channel.name.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(stmt, 2, channel.zero_copy ? 1 : 0);
+        sqlite3_bind_text(stmt, 3, channel.flow_control.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 4, channel.log_level.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 5, channel.conversion.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int64(stmt, 6, channel.modbus_timeout_ms);
+        if (sqlite3_step(stmt) != SQLITE_DONE) {
+            throw std::runtime_error("Failed to upsert channel: " + channel.name + ": " + sqlite3_errmsg(db_));
+        }
+    }
+
+    // 输入端点
+    upsertEndpoint(channel.name, "input", channel.input);
+    // 输出端点
+    upsertEndpoint(channel.name, "output", channel.output);
+}
+
+void Database::upsertEndpoint(const std::string& channelName, const char* role, const EndpointConfig& config) {
+    static const std::string sql = upsertEndpointSql();
+    sqlite3_stmt* stmt = statement(sql);
+    StatementScope scope(stmt);
+    sqlite3_bind_text(stmt, 1, channelName.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt, 2, role, -1, SQLITE_STATIC);
+    bindEndpoint(stmt, 3, config);
     if (sqlite3_step(stmt) != SQLITE_DONE) {
-        throw std::runtime_error("Failed to insert endpoint: " + config.type);
+        throw std::runtime_error("Failed to upsert endpoint: " + config.type + ": " + sqlite3_errmsg(db_));
     }
-    
-    sqlite3_reset(stmt);
 }
 
 void Database::replaceChannels(const std::vector<ChannelConfig>& channels) {
-    executeSQL("BEGIN TRANSACTION;");
+    // IMMEDIATE：开始时即取得写锁，避免读后升级写锁时与其他写入方冲突
+    executeSQL("BEGIN IMMEDIATE;");
     try {
-        executeSQL("DELETE FROM endpoints;");
-        executeSQL("DELETE FROM channels;");
-        saveChannels(channels);  // 现在在同一个事务中
+        // 与现有配置比较，内容相同的通道不写入（不更新版本，运行中的实例不会重新读取）
+        std::unordered_map<std::string, ChannelConfig> existing;
+        for (auto& config : loadChannels()) {
+            existing.emplace(config.name, std::move(config));
+        }
+
+        std::unordered_set<std::string> names;
+        for (const auto& channel : channels) {
+            names.insert(channel.name);
+            auto it = existing.find(channel.name);
+            if (it == existing.end() || it->second != channel) {
+                upsertChannel(channel);
+            }
+        }
+
+        // 删除不在新配置中的通道（包括端点不完整的通道），端点随外键级联删除
+        std::vector<std::string> removed;
+        {
+            sqlite3_stmt* stmt = statement("SELECT name FROM channels;");
+            StatementScope scope(stmt);
+            int rc;
+            while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+                const char* name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+                if (names.count(name) == 0) removed.emplace_back(name);
+            }
+            if (rc != SQLITE_DONE) throw std::runtime_error(sqlite3_errmsg(db_));
+        }
+        sqlite3_stmt* stmt = statement("DELETE FROM channels WHERE name = ?;");
+        for (const auto& name : removed) {
+            StatementScope scope(stmt);
+            sqlite3_bind_text(stmt, 1, name.c_str(), -1, SQLITE_TRANSIENT);
+            if (sqlite3_step(stmt) != SQLITE_DONE) {
+                throw std::runtime_error("Failed to delete channel: " + name + ": " + sqlite3_errmsg(db_));
+            }
+        }
         executeSQL("COMMIT;");
     } catch (...) {
         executeSQL("ROLLBACK;");
         throw;
     }
-}
\ No newline at end of file
+}
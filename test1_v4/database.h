@@ -2,27 +2,56 @@
 #include "shared_structs.h"
 #include <vector>
 #include <string>
+#include <cstdint>
+#include <unordered_map>
 #include <sqlite3.h>
 
+// 自某个配置版本以来的变更
+struct ChannelChanges {
+    int64_t version = 0;                 // 本次读取时的配置版本
+    std::vector<ChannelConfig> changed;  // 新增或修改的通道（完整配置）
+    std::vector<std::string> removed;    // 已删除或端点不完整的通道
+};
+
 class Database {
 public:
     explicit Database(const std::string& db_path = "config.db");
     ~Database();
+
+    Database(const Database&) = delete;
+    Database& operator=(const Database&) = delete;
     
     // 加载所有通道配置
     std::vector<ChannelConfig> loadChannels();
+
+    // 按名称加载一个通道，通道不存在或端点不完整时返回 false
+    bool loadChannel(const std::string& name, ChannelConfig& config);
+
+    // 读取 version 之后变更的通道（version < 0 时读取全部），在同一个读事务中完成
+    // 通道的版本由触发器维护：修改通道或其端点时取全局递增的配置版本
+    ChannelChanges loadChangesSince(int64_t version);
+
+    // PRAGMA data_version：其他连接提交写事务后变化，用于廉价地判断是否需要重新读取
+    int64_t dataVersion();
     
-    // 保存通道配置到数据库
+    // 保存通道配置到数据库（同名通道更新，内容相同的行不写入）
     void saveChannels(const std::vector<ChannelConfig>& channels);
     
-    // 清空并替换所有配置
+    // 替换所有配置：只写入新增 / 修改的通道并删除不再存在的通道，在一个事务中完成
     void replaceChannels(const std::vector<ChannelConfig>& channels);
 
 private:
     sqlite3* db_;
+    // 预编译语句缓存（按 SQL 文本），连接关闭前统一释放
+    std::unordered_map<std::string, sqlite3_stmt*> statements_;
     
     void initDatabase();
     void executeSQL(const std::string& sql);
-    void insertEndpoint(sqlite3_stmt* stmt, sqlite3_int64 channelId, 
-                       const std::string& role, const EndpointConfig& config);
+    // 取得缓存的预编译语句（首次使用时编译），使用后由调用方复位
+    sqlite3_stmt* statement(const std::string& sql);
+    int64_t queryInt64(const std::string& sql);
+    void addColumnIfMissing(const std::string& table, const std::string& column,
+                            const std::string& definition);
+    void upsertChannel(const ChannelConfig& channel);
+    void upsertEndpoint(const std::string& channelName, const char* role, const EndpointConfig& config);
 };
\ No newline at end of file
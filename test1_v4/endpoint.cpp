@@ -1,11 +1,14 @@
 #include "endpoint.h"
+#include "reactor.h"
 #include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <sys/epoll.h>
 
 Endpoint::Endpoint() = default;
 
-Endpoint::~Endpoint() {
-    stopThread();
-}
+Endpoint::~Endpoint() = default;
 
 void Endpoint::setDataCallback(DataCallback cb) {
     _dataCallback = std::move(cb);
@@ -19,36 +22,82 @@ void Endpoint::setErrorCallback(ErrorCallback cb) {
     _errorCallback = std::move(cb);
 }
 
-bool Endpoint::isRunning() const {
-    return _running;
+void Endpoint::setSpliceCallback(SpliceCallback cb) {
+    _spliceCallback = std::move(cb);
 }
 
-bool Endpoint::isConnected() const {
-    return _state == State::CONNECTED;
+void Endpoint::setWritableCallback(WritableCallback cb) {
+    _writableCallback = std::move(cb);
+}
+
+ssize_t Endpoint::writev(const struct iovec* iov, int iovcnt) {
+    // 默认实现：逐段调用 write()，视为全部接收
+    ssize_t total = 0;
+    for (int i = 0; i < iovcnt; ++i) {
+        write(static_cast<const uint8_t*>(iov[i].iov_base), iov[i].iov_len);
+        total += iov[i].iov_len;
+    }
+    return total;
+}
+
+size_t Endpoint::iovLength(const struct iovec* iov, int iovcnt) {
+    size_t total = 0;
+    for (int i = 0; i < iovcnt; ++i) {
+        total += iov[i].iov_len;
+    }
+    return total;
+}
+
+ssize_t Endpoint::spliceFrom(int, size_t) {
+    return -1;
+}
+
+void Endpoint::spliceDiscard(int pipeFd, size_t len) {
+    static const int devNull = ::open("/dev/null", O_WRONLY | O_CLOEXEC);
+    while (len > 0) {
+        ssize_t n = devNull >= 0
+            ? splice(pipeFd, nullptr, devNull, nullptr, len, SPLICE_F_NONBLOCK)
+            : -1;
+        if (n <= 0) {
+            // /dev/null 不可用时读出丢弃
+            uint8_t buffer[4096];
+            n = ::read(pipeFd, buffer, std::min(len, sizeof(buffer)));
+            if (n <= 0) return;
+        }
+        len -= n;
+    }
+}
+
+void Endpoint::setReadPaused(bool paused) {
+    if (_readPaused.exchange(paused) == paused) return;
+    updateReadInterest();
 }
 
-void Endpoint::startThread() {
-    if (_running) return;
-    
-    _running = true;
-    _worker = std::thread([this] {
-        run();
-    });
+bool Endpoint::isReadPaused() const {
+    return _readPaused.load(std::memory_order_acquire);
 }
 
-void Endpoint::stopThread() {
-    if (!_running) return;
-    
-    _running = false;
-    notifyThread();
-    
-    if (_worker.joinable()) {
-        _worker.join();
+uint32_t Endpoint::readEvents() const {
+    return isReadPaused() ? 0u : static_cast<uint32_t>(EPOLLIN);
+}
+
+void Endpoint::setEventLoop(EventLoop* loop) {
+    _loop = loop;
+}
+
+EventLoop* Endpoint::getEventLoop() {
+    if (!_loop) {
+        _loop = Reactor::getInstance().nextLoop();
     }
+    return _loop;
 }
 
-void Endpoint::notifyThread() {
-    _cv.notify_one();
+bool Endpoint::isRunning() const {
+    return _running;
+}
+
+bool Endpoint::isConnected() const {
+    return _state == State::CONNECTED;
 }
 
 void Endpoint::setState(State newState) {
@@ -68,16 +117,26 @@ void Endpoint::logMessage(const std::string& msg) {
 }
 
 void Endpoint::logError(const std::string& error) {
+    reportError(error);
+    setState(State::ERROR);
+}
+
+void Endpoint::reportError(const std::string& error) {
     if (_errorCallback) {
         _errorCallback(error);
     } else {
         LOG_ERROR("%s", error.c_str());
     }
-    setState(State::ERROR);
 }
 
 void Endpoint::processData(const uint8_t* data, size_t len) {
     if (_dataCallback) {
         _dataCallback(data, len);
     }
-}
\ No newline at end of file
+}
+
+void Endpoint::notifyWritable() {
+    if (_writableCallback) {
+        _writableCallback();
+    }
+}
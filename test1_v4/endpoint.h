@@ -1,18 +1,25 @@
 #pragma once
 #include <cstdint>
+#include <cstddef>
 #include <string>
 #include <functional>
-#include <thread>
 #include <atomic>
 #include <mutex>
-#include <condition_variable>
+#include <sys/types.h>
+#include <sys/uio.h>
 #include "logrecord.h"
+#include "event_loop.h"
+#include "channel_metrics.h"
 class Endpoint {
 public:
     // 回调函数类型定义
     using DataCallback = std::function<void(const uint8_t* data, size_t len)>;
     using LogCallback = std::function<void(const std::string& msg)>;
     using ErrorCallback = std::function<void(const std::string& error)>;
+    // 零拷贝转发回调：源 socket 可读时调用，返回 false 表示对端已关闭
+    using SpliceCallback = std::function<bool(int fd)>;
+    // 可写通知回调：writev 部分写入后，端点再次可写时调用
+    using WritableCallback = std::function<void()>;
 
     Endpoint();
     virtual ~Endpoint();
@@ -21,24 +28,45 @@ public:
     virtual bool open() = 0;
     virtual void close() = 0;
     virtual void write(const uint8_t* data, size_t len) = 0;
+    // 向量写：一次系统调用提交多段数据，返回内核已接收的字节数
+    // 返回值小于总长度时，剩余数据由调用方保留，待可写通知后重试
+    // 返回 -1 表示目标不可用（未连接 / 写入出错），不会有可写通知，调用方丢弃这部分数据并计入丢弃
+    virtual ssize_t writev(const struct iovec* iov, int iovcnt);
+    // 单次写入的最大字节数（数据报类端点受报文长度限制）
+    virtual size_t maxWriteSize() const { return static_cast<size_t>(-1); }
     
     // 回调设置
     void setDataCallback(DataCallback cb);
     void setLogCallback(LogCallback cb);
     void setErrorCallback(ErrorCallback cb);
+    void setSpliceCallback(SpliceCallback cb);
+    void setWritableCallback(WritableCallback cb);
+
+    // 零拷贝（splice）支持：从管道搬运最多 len 字节到本端点，返回已写出的字节数（-1 的含义与 writev 相同）
+    virtual bool supportsSplice() const { return false; }
+    virtual ssize_t spliceFrom(int pipeFd, size_t len);
+    // 丢弃管道中的 len 字节（splice 到 /dev/null）
+    static void spliceDiscard(int pipeFd, size_t len);
+    // 计算 iovec 总长度
+    static size_t iovLength(const struct iovec* iov, int iovcnt);
+
+    // 流量控制：暂停/恢复读取（从事件注册中去掉/恢复 EPOLLIN），任意线程可调用
+    void setReadPaused(bool paused);
+    bool isReadPaused() const;
+
+    // 事件循环绑定（需在 open() 之前设置；未设置时由 Reactor 轮询分配）
+    void setEventLoop(EventLoop* loop);
+    EventLoop* getEventLoop();
 
     bool isRunning() const;
     bool isConnected() const;
 
+    // 填充端点状态（统计读取线程调用，只读取原子计数，不加端点锁）
+    virtual void fillStats(EndpointStats& stats) const { stats.connected = isConnected(); }
+
 protected:
     enum class State { DISCONNECTED, CONNECTING, CONNECTED, ERROR };
 
-    // 线程控制
-    virtual void run() = 0;
-    void startThread();
-    void stopThread();
-    void notifyThread();
-
     // 状态管理
     void setState(State newState);
     State getState() const;
@@ -46,17 +74,26 @@ protected:
     // 回调函数
     void logMessage(const std::string& msg);
     void logError(const std::string& error);
+    // 报告不影响端点状态的错误（如单个数据报发送失败），不设置 ERROR 状态
+    void reportError(const std::string& error);
     void processData(const uint8_t* data, size_t len);
+    void notifyWritable();
+    // 读暂停状态变化后由子类更新 fd 的事件注册（需自行保证线程安全）
+    virtual void updateReadInterest() {}
+    // 按当前读暂停状态返回读事件掩码
+    uint32_t readEvents() const;
 
     // 同步工具
     std::atomic<State> _state{State::DISCONNECTED};
     std::atomic<bool> _running{false};
-    std::thread _worker;
+    std::atomic<bool> _readPaused{false};
     std::mutex _mutex;
-    std::condition_variable _cv;
+    EventLoop* _loop = nullptr;
 
     // 回调函数对象
     DataCallback _dataCallback;
     LogCallback _logCallback;
     ErrorCallback _errorCallback;
-};
\ No newline at end of file
+    SpliceCallback _spliceCallback;
+    WritableCallback _writableCallback;
+};
@@ -0,0 +1,592 @@
+// event_loop.cpp
+#include "event_loop.h"
+#include "logrecord.h"
+#include "uring.h"
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <cstring>
+#include <future>
+#include <stdexcept>
+#include <algorithm>
+
+namespace {
+constexpr int kMaxEvents = 64;
+constexpr uint32_t kWakeupGeneration = 0;
+
+// io_uring 参数
+constexpr unsigned kRingEntries = 1024;
+constexpr uint16_t kRecvBufferGroup = 0;
+constexpr unsigned kRecvBufferCount = 256;                 // 2 的幂
+constexpr size_t kRecvBufferSize = 4096 + 64;              // 数据报模式需容纳 io_uring_recvmsg_out 与地址
+constexpr size_t kMaxSendChains = 256;
+
+// io_uring user_data 编码：接收为 标志|代号|fd，发送为 标志|链下标，0 为取消请求
+constexpr uint64_t kRecvTag = 1ull << 63;
+constexpr uint64_t kSendTag = 1ull << 62;
+constexpr uint64_t kSendFinalTag = 1ull << 61;
+
+inline uint64_t makeRecvKey(int fd, uint32_t generation) {
+    return kRecvTag | (static_cast<uint64_t>(generation & 0x1FFFFFFFu) << 32) | static_cast<uint32_t>(fd);
+}
+
+inline uint64_t makeKey(int fd, uint32_t generation) {
+    return (static_cast<uint64_t>(generation) << 32) | static_cast<uint32_t>(fd);
+}
+} // namespace
+
+EventLoop::EventLoop(size_t index, bool useIoUring) : _index(index) {
+    _epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (_epollFd < 0) {
+        throw std::runtime_error("Epoll creation failed: " + std::string(strerror(errno)));
+    }
+
+    _wakeupFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (_wakeupFd < 0) {
+        ::close(_epollFd);
+        throw std::runtime_error("Eventfd creation failed: " + std::string(strerror(errno)));
+    }
+
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = makeKey(_wakeupFd, kWakeupGeneration);
+    if (epoll_ctl(_epollFd, EPOLL_CTL_ADD, _wakeupFd, &event) < 0) {
+        ::close(_wakeupFd);
+        ::close(_epollFd);
+        throw std::runtime_error("Epoll_ctl wakeup failed: " + std::string(strerror(errno)));
+    }
+
+    if (useIoUring) {
+        setupIoUring();
+    }
+}
+
+EventLoop::~EventLoop() {
+    stop();
+    // 先销毁 ring：内核不再访问发送链与接收模板
+    _ring.reset();
+    ::close(_wakeupFd);
+    ::close(_epollFd);
+}
+
+void EventLoop::start() {
+    if (_running.exchange(true)) return;
+    _thread = std::thread([this] { run(); });
+}
+
+void EventLoop::stop() {
+    if (!_running.exchange(false)) return;
+    wakeup();
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+    // 执行退出前残留的任务，保证 runAndWait 的调用方不会永久等待
+    runPendingTasks();
+}
+
+bool EventLoop::isInLoopThread() const {
+    return _threadId.load(std::memory_order_acquire) == std::this_thread::get_id();
+}
+
+bool EventLoop::addFd(int fd, uint32_t events, EventHandler handler) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (++_generation == kWakeupGeneration) ++_generation;
+
+    // 已注册 io_uring 接收的 fd：读事件由多发接收处理
+    auto recv = _recvs.find(fd);
+    if (recv != _recvs.end()) {
+        applyRecvInterestLocked(fd, recv->second, events & EPOLLIN);
+        events &= ~(EPOLLIN | EPOLLRDHUP);
+    }
+
+    epoll_event event{};
+    event.events = events;
+    event.data.u64 = makeKey(fd, _generation);
+    if (epoll_ctl(_epollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+        return false;
+    }
+
+    _handlers[fd] = Registration{_generation, std::make_shared<EventHandler>(std::move(handler))};
+    _fdCount.store(_handlers.size(), std::memory_order_relaxed);
+    return true;
+}
+
+bool EventLoop::modifyFd(int fd, uint32_t events) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto recv = _recvs.find(fd);
+    if (recv != _recvs.end()) {
+        applyRecvInterestLocked(fd, recv->second, events & EPOLLIN);
+        events &= ~(EPOLLIN | EPOLLRDHUP);
+    }
+
+    auto it = _handlers.find(fd);
+    if (it == _handlers.end()) return recv != _recvs.end();
+
+    epoll_event event{};
+    event.events = events;
+    event.data.u64 = makeKey(fd, it->second.generation);
+    return epoll_ctl(_epollFd, EPOLL_CTL_MOD, fd, &event) == 0;
+}
+
+void EventLoop::removeFd(int fd) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        bool found = false;
+        auto recv = _recvs.find(fd);
+        if (recv != _recvs.end()) {
+            // 取消后迟到的完成事件按代号过滤，只归还缓冲区
+            if (recv->second.armed) cancelRecvLocked(fd, recv->second);
+            _recvs.erase(recv);
+            found = true;
+        }
+        if (_handlers.erase(fd) > 0) {
+            epoll_ctl(_epollFd, EPOLL_CTL_DEL, fd, nullptr);
+            _fdCount.store(_handlers.size(), std::memory_order_relaxed);
+            found = true;
+        }
+        if (!found) return;
+    }
+    waitForCallbacks();
+}
+
+void EventLoop::setupIoUring() {
+    std::unique_ptr<IoUring> ring;
+    try {
+        ring = std::make_unique<IoUring>(kRingEntries);
+    } catch (const std::exception& e) {
+        LOG_WARNING("EventLoop %zu: %s, falling back to epoll", _index, e.what());
+        return;
+    }
+
+    // 多发接收依赖提供缓冲区环（5.19+）；跳过成功完成事件依赖 CQE_SKIP（5.17+）
+    if (!(ring->features() & IORING_FEAT_CQE_SKIP) ||
+        !ring->setupBufferRing(kRecvBufferGroup, kRecvBufferCount, kRecvBufferSize)) {
+        LOG_WARNING("EventLoop %zu: io_uring lacks provided buffer rings, falling back to epoll", _index);
+        return;
+    }
+
+    const int ringFd = ring->fd();
+    _ring = std::move(ring);
+    if (!addFd(ringFd, EPOLLIN, [this](uint32_t) { reapCompletions(); })) {
+        LOG_WARNING("EventLoop %zu: cannot poll io_uring fd, falling back to epoll", _index);
+        _ring.reset();
+        return;
+    }
+
+    _recvMsgTemplate.msg_namelen = sizeof(sockaddr_in);
+}
+
+bool EventLoop::addRecv(int fd, bool datagram, bool armed, RecvHandler handler) {
+    if (!_ring) return false;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (++_generation == kWakeupGeneration) ++_generation;
+
+    auto result = _recvs.emplace(fd, RecvRegistration{
+        _generation, datagram, false, false, std::make_shared<RecvHandler>(std::move(handler))});
+    if (!result.second) return false;
+
+    applyRecvInterestLocked(fd, result.first->second, armed);
+    return true;
+}
+
+void EventLoop::applyRecvInterestLocked(int fd, RecvRegistration& reg, bool want) {
+    reg.wantArmed = want;
+    if (want && !reg.armed) {
+        armRecvLocked(fd, reg);
+    } else if (!want && reg.armed) {
+        // 取消完成前到达的数据仍会正常交付
+        cancelRecvLocked(fd, reg);
+    }
+}
+
+void EventLoop::armRecvLocked(int fd, RecvRegistration& reg) {
+    std::lock_guard<std::mutex> lock(_ringMutex);
+    io_uring_sqe* sqe = _ring->getSqe();
+    if (!sqe) {
+        _ring->submit();
+        sqe = _ring->getSqe();
+        if (!sqe) {
+            LOG_ERROR("EventLoop %zu: io_uring submission queue full, fd %d not armed", _index, fd);
+            return;
+        }
+    }
+
+    sqe->fd = fd;
+    if (reg.datagram) {
+        sqe->opcode = IORING_OP_RECVMSG;
+        sqe->addr = reinterpret_cast<uint64_t>(&_recvMsgTemplate);
+        sqe->len = 1;
+    } else {
+        sqe->opcode = IORING_OP_RECV;
+    }
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = kRecvBufferGroup;
+    sqe->user_data = makeRecvKey(fd, reg.generation);
+
+    int ret = _ring->submit();
+    if (ret < 0) {
+        LOG_ERROR("EventLoop %zu: io_uring submit failed for fd %d: %s", _index, fd, strerror(-ret));
+        return;
+    }
+    reg.armed = true;
+}
+
+void EventLoop::cancelRecvLocked(int fd, const RecvRegistration& reg) {
+    std::lock_guard<std::mutex> lock(_ringMutex);
+    io_uring_sqe* sqe = _ring->getSqe();
+    if (!sqe) {
+        _ring->submit();
+        sqe = _ring->getSqe();
+        if (!sqe) return;
+    }
+
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = makeRecvKey(fd, reg.generation);
+    sqe->flags = IOSQE_CQE_SKIP_SUCCESS;
+    sqe->user_data = 0;
+    _ring->submit();
+}
+
+bool EventLoop::sendTo(int fd, const struct iovec* iov, int iovcnt,
+                       const sockaddr_in* addrs, size_t count) {
+    if (!_ring || count == 0) return false;
+
+    std::lock_guard<std::mutex> lock(_ringMutex);
+    if (_ring->sqSpace() < count) {
+        _ring->submit();
+        if (_ring->sqSpace() < count) return false;
+    }
+
+    uint32_t index;
+    if (!_freeSendChains.empty()) {
+        index = _freeSendChains.back();
+        _freeSendChains.pop_back();
+    } else if (_sendChains.size() < kMaxSendChains) {
+        index = static_cast<uint32_t>(_sendChains.size());
+        _sendChains.push_back(std::make_unique<SendChain>());
+    } else {
+        return false; // 在途发送过多，交给调用方同步发送
+    }
+
+    // 数据复制到链上（容量复用，稳定后不再分配）
+    SendChain& chain = *_sendChains[index];
+    chain.payload.clear();
+    for (int i = 0; i < iovcnt; ++i) {
+        const uint8_t* base = static_cast<const uint8_t*>(iov[i].iov_base);
+        chain.payload.insert(chain.payload.end(), base, base + iov[i].iov_len);
+    }
+    chain.iov.iov_base = chain.payload.data();
+    chain.iov.iov_len = chain.payload.size();
+    chain.addrs.assign(addrs, addrs + count);
+    chain.hdrs.resize(count);
+
+    // 硬链接保证按顺序发送且单个目标失败不影响后续目标；成功时只有最后一个请求产生完成事件
+    for (size_t i = 0; i < count; ++i) {
+        msghdr& hdr = chain.hdrs[i];
+        hdr = msghdr{};
+        hdr.msg_name = &chain.addrs[i];
+        hdr.msg_namelen = sizeof(sockaddr_in);
+        hdr.msg_iov = &chain.iov;
+        hdr.msg_iovlen = 1;
+
+        const bool last = i + 1 == count;
+        io_uring_sqe* sqe = _ring->getSqe();
+        sqe->opcode = IORING_OP_SENDMSG;
+        sqe->fd = fd;
+        sqe->addr = reinterpret_cast<uint64_t>(&hdr);
+        sqe->len = 1;
+        sqe->flags = last ? 0 : (IOSQE_IO_HARDLINK | IOSQE_CQE_SKIP_SUCCESS);
+        sqe->user_data = kSendTag | (last ? kSendFinalTag : 0) | index;
+    }
+
+    int ret = _ring->submit();
+    if (ret < 0) {
+        // 未进入内核的请求不会产生完成事件，链立即回收
+        LOG_ERROR("EventLoop %zu: io_uring submit failed for fd %d: %s", _index, fd, strerror(-ret));
+        _freeSendChains.push_back(index);
+        return false;
+    }
+    return true;
+}
+
+void EventLoop::reapCompletions() {
+    _ring->reap([this](const io_uring_cqe& cqe) {
+        if (cqe.user_data & kSendTag) {
+            handleSendCompletion(cqe.user_data, cqe.res);
+        } else if (cqe.user_data & kRecvTag) {
+            handleRecvCompletion(cqe.user_data, cqe.res, cqe.flags);
+        }
+    });
+}
+
+void EventLoop::handleSendCompletion(uint64_t userData, int res) {
+    if (res < 0) {
+        LOG_WARNING("EventLoop %zu: io_uring send failed: %s", _index, strerror(-res));
+    }
+    if (userData & kSendFinalTag) {
+        std::lock_guard<std::mutex> lock(_ringMutex);
+        _freeSendChains.push_back(static_cast<uint32_t>(userData & 0xFFFFFFFFu));
+    }
+}
+
+void EventLoop::handleRecvCompletion(uint64_t userData, int res, uint32_t flags) {
+    const int fd = static_cast<int>(userData & 0xFFFFFFFFu);
+    const bool more = flags & IORING_CQE_F_MORE;
+    const bool hasBuffer = flags & IORING_CQE_F_BUFFER;
+    const uint16_t bid = static_cast<uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT);
+
+    std::shared_ptr<RecvHandler> handler;
+    bool datagram = false;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _recvs.find(fd);
+        // fd 可能已被注销或复用，按注册代号过滤
+        if (it != _recvs.end() && makeRecvKey(fd, it->second.generation) == userData) {
+            handler = it->second.handler;
+            datagram = it->second.datagram;
+            if (!more) it->second.armed = false;
+        }
+    }
+
+    // 流式 socket 读到 0 表示对端关闭；缓冲区耗尽与主动取消不是错误
+    const bool closed = res == 0 && !datagram;
+    const bool failed = res < 0 && res != -ENOBUFS && res != -ECANCELED;
+
+    if (handler) {
+        try {
+            if (res > 0 && hasBuffer) {
+                const uint8_t* buf = _ring->buffer(bid);
+                if (datagram) {
+                    // 布局：io_uring_recvmsg_out | 地址（按模板长度预留）| 负载
+                    const auto* out = reinterpret_cast<const io_uring_recvmsg_out*>(buf);
+                    const size_t offset = sizeof(io_uring_recvmsg_out) + _recvMsgTemplate.msg_namelen;
+                    if (static_cast<size_t>(res) >= offset) {
+                        size_t len = std::min<size_t>(out->payloadlen, res - offset);
+                        sockaddr_in from{};
+                        std::memcpy(&from, buf + sizeof(io_uring_recvmsg_out),
+                                    std::min<size_t>(out->namelen, sizeof(from)));
+                        if (len > 0) (*handler)(buf + offset, len, &from);
+                    }
+                } else {
+                    (*handler)(buf, res, nullptr);
+                }
+            } else if (closed) {
+                (*handler)(nullptr, 0, nullptr);
+            } else if (failed) {
+                (*handler)(nullptr, res, nullptr);
+            }
+        } catch (const std::exception& e) {
+            LOG_ERROR("EventLoop %zu recv handler error on fd %d: %s", _index, fd, e.what());
+        }
+    }
+
+    if (hasBuffer) {
+        _ring->recycleBuffer(bid);
+    }
+
+    // 多发接收终止（缓冲区耗尽 / 取消后又恢复 / 数据报 socket 的临时错误）时重新提交
+    if (!more && handler && !closed && (!failed || datagram)) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _recvs.find(fd);
+        if (it != _recvs.end() && makeRecvKey(fd, it->second.generation) == userData &&
+            it->second.wantArmed && !it->second.armed) {
+            armRecvLocked(fd, it->second);
+        }
+    }
+}
+
+void EventLoop::runInLoop(Task task) {
+    if (isInLoopThread()) {
+        task();
+    } else {
+        queueInLoop(std::move(task));
+    }
+}
+
+void EventLoop::queueInLoop(Task task) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _pendingTasks.push_back(std::move(task));
+    }
+    wakeup();
+}
+
+void EventLoop::runAndWait(Task task) {
+    if (isInLoopThread() || !_running) {
+        task();
+        return;
+    }
+
+    std::promise<void> done;
+    auto future = done.get_future();
+    queueInLoop([&task, &done] {
+        try {
+            task();
+            done.set_value();
+        } catch (...) {
+            done.set_exception(std::current_exception());
+        }
+    });
+    future.get();
+}
+
+void EventLoop::waitForCallbacks() {
+    // 循环线程在本轮事件处理完成后才会执行任务队列，空任务即可作为屏障
+    if (!isInLoopThread() && _running) {
+        runAndWait([] {});
+    }
+}
+
+EventLoop::TimerId EventLoop::runAfter(std::chrono::milliseconds delay, Task task) {
+    return addTimer(delay, std::chrono::milliseconds(0), std::move(task));
+}
+
+EventLoop::TimerId EventLoop::runEvery(std::chrono::milliseconds interval, Task task) {
+    return addTimer(interval, interval, std::move(task));
+}
+
+EventLoop::TimerId EventLoop::addTimer(std::chrono::milliseconds delay,
+                                       std::chrono::milliseconds interval, Task task) {
+    TimerId id;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        id = _nextTimerId++;
+        Timer timer{Clock::now() + delay, interval, std::make_shared<Task>(std::move(task))};
+        _timerQueue.emplace(timer.when, id);
+        _timers.emplace(id, std::move(timer));
+    }
+    wakeup();
+    return id;
+}
+
+void EventLoop::cancelTimer(TimerId id) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _timers.find(id);
+        if (it == _timers.end()) return;
+        _timerQueue.erase({it->second.when, id});
+        _timers.erase(it);
+    }
+    waitForCallbacks();
+}
+
+void EventLoop::wakeup() {
+    uint64_t one = 1;
+    ssize_t ret = ::write(_wakeupFd, &one, sizeof(one));
+    (void)ret;
+}
+
+void EventLoop::handleWakeup() {
+    uint64_t value;
+    ssize_t ret = ::read(_wakeupFd, &value, sizeof(value));
+    (void)ret;
+}
+
+int EventLoop::nextTimeoutMs() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_pendingTasks.empty()) return 0;
+    if (_timerQueue.empty()) return -1;
+
+    auto delay = std::chrono::duration_cast<std::chrono::milliseconds>(
+        _timerQueue.begin()->first - Clock::now()).count();
+    // 向上取整，避免定时器提前 1ms 唤醒后空转
+    return delay <= 0 ? 0 : static_cast<int>(delay) + 1;
+}
+
+void EventLoop::run() {
+    _threadId.store(std::this_thread::get_id(), std::memory_order_release);
+    epoll_event events[kMaxEvents];
+
+    while (_running) {
+        int numEvents = epoll_wait(_epollFd, events, kMaxEvents, nextTimeoutMs());
+        if (numEvents < 0) {
+            if (errno != EINTR) {
+                LOG_ERROR("EventLoop %zu epoll_wait error: %s", _index, strerror(errno));
+            }
+            continue;
+        }
+
+        for (int i = 0; i < numEvents; ++i) {
+            dispatch(events[i].data.u64, events[i].events);
+        }
+
+        runExpiredTimers();
+        runPendingTasks();
+    }
+
+    _threadId.store(std::thread::id(), std::memory_order_release);
+}
+
+void EventLoop::dispatch(uint64_t key, uint32_t events) {
+    const int fd = static_cast<int>(key & 0xFFFFFFFFu);
+    const uint32_t generation = static_cast<uint32_t>(key >> 32);
+
+    if (generation == kWakeupGeneration) {
+        handleWakeup();
+        return;
+    }
+
+    std::shared_ptr<EventHandler> handler;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _handlers.find(fd);
+        // 同一批事件中 fd 可能已被注销或复用，按注册代号过滤
+        if (it == _handlers.end() || it->second.generation != generation) return;
+        handler = it->second.handler;
+    }
+
+    try {
+        (*handler)(events);
+    } catch (const std::exception& e) {
+        LOG_ERROR("EventLoop %zu handler error on fd %d: %s", _index, fd, e.what());
+    }
+}
+
+void EventLoop::runExpiredTimers() {
+    const auto now = Clock::now();
+    while (true) {
+        std::shared_ptr<Task> task;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_timerQueue.empty() || _timerQueue.begin()->first > now) break;
+
+            TimerId id = _timerQueue.begin()->second;
+            _timerQueue.erase(_timerQueue.begin());
+            auto it = _timers.find(id);
+            if (it == _timers.end()) continue;
+
+            task = it->second.task;
+            if (it->second.interval.count() > 0) {
+                it->second.when = now + it->second.interval;
+                _timerQueue.emplace(it->second.when, id);
+            } else {
+                _timers.erase(it);
+            }
+        }
+
+        try {
+            (*task)();
+        } catch (const std::exception& e) {
+            LOG_ERROR("EventLoop %zu timer error: %s", _index, e.what());
+        }
+    }
+}
+
+void EventLoop::runPendingTasks() {
+    std::vector<Task> tasks;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        tasks.swap(_pendingTasks);
+    }
+
+    for (auto& task : tasks) {
+        try {
+            task();
+        } catch (const std::exception& e) {
+            LOG_ERROR("EventLoop %zu task error: %s", _index, e.what());
+        }
+    }
+}
@@ -0,0 +1,145 @@
+// event_loop.h
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <set>
+#include <unordered_map>
+#include <memory>
+#include <chrono>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+class IoUring;
+
+// 单线程 epoll 事件循环
+// - fd 注册/注销可在任意线程调用
+// - 在非循环线程中注销 fd 或取消定时器时，会等待正在执行的回调结束后再返回，
+//   调用方随后即可安全地关闭 fd / 销毁回调引用的对象
+// - 可选 io_uring 后端：socket 的接收改为多发接收（multishot recv + 提供缓冲区环），
+//   数据报发送改为 SENDMSG 链；io_uring 的完成事件通过 ring fd 汇入同一个 epoll
+class EventLoop {
+public:
+    using EventHandler = std::function<void(uint32_t events)>;
+    using Task = std::function<void()>;
+    using TimerId = uint64_t;
+    using Clock = std::chrono::steady_clock;
+    // io_uring 接收回调：len > 0 为收到的数据；len == 0 表示对端关闭；len < 0 为 -errno
+    // from 仅数据报模式有效
+    using RecvHandler = std::function<void(const uint8_t* data, ssize_t len, const sockaddr_in* from)>;
+
+    // useIoUring 为 true 时尝试创建 io_uring，内核不支持时回退为纯 epoll
+    explicit EventLoop(size_t index = 0, bool useIoUring = false);
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    void start();
+    void stop();
+
+    // fd 管理
+    bool addFd(int fd, uint32_t events, EventHandler handler);
+    bool modifyFd(int fd, uint32_t events);
+    void removeFd(int fd);
+
+    // io_uring 接收（仅 hasIoUring() 时可用）
+    // 注册后该 fd 在 addFd/modifyFd 中的 EPOLLIN 表示是否接收（EPOLLRDHUP 一并忽略），
+    // 其余事件仍由 epoll 回调；removeFd 同时注销接收
+    bool hasIoUring() const { return _ring != nullptr; }
+    bool addRecv(int fd, bool datagram, bool armed, RecvHandler handler);
+    // 同一数据报经硬链接的 SENDMSG 依次发往 addrs（数据先复制，调用后即可释放）
+    // 返回 false 表示未提交（无 io_uring / 队列已满），由调用方同步发送
+    bool sendTo(int fd, const struct iovec* iov, int iovcnt, const sockaddr_in* addrs, size_t count);
+
+    // 任务投递
+    void runInLoop(Task task);      // 在循环线程中执行（当前即循环线程时立即执行）
+    void queueInLoop(Task task);    // 总是排队到下一轮执行
+    void runAndWait(Task task);     // 在循环线程中执行并等待完成
+
+    // 定时器（回调在循环线程中执行）
+    TimerId runAfter(std::chrono::milliseconds delay, Task task);
+    TimerId runEvery(std::chrono::milliseconds interval, Task task);
+    void cancelTimer(TimerId id);
+
+    bool isInLoopThread() const;
+    size_t index() const { return _index; }
+    size_t fdCount() const { return _fdCount.load(std::memory_order_relaxed); }
+
+private:
+    struct Registration {
+        uint32_t generation;
+        std::shared_ptr<EventHandler> handler;
+    };
+
+    struct RecvRegistration {
+        uint32_t generation;
+        bool datagram;
+        bool wantArmed; // 调用方期望接收
+        bool armed;     // 内核中有进行中的多发接收
+        std::shared_ptr<RecvHandler> handler;
+    };
+
+    // 一次 sendTo 的数据与消息头，在链上最后一个请求完成前保持有效
+    struct SendChain {
+        std::vector<uint8_t> payload;
+        struct iovec iov;
+        std::vector<sockaddr_in> addrs;
+        std::vector<msghdr> hdrs;
+    };
+
+    struct Timer {
+        Clock::time_point when;
+        std::chrono::milliseconds interval;
+        std::shared_ptr<Task> task;
+    };
+
+    void run();
+    void wakeup();
+    void handleWakeup();
+    void dispatch(uint64_t key, uint32_t events);
+    void runPendingTasks();
+    void runExpiredTimers();
+    int nextTimeoutMs();
+    TimerId addTimer(std::chrono::milliseconds delay, std::chrono::milliseconds interval, Task task);
+    void waitForCallbacks();
+    void setupIoUring();
+    void reapCompletions();
+    void handleRecvCompletion(uint64_t userData, int res, uint32_t flags);
+    void handleSendCompletion(uint64_t userData, int res);
+    // 以下需持有 _mutex
+    void applyRecvInterestLocked(int fd, RecvRegistration& reg, bool want);
+    void armRecvLocked(int fd, RecvRegistration& reg);
+    void cancelRecvLocked(int fd, const RecvRegistration& reg);
+
+    const size_t _index;
+    int _epollFd = -1;
+    int _wakeupFd = -1;
+    std::thread _thread;
+    std::atomic<bool> _running{false};
+    std::atomic<std::thread::id> _threadId{};
+
+    std::mutex _mutex;
+    std::unordered_map<int, Registration> _handlers;
+    uint32_t _generation = 0;
+    std::atomic<size_t> _fdCount{0};
+
+    std::vector<Task> _pendingTasks;
+
+    // io_uring 后端（_recvs 受 _mutex 保护；SQ 与发送链受 _ringMutex 保护，加锁顺序 _mutex -> _ringMutex）
+    std::unique_ptr<IoUring> _ring;
+    std::mutex _ringMutex;
+    std::unordered_map<int, RecvRegistration> _recvs;
+    msghdr _recvMsgTemplate{};
+    std::vector<std::unique_ptr<SendChain>> _sendChains;
+    std::vector<uint32_t> _freeSendChains;
+
+    std::set<std::pair<Clock::time_point, TimerId>> _timerQueue;
+    std::unordered_map<TimerId, Timer> _timers;
+    TimerId _nextTimerId = 1;
+};
@@ -0,0 +1,229 @@
+// framer.cpp
+#include "framer.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+// 长度前缀：帧长度 = offset + size + 字段值（大端）+ adjust
+class LengthFramer : public Framer {
+public:
+    LengthFramer(size_t maxFrameSize, size_t offset, size_t size, int64_t adjust)
+        : Framer(maxFrameSize), _offset(offset), _size(size), _adjust(adjust) {}
+
+    const char* name() const override { return "length"; }
+
+protected:
+    size_t parse(const uint8_t* data, size_t len) override {
+        const size_t header = _offset + _size;
+        if (len < header) return kNeedMore;
+
+        uint64_t value = 0;
+        for (size_t i = 0; i < _size; ++i) {
+            value = (value << 8) | data[_offset + i];
+        }
+        const int64_t total = static_cast<int64_t>(header) + static_cast<int64_t>(value) + _adjust;
+        if (total < static_cast<int64_t>(header) || static_cast<uint64_t>(total) > _maxFrameSize) {
+            return kInvalid;
+        }
+        return len < static_cast<size_t>(total) ? kNeedMore : static_cast<size_t>(total);
+    }
+
+private:
+    const size_t _offset;
+    const size_t _size;
+    const int64_t _adjust;
+};
+
+// 分隔符结尾（分隔符包含在帧内）
+class DelimiterFramer : public Framer {
+public:
+    DelimiterFramer(size_t maxFrameSize, std::string delimiter)
+        : Framer(maxFrameSize), _delimiter(std::move(delimiter)) {}
+
+    const char* name() const override { return "delimiter"; }
+
+protected:
+    size_t parse(const uint8_t* data, size_t len) override {
+        // 从上次搜索结束的位置继续（回退分隔符长度 - 1，分隔符可能跨两次到达的数据）
+        const size_t from = _searched >= _delimiter.size() ? _searched - (_delimiter.size() - 1) : 0;
+        const uint8_t* begin = data + std::min(from, len);
+        const uint8_t* end = data + len;
+        const uint8_t* found = std::search(begin, end, _delimiter.begin(), _delimiter.end(),
+                                           [](uint8_t a, char b) { return a == static_cast<uint8_t>(b); });
+        if (found == end) {
+            _searched = len;
+            return kNeedMore;
+        }
+        return static_cast<size_t>(found - data) + _delimiter.size();
+    }
+
+    void restart() override { _searched = 0; }
+
+private:
+    const std::string _delimiter;
+    size_t _searched = 0; // 队首帧中已搜索过的字节数
+};
+
+// 定长
+class FixedFramer : public Framer {
+public:
+    FixedFramer(size_t maxFrameSize, size_t size) : Framer(maxFrameSize), _size(size) {}
+
+    const char* name() const override { return "fixed"; }
+
+protected:
+    size_t parse(const uint8_t*, size_t len) override {
+        return len < _size ? kNeedMore : _size;
+    }
+
+private:
+    const size_t _size;
+};
+
+// 字符间隔：数据缓存到帧间隔内没有新数据为止；连续数据达到帧长度上限时按上限切分
+class GapFramer : public Framer {
+public:
+    GapFramer(size_t maxFrameSize, std::chrono::microseconds gap) : Framer(maxFrameSize), _gap(gap) {}
+
+    const char* name() const override { return "gap"; }
+
+    void feed(const uint8_t* data, size_t len, Clock::time_point now) override {
+        // 与上次数据之间已超过帧间隔（定时器尚未触发），先输出上一帧
+        flushIdle(now);
+        _lastByte = now;
+        while (len > 0) {
+            const size_t part = std::min(len, _maxFrameSize - _pending.size());
+            _pending.insert(_pending.end(), data, data + part);
+            data += part;
+            len -= part;
+            if (_pending.size() == _maxFrameSize) {
+                emit(_pending.data(), _pending.size());
+                _pending.clear();
+            }
+        }
+    }
+
+    void flushIdle(Clock::time_point now) override {
+        if (_pending.empty() || now - _lastByte < _gap) return;
+        emit(_pending.data(), _pending.size());
+        _pending.clear();
+    }
+
+    Clock::time_point deadline() const override {
+        return _pending.empty() ? Clock::time_point::max() : _lastByte + _gap;
+    }
+
+protected:
+    size_t parse(const uint8_t*, size_t) override { return kNeedMore; }
+
+private:
+    const std::chrono::microseconds _gap;
+    Clock::time_point _lastByte{};
+};
+
+// Modbus RTU 的 t3.5：3.5 个字符时间（每字符 10 位），19200 以上（及非串口端点）固定 1750us
+std::chrono::microseconds defaultGap(uint32_t baudRate) {
+    if (baudRate == 0 || baudRate > 19200) return std::chrono::microseconds(1750);
+    return std::chrono::microseconds(35000000 / baudRate);
+}
+
+} // namespace
+
+std::unique_ptr<Framer> Framer::create(const EndpointConfig& config) {
+    const std::string& type = config.framing;
+    if (type.empty() || type == "none") return nullptr;
+
+    const size_t maxFrameSize = config.max_frame_size > 0 ? config.max_frame_size : kDefaultMaxFrameSize;
+    if (type == "length") {
+        const size_t size = config.frame_length_size > 0 ? config.frame_length_size : 2;
+        if (size != 1 && size != 2 && size != 4) {
+            throw std::invalid_argument("frame_length_size must be 1, 2 or 4");
+        }
+        return std::unique_ptr<Framer>(new LengthFramer(maxFrameSize, config.frame_length_offset, size,
+                                                        config.frame_length_adjust));
+    }
+    if (type == "delimiter") {
+        if (config.frame_delimiter.empty()) throw std::invalid_argument("frame_delimiter is empty");
+        return std::unique_ptr<Framer>(new DelimiterFramer(maxFrameSize, config.frame_delimiter));
+    }
+    if (type == "fixed") {
+        if (config.frame_size == 0 || config.frame_size > maxFrameSize) {
+            throw std::invalid_argument("frame_size must be between 1 and max_frame_size");
+        }
+        return std::unique_ptr<Framer>(new FixedFramer(maxFrameSize, config.frame_size));
+    }
+    if (type == "gap") {
+        const auto gap = config.frame_gap_us > 0 ? std::chrono::microseconds(config.frame_gap_us)
+                                                 : defaultGap(config.baud_rate);
+        return std::unique_ptr<Framer>(new GapFramer(maxFrameSize, gap));
+    }
+    throw std::invalid_argument("Unknown framing: " + type);
+}
+
+void Framer::feed(const uint8_t* data, size_t len, Clock::time_point) {
+    if (_pending.empty()) {
+        // 常见情况：直接在输入数据上解析，完整的帧不经过缓存
+        const size_t used = consume(data, len);
+        _pending.assign(data + used, data + len);
+    } else {
+        _pending.insert(_pending.end(), data, data + len);
+        const size_t used = consume(_pending.data(), _pending.size());
+        _pending.erase(_pending.begin(), _pending.begin() + used);
+    }
+
+    // 剩余数据不构成完整的帧，达到上限后已不可能在上限内成帧（只有分隔符分帧会出现）：
+    // 丢弃已缓存的部分，该帧之后到达的部分在帧结束时一并丢弃，不作为完整的帧输出
+    if (_pending.size() >= _maxFrameSize) {
+        discard("frame exceeds max_frame_size", _pending.size());
+        _pending.clear();
+        restart();
+        _oversized = true;
+    }
+}
+
+size_t Framer::consume(const uint8_t* data, size_t len) {
+    size_t offset = 0;
+    size_t skipped = 0;
+    while (offset < len) {
+        const size_t frame = parse(data + offset, len - offset);
+        if (frame == kNeedMore) break;
+        restart();
+        if (frame == kInvalid) {
+            ++skipped;
+            ++offset;
+            continue;
+        }
+        if (skipped > 0) {
+            discard("invalid frame header", skipped);
+            skipped = 0;
+        }
+        if (_oversized || frame > _maxFrameSize) {
+            // 帧边界已知（分隔符在上限之后）：整帧一次丢弃，从下一帧开始解析
+            discard("frame exceeds max_frame_size", frame);
+            _oversized = false;
+        } else {
+            emit(data + offset, frame);
+        }
+        offset += frame;
+    }
+    if (skipped > 0) discard("invalid frame header", skipped);
+    return offset;
+}
+
+void Framer::reset() {
+    if (!_pending.empty()) discard("incomplete frame", _pending.size());
+    _pending.clear();
+    _oversized = false;
+    restart();
+}
+
+void Framer::emit(const uint8_t* data, size_t len) {
+    if (_onFrame) _onFrame(data, len);
+}
+
+void Framer::discard(const char* reason, size_t len) {
+    if (_onDiscard) _onDiscard(reason, len);
+}
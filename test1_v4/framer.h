@@ -0,0 +1,73 @@
+// framer.h
+#pragma once
+#include "shared_structs.h"
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// 报文分帧：把源端点收到的字节流切分为完整的帧，转发时每帧一次写入目标（UDP 目标每帧一个数据报）
+// 分帧方式由源端点配置的 framing 决定：
+//  - "length"：长度前缀，帧长度 = 字段偏移 + 字段字节数 + 字段值（大端）+ 调整值
+//  - "delimiter"：以分隔符结尾（分隔符包含在帧内）
+//  - "fixed"：定长
+//  - "gap"：字符间隔，超过帧间隔没有新数据即为一帧结束（如 Modbus RTU 的 t3.5）
+// 由源端点的数据回调线程（事件循环线程）调用，非线程安全
+class Framer {
+public:
+    using Clock = std::chrono::steady_clock;
+    // 完整帧回调：data 只在回调期间有效
+    using FrameCallback = std::function<void(const uint8_t* data, size_t len)>;
+    // 丢弃回调：无法成帧的数据（长度字段非法、超过帧长度上限、端点替换时未完成的帧）
+    using DiscardCallback = std::function<void(const char* reason, size_t len)>;
+
+    static constexpr size_t kDefaultMaxFrameSize = 64 * 1024;
+
+    // 按端点配置创建分帧器：未配置分帧时返回 nullptr，配置非法时抛出 std::invalid_argument
+    static std::unique_ptr<Framer> create(const EndpointConfig& config);
+
+    virtual ~Framer() = default;
+    Framer(const Framer&) = delete;
+    Framer& operator=(const Framer&) = delete;
+
+    void setFrameCallback(FrameCallback cb) { _onFrame = std::move(cb); }
+    void setDiscardCallback(DiscardCallback cb) { _onDiscard = std::move(cb); }
+
+    // 输入一段字节流，已完整的帧依次交给帧回调（now 为数据到达时间）
+    virtual void feed(const uint8_t* data, size_t len, Clock::time_point now);
+    // 字符间隔分帧：距最后一个字节超过帧间隔时输出缓存的帧
+    virtual void flushIdle(Clock::time_point now) { (void)now; }
+    // 缓存的帧需要由 flushIdle 输出的时间（没有时为 time_point::max()）
+    virtual Clock::time_point deadline() const { return Clock::time_point::max(); }
+    // 丢弃未完成的帧
+    void reset();
+
+    virtual const char* name() const = 0;
+
+protected:
+    // parse 的特殊返回值
+    static constexpr size_t kNeedMore = 0;
+    static constexpr size_t kInvalid = static_cast<size_t>(-1);
+
+    explicit Framer(size_t maxFrameSize) : _maxFrameSize(maxFrameSize) {}
+
+    // 从 data 开头解析一帧：返回帧长度（超过上限时整帧丢弃）；数据不足返回 kNeedMore；
+    // 无法解析返回 kInvalid（跳过 1 字节重新同步）
+    // 同一帧的数据分多次到达时，以从帧开头起更长的 data 重新调用
+    virtual size_t parse(const uint8_t* data, size_t len) = 0;
+    // 队首帧变化（输出或丢弃）后调用，清除解析的中间状态
+    virtual void restart() {}
+
+    // 解析 data 中的完整帧并输出，返回已处理（输出或丢弃）的字节数
+    size_t consume(const uint8_t* data, size_t len);
+    void emit(const uint8_t* data, size_t len);
+    void discard(const char* reason, size_t len);
+
+    const size_t _maxFrameSize;
+    std::vector<uint8_t> _pending; // 未完成的帧（容量在运行中复用，不随每帧分配）
+    bool _oversized = false;       // 队首帧超过上限，开头部分已丢弃：其余部分到帧结束为止一并丢弃
+    FrameCallback _onFrame;
+    DiscardCallback _onDiscard;
+};
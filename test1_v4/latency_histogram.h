@@ -0,0 +1,161 @@
+// latency_histogram.h
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+// 延迟分位数摘要（纳秒）
+struct LatencySummary {
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    uint64_t p50 = 0;
+    uint64_t p99 = 0;
+    uint64_t p999 = 0;
+    uint64_t max = 0;
+};
+
+// 对数分桶直方图（HDR 风格）：每个 2 的幂区间分 8 个子桶，相对误差不超过 12.5%，
+// 覆盖 0 ~ 2^40 ns（约 18 分钟，超出部分计入最后一个桶）
+// 单写入者（同一方向的转发任务同一时刻只有一个），读取方可在任意线程汇总
+class LatencyHistogram {
+public:
+    static constexpr int kSubBits = 3;
+    static constexpr uint64_t kSubBuckets = 1u << kSubBits;
+    static constexpr int kMaxMagnitude = 39;
+    static constexpr size_t kBuckets = (kMaxMagnitude - kSubBits + 2) * kSubBuckets;
+
+    void record(uint64_t ns) {
+        increment(buckets_[bucketIndex(ns)], 1);
+        increment(sum_, ns);
+        if (ns > max_.load(std::memory_order_relaxed)) {
+            max_.store(ns, std::memory_order_relaxed);
+        }
+    }
+
+    LatencySummary summary() const {
+        std::array<uint64_t, kBuckets> counts;
+        uint64_t total = 0;
+        for (size_t i = 0; i < kBuckets; ++i) {
+            counts[i] = buckets_[i].load(std::memory_order_relaxed);
+            total += counts[i];
+        }
+
+        LatencySummary result;
+        result.count = total;
+        result.sum = sum_.load(std::memory_order_relaxed);
+        result.max = max_.load(std::memory_order_relaxed);
+        if (total == 0) return result;
+
+        // 分位数取所在桶的上界（不超过最大值）
+        const uint64_t ranks[3] = {(total * 500 + 999) / 1000, (total * 990 + 999) / 1000,
+                                   (total * 999 + 999) / 1000};
+        uint64_t* outputs[3] = {&result.p50, &result.p99, &result.p999};
+        uint64_t seen = 0;
+        int next = 0;
+        for (size_t i = 0; i < kBuckets && next < 3; ++i) {
+            seen += counts[i];
+            while (next < 3 && seen >= std::max<uint64_t>(ranks[next], 1)) {
+                *outputs[next++] = std::min(bucketUpperBound(i), result.max);
+            }
+        }
+        return result;
+    }
+
+    static size_t bucketIndex(uint64_t ns) {
+        if (ns < kSubBuckets) return static_cast<size_t>(ns);
+        int magnitude = 63 - __builtin_clzll(ns);
+        if (magnitude > kMaxMagnitude) return kBuckets - 1;
+        const uint64_t sub = (ns >> (magnitude - kSubBits)) & (kSubBuckets - 1);
+        return static_cast<size_t>((magnitude - kSubBits + 1) * kSubBuckets + sub);
+    }
+
+    static uint64_t bucketUpperBound(size_t index) {
+        if (index < kSubBuckets) return index;
+        const int magnitude = static_cast<int>(index / kSubBuckets) + kSubBits - 1;
+        const uint64_t sub = index % kSubBuckets;
+        const int shift = magnitude - kSubBits;
+        return ((kSubBuckets + sub + 1) << shift) - 1;
+    }
+
+private:
+    // 单写入者：relaxed 读-改-写即可，不需要原子加
+    static void increment(std::atomic<uint64_t>& counter, uint64_t value) {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    std::array<std::atomic<uint64_t>, kBuckets> buckets_{};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+};
+
+// 字节流的接收 -> 写出延迟跟踪（SPSC，与 RingBuffer 的生产者 / 消费者相同）
+// - 生产者每次写入缓冲区后记录 (累计写入字节数, 接收时间)
+// - 消费者确认目标已接收的字节后，结束位置已被覆盖的记录即完成一次采样
+// 记录队列满时跳过该次接收（只少采样，不影响后续记录的对应关系）；
+// 生产者在写入缓冲区之后才登记，若消费者在登记前已写出这些字节，该记录作废而不是计入偏大的延迟
+class LatencyTracker {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // 生产者：len 字节已进入缓冲区
+    void received(size_t len, Clock::time_point when) {
+        pushed_ += len;
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) >= kCapacity) return;
+        entries_[tail & (kCapacity - 1)] = Entry{pushed_, when};
+        tail_.store(tail + 1, std::memory_order_release);
+    }
+
+    // 消费者：目标已接收 len 字节，完成的记录计入直方图
+    void written(size_t len, Clock::time_point when, LatencyHistogram& histogram) {
+        const uint64_t previous = consumed_;
+        consumed_ += len;
+        size_t head = head_.load(std::memory_order_relaxed);
+        const size_t tail = tail_.load(std::memory_order_acquire);
+        while (head != tail) {
+            const Entry& entry = entries_[head & (kCapacity - 1)];
+            if (entry.end > consumed_) break;
+            // 结束位置在本次写出之前：登记晚于写出，接收时间已无法对应
+            if (entry.end > previous) {
+                histogram.record(static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(when - entry.received).count()));
+            }
+            ++head;
+        }
+        head_.store(head, std::memory_order_release);
+    }
+
+    // 消费者：len 字节被丢弃（不计入延迟）
+    void discarded(size_t len) {
+        consumed_ += len;
+        size_t head = head_.load(std::memory_order_relaxed);
+        const size_t tail = tail_.load(std::memory_order_acquire);
+        while (head != tail && entries_[head & (kCapacity - 1)].end <= consumed_) {
+            ++head;
+        }
+        head_.store(head, std::memory_order_release);
+    }
+
+    // 缓冲区被整体清空时调用（生产者与消费者均已停止）：丢弃全部未完成的记录
+    void clear() {
+        consumed_ = pushed_;
+        head_.store(tail_.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+private:
+    static constexpr size_t kCapacity = 256; // 2 的幂；积压超过此数量的接收时只少采样
+
+    struct Entry {
+        uint64_t end; // 本次接收之后的累计字节数
+        Clock::time_point received;
+    };
+
+    std::array<Entry, kCapacity> entries_{};
+    uint64_t pushed_ = 0;   // 仅生产者访问
+    uint64_t consumed_ = 0; // 仅消费者访问
+    alignas(64) std::atomic<size_t> head_{0};
+    alignas(64) std::atomic<size_t> tail_{0};
+};
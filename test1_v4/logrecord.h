@@ -2,20 +2,30 @@
 #ifndef LOGRECORD_H
 #define LOGRECORD_H
 
-#include <fstream>
 #include <mutex>
+#include <condition_variable>
+#include <thread>
 #include <string>
 #include <ctime>
-#include <iomanip>
-#include <sstream>
+#include <chrono>
 #include <atomic>
 #include <iostream>
 #include <map>
 #include <vector>
 #include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <cerrno>
 #include <filesystem>
 #include <memory>
 #include <system_error>
+#include <fcntl.h>
+#include <unistd.h>
+#include <limits.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
 
 namespace fs = std::filesystem;
 
@@ -23,11 +33,62 @@ enum class LogLevel {
     DEBUG,
     INFO,
     WARNING,
-    ERROR
+    ERROR,
+    OFF     // 仅用于级别过滤：关闭全部日志
 };
 
+// 编译期日志级别下限（0=DEBUG 1=INFO 2=WARNING 3=ERROR 4=OFF），由 Makefile 的 LOG_MIN_LEVEL 传入；
+// 低于此级别的日志宏条件为常量 false，整段调用（含参数求值）被编译器消除
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL 0
+#endif
+
+// 解析级别名称（"debug" / "info" / "warning" / "error" / "off"），无法识别时返回 false
+inline bool parseLogLevel(const std::string& name, LogLevel& level) {
+    if (name == "debug") {
+        level = LogLevel::DEBUG;
+    } else if (name == "info") {
+        level = LogLevel::INFO;
+    } else if (name == "warning") {
+        level = LogLevel::WARNING;
+    } else if (name == "error") {
+        level = LogLevel::ERROR;
+    } else if (name == "off") {
+        level = LogLevel::OFF;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// 通道日志句柄：通道名称 + 运行时日志级别
+// 通道日志宏展开处先以 relaxed 原子读取比较级别，未启用时不格式化、不求值参数
+class LogChannel {
+public:
+    explicit LogChannel(const std::string& name, LogLevel level = LogLevel::DEBUG)
+        : _name(name), _level(level) {}
+
+    const std::string& name() const { return _name; }
+    LogLevel level() const { return _level.load(std::memory_order_relaxed); }
+    void setLevel(LogLevel level) { _level.store(level, std::memory_order_relaxed); }
+    bool enabled(LogLevel level) const { return level >= _level.load(std::memory_order_relaxed); }
+
+private:
+    const std::string _name;
+    std::atomic<LogLevel> _level;
+};
+
+// 异步日志：调用线程只负责格式化，整行放入无锁 MPSC 队列后立即返回，不接触文件系统；
+// 后台线程批量取出，按目标（控制台 / 各通道日志文件）聚合后一次 writev 写出
 class LogRecord {
 public:
+    // 队列满时的处理策略
+    enum class OverflowPolicy {
+        Block, // 等待后台线程腾出空间（不丢日志）
+        Drop,  // 直接丢弃
+        Count  // 丢弃并计数，由后台线程定期输出丢弃数量
+    };
+
     // 获取日志单例实例
     static LogRecord& getInstance() {
         static LogRecord instance;
@@ -39,6 +100,49 @@ public:
         getInstance()._init(consoleLog, fileLog, logDir);
     }
 
+    // 全局运行时日志级别：作用于 LOG_* 以及按名称（而非 LogChannel）记录的通道日志
+    static void setLevel(LogLevel level) {
+        getInstance()._level.store(level, std::memory_order_relaxed);
+    }
+
+    static bool enabled(LogLevel level) {
+        return level >= getInstance()._level.load(std::memory_order_relaxed);
+    }
+
+    // 通道日志级别判断与名称（供日志宏使用，通道可以是 LogChannel 或名称字符串）
+    static bool channelEnabled(const LogChannel& channel, LogLevel level) { return channel.enabled(level); }
+    static bool channelEnabled(const std::string&, LogLevel level) { return enabled(level); }
+    static const std::string& channelName(const LogChannel& channel) { return channel.name(); }
+    static const std::string& channelName(const std::string& channel) { return channel; }
+
+    static void setOverflowPolicy(OverflowPolicy policy) {
+        getInstance()._policy.store(policy, std::memory_order_relaxed);
+    }
+
+    // 解析策略名称（"block" / "drop" / "count"），无法识别时返回 false
+    static bool parseOverflowPolicy(const std::string& name, OverflowPolicy& policy) {
+        if (name == "block") {
+            policy = OverflowPolicy::Block;
+        } else if (name == "drop") {
+            policy = OverflowPolicy::Drop;
+        } else if (name == "count") {
+            policy = OverflowPolicy::Count;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    // 因队列满被丢弃的日志条数（累计）
+    static uint64_t droppedCount() {
+        return getInstance()._droppedTotal.load(std::memory_order_relaxed);
+    }
+
+    // 等待此前提交的日志全部写出
+    static void flush() {
+        getInstance()._flush();
+    }
+
     // 添加格式化日志
     static void addLog(LogLevel level, const char* format, ...) {
         va_list args;
@@ -66,32 +170,94 @@ public:
     }
 
 private:
+    static constexpr size_t kQueueCapacity = 64 * 1024; // 2 的幂
+    static constexpr size_t kBatchSize = 512;           // 后台线程每批最多处理的条数
+    static constexpr int kSpinRounds = 64;              // 队列为空时休眠前的自旋轮数
+    static constexpr auto kIdleWait = std::chrono::milliseconds(500);
+    static constexpr auto kReopenCheckInterval = std::chrono::seconds(1);
+
+    // 输出目标
+    static constexpr uint8_t kStdout = 1;
+    static constexpr uint8_t kStderr = 2;
+    static constexpr uint8_t kFile = 4;
+
+    // 预格式化的日志条目（line 以换行结尾）
+    struct Record {
+        std::string channel; // 文件日志所属通道
+        std::string line;
+        uint8_t targets = 0;
+    };
+
+    struct Cell {
+        std::atomic<size_t> seq;
+        Record record;
+    };
+
     struct ChannelLog {
-        std::ofstream file;
+        int fd = -1;
         std::string filename;
         bool needsReopen = false;  // 标记是否需要重新打开文件
+        std::vector<struct iovec> pending; // 本批待写出的行
     };
 
-    bool _consoleLog = true;
-    bool _fileLog = false;
+    // 以下成员由 _mutex 保护（配置）或只在后台线程访问（文件）
+    std::atomic<bool> _consoleLog{true};
+    std::atomic<bool> _fileLog{false};
+    std::atomic<OverflowPolicy> _policy{OverflowPolicy::Block};
+    std::atomic<LogLevel> _level{LogLevel::DEBUG};
     fs::path _logDir;
     std::mutex _mutex;
     std::map<std::string, ChannelLog> _channelLogs;
-    
+
+    // MPSC 队列：生产者 CAS 抢占 _tail，后台线程独占 _head
+    std::vector<Cell> _cells;
+    const size_t _mask;
+    alignas(64) std::atomic<size_t> _tail{0};
+    alignas(64) std::atomic<size_t> _head{0};
+    std::atomic<size_t> _written{0};         // 已写出的条目位置（用于 flush）
+    std::atomic<uint64_t> _dropped{0};       // 尚未报告的丢弃数（Count 策略）
+    std::atomic<uint64_t> _droppedTotal{0};
+
+    // 后台线程休眠 / 唤醒
+    std::atomic<bool> _consumerSleeping{false};
+    std::atomic<bool> _stopping{false};
+    std::mutex _wakeMutex;
+    std::condition_variable _wakeCv;
+    std::condition_variable _flushCv;
+    std::thread _worker;
+
     // 私有构造函数（单例模式）
-    LogRecord() = default;
-    
+    LogRecord() : _cells(kQueueCapacity), _mask(kQueueCapacity - 1) {
+        for (size_t i = 0; i < kQueueCapacity; ++i) {
+            _cells[i].seq.store(i, std::memory_order_relaxed);
+        }
+        _worker = std::thread([this] { _run(); });
+    }
+
+    // 退出时写出队列中剩余的日志
+    ~LogRecord() {
+        {
+            std::lock_guard<std::mutex> lock(_wakeMutex);
+            _stopping.store(true, std::memory_order_release);
+        }
+        _wakeCv.notify_one();
+        if (_worker.joinable()) _worker.join();
+        for (auto& entry : _channelLogs) {
+            if (entry.second.fd >= 0) ::close(entry.second.fd);
+        }
+    }
+
     // 禁用拷贝和赋值
     LogRecord(const LogRecord&) = delete;
     LogRecord& operator=(const LogRecord&) = delete;
-    
+
     void _init(bool consoleLog, bool fileLog, const std::string& logDir) {
         std::lock_guard<std::mutex> lock(_mutex);
-        
+
         _consoleLog = consoleLog;
         _fileLog = fileLog;
         _logDir = fs::path(logDir);
-        
+
         if (_fileLog) {
             _ensureLogDirectory();
         }
@@ -111,252 +277,465 @@ private:
         }
     }
 
+    // ---------------- 生产者（调用线程） ----------------
+
     void _addLog(const std::string& channel, LogLevel level, const char* format, va_list args) {
-        char buffer[1024];
-        vsnprintf(buffer, sizeof(buffer), format, args);
-        
-        const auto logLine = _formatLogLine(channel, level, buffer);
-        
-        std::lock_guard<std::mutex> lock(_mutex);
-        
-        // 输出到控制台
-        if (_consoleLog) {
-            if (level >= LogLevel::WARNING) {
-                std::cerr << logLine << std::endl;
-            } else {
-                std::cout << logLine << std::endl;
-            }
+        const bool console = _consoleLog.load(std::memory_order_relaxed);
+        const bool file = _fileLog.load(std::memory_order_relaxed);
+        if (!console && !file) return;
+
+        Record record;
+        _vformatLogLine(record.line, channel, level, format, args);
+        if (console) {
+            record.targets |= level >= LogLevel::WARNING ? kStderr : kStdout;
         }
-        
-        // 输出到文件
-        if (_fileLog) {
-            // 确保日志目录存在
-            _ensureLogDirectory();
-            
-            std::string targetChannel = channel.empty() ? "main" : channel;
-            
-            try {
-                auto& clog = _getChannelLog(targetChannel);
-                
-                // 检查文件状态并尝试重新打开
-                if (clog.needsReopen || !clog.file.is_open()) {
-                    _reopenChannelLog(clog);
-                }
-                
-                if (clog.file.is_open()) {
-                    clog.file << logLine << std::endl;
-                    clog.file.flush();  // 确保立即写入
+        if (file) {
+            record.targets |= kFile;
+            record.channel = channel.empty() ? "main" : channel;
+        }
+        _submit(record);
+    }
+
+    void _logBinary(const std::string& channel, const std::string& prefix, const uint8_t* data, size_t len) {
+        if (!_fileLog.load(std::memory_order_relaxed)) return;
+
+        static const char kHex[] = "0123456789abcdef";
+        Record record;
+        std::string& line = record.line;
+        line.reserve(prefix.size() + len * 3 + 48);
+
+        // 时间戳 + 前缀 + 字节数 + 十六进制字节
+        _appendTime(line);
+        line += ' ';
+        line += prefix;
+        line += std::to_string(len);
+        line += " bytes: ";
+        for (size_t i = 0; i < len; i++) {
+            line += kHex[data[i] >> 4];
+            line += kHex[data[i] & 0x0F];
+            if (i < len - 1) line += ' ';
+        }
+        line += '\n';
+
+        record.channel = channel;
+        record.targets = kFile;
+        _submit(record);
+    }
+
+    // 二进制转文本日志函数
+    void _logBinaryAsText(const std::string& channel, const std::string& prefix, const uint8_t* data, size_t len) {
+        if (!_fileLog.load(std::memory_order_relaxed)) return;
+
+        std::string text;
+        text.reserve(prefix.size() + len + 24);
+        text += prefix;
+        text += ' ';
+        text += std::to_string(len);
+        text += " bytes: ";
+        // 直接写入UTF-8字节序列（与按 C 字符串格式化一致，遇到 NUL 截断）
+        const void* nul = memchr(data, 0, len);
+        const size_t textLen = nul ? static_cast<const uint8_t*>(nul) - data : len;
+        text.append(reinterpret_cast<const char*>(data), textLen);
+
+        Record record;
+        _formatLogLine(record.line, channel, LogLevel::INFO, text.data(), text.size());
+        record.channel = channel;
+        record.targets = kFile;
+        _submit(record);
+    }
+
+    void _submit(Record& record) {
+        while (!_tryPush(record)) {
+            const OverflowPolicy policy = _policy.load(std::memory_order_relaxed);
+            if (policy != OverflowPolicy::Block) {
+                if (policy == OverflowPolicy::Count) {
+                    _dropped.fetch_add(1, std::memory_order_relaxed);
                 }
-            } catch (const std::exception& e) {
-                std::cerr << "Error writing log: " << e.what() << std::endl;
+                _droppedTotal.fetch_add(1, std::memory_order_relaxed);
+                return;
             }
+            _wakeConsumer();
+            std::this_thread::yield();
+        }
+
+        // 与 _waitForRecords 配对：后台线程只有在宣告休眠之后才需要唤醒，正常情况下不产生系统调用
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (_consumerSleeping.load(std::memory_order_relaxed)) {
+            _wakeConsumer();
         }
     }
 
-    // 重新打开通道日志文件
-    void _reopenChannelLog(ChannelLog& clog) {
-        try {
-            // 关闭现有文件（如果打开）
-            if (clog.file.is_open()) {
-                clog.file.close();
-            }
-            
-            // 尝试重新打开文件
-            clog.file.open(clog.filename, std::ios::out | std::ios::app | std::ios::binary);
-            
-            if (clog.file.is_open()) {
-                // 检查文件是否为空（新创建的文件）
-                clog.file.seekp(0, std::ios::end);
-                if (clog.file.tellp() == 0) {
-                    // 写入UTF-8 BOM标记
-                    const unsigned char bom[] = {0xEF, 0xBB, 0xBF};
-                    clog.file.write(reinterpret_cast<const char*>(bom), sizeof(bom));
+    bool _tryPush(Record& record) {
+        size_t pos = _tail.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = _cells[pos & _mask];
+            const size_t seq = cell.seq.load(std::memory_order_acquire);
+            const intptr_t dif = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (dif == 0) {
+                if (_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.record = std::move(record);
+                    cell.seq.store(pos + 1, std::memory_order_release);
+                    return true;
                 }
-                clog.needsReopen = false;
-                // 直接使用标准输出，避免依赖日志宏
-                std::cout << "Reopened log file: " << clog.filename << std::endl;
+            } else if (dif < 0) {
+                return false; // 队列已满
             } else {
-                std::cerr << "ERROR: Failed to reopen log file: " << clog.filename << std::endl;
-                clog.needsReopen = true;
+                pos = _tail.load(std::memory_order_relaxed);
             }
-        } catch (const std::exception& e) {
-            std::cerr << "Error reopening log file: " << e.what() << std::endl;
-            clog.needsReopen = true;
         }
     }
 
-    void _logBinary(const std::string& channel, const std::string& prefix, const uint8_t* data, size_t len) {
-        std::lock_guard<std::mutex> lock(_mutex);
-        
-        if (!_fileLog) return;
-        
-        // 确保日志目录存在
-        _ensureLogDirectory();
-        
-        try {
-            auto& clog = _getChannelLog(channel);
-            
-            // 检查文件状态并尝试重新打开
-            if (clog.needsReopen || !clog.file.is_open()) {
-                _reopenChannelLog(clog);
+    void _wakeConsumer() {
+        {
+            std::lock_guard<std::mutex> lock(_wakeMutex);
+        }
+        _wakeCv.notify_one();
+    }
+
+    void _flush() {
+        const size_t target = _tail.load(std::memory_order_acquire);
+        _wakeConsumer();
+        std::unique_lock<std::mutex> lock(_wakeMutex);
+        _flushCv.wait(lock, [&] {
+            return _written.load(std::memory_order_acquire) >= target ||
+                   _stopping.load(std::memory_order_relaxed);
+        });
+    }
+
+    // ---------------- 后台线程 ----------------
+
+    bool _tryPop(Record& record) {
+        const size_t pos = _head.load(std::memory_order_relaxed);
+        Cell& cell = _cells[pos & _mask];
+        if (cell.seq.load(std::memory_order_acquire) != pos + 1) {
+            return false; // 队列为空（或生产者尚未写完该槽位）
+        }
+        record = std::move(cell.record);
+        cell.record.line.clear();
+        cell.seq.store(pos + _mask + 1, std::memory_order_release);
+        _head.store(pos + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool _queueEmpty() const {
+        const size_t pos = _head.load(std::memory_order_relaxed);
+        return _cells[pos & _mask].seq.load(std::memory_order_acquire) != pos + 1;
+    }
+
+    void _run() {
+        std::vector<Record> batch(kBatchSize);
+        auto nextReopenCheck = std::chrono::steady_clock::now() + kReopenCheckInterval;
+        int idleRounds = 0;
+
+        while (true) {
+            size_t count = 0;
+            while (count < kBatchSize && _tryPop(batch[count])) {
+                ++count;
+            }
+
+            if (count > 0) {
+                _writeBatch(batch.data(), count);
+                idleRounds = 0;
+            }
+            _reportDropped();
+
+            if (count > 0 || _written.load(std::memory_order_relaxed) != _head.load(std::memory_order_relaxed)) {
+                {
+                    std::lock_guard<std::mutex> lock(_wakeMutex);
+                    _written.store(_head.load(std::memory_order_relaxed), std::memory_order_release);
+                }
+                _flushCv.notify_all();
+            }
+
+            const auto now = std::chrono::steady_clock::now();
+            if (now >= nextReopenCheck) {
+                _checkLogFiles();
+                nextReopenCheck = now + kReopenCheckInterval;
             }
-            
-            if (!clog.file.is_open()) return;
-            
-            // 写入时间戳
-            clog.file << _currentTimeStr() << " " << prefix;
-            
-            // 写入字节数
-            clog.file << std::to_string(len) << " bytes: ";
-            
-            // 写入十六进制字节
-            for (size_t i = 0; i < len; i++) {
-                clog.file << std::hex << std::setw(2) << std::setfill('0')
-                         << static_cast<int>(data[i]);
-                if (i < len - 1) clog.file << " ";
+
+            if (count == kBatchSize) continue;
+            if (_stopping.load(std::memory_order_acquire) && _queueEmpty()) break;
+
+            if (++idleRounds < kSpinRounds) {
+                std::this_thread::yield();
+                continue;
             }
-            clog.file << '\n';
-            clog.file.flush();  // 确保立即写入
-        } catch (const std::exception& e) {
-            std::cerr << "Error writing binary log: " << e.what() << std::endl;
+            idleRounds = 0;
+            _waitForRecords();
         }
     }
 
-    // 二进制转文本日志函数
-void _logBinaryAsText(const std::string& channel, const std::string& prefix, const uint8_t* data, size_t len) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    
-    if (!_fileLog) return;  
-    
-    try {
-        std::ostringstream oss;
-        oss << prefix << " " <<  std::to_string(len) << " bytes: ";
-        std::string text = oss.str(); // 获取基础字符串
-        
-        // 直接写入UTF-8字节序列
-        text.append(reinterpret_cast<const char*>(data), len);
-        
-        // 构建完整日志消息
-        const auto logLine = _formatLogLine(channel, LogLevel::INFO, text.c_str());
-        
-        // 输出到文件
-        if (_fileLog) {
-            _ensureLogDirectory();
-            try {
-                auto& clog = _getChannelLog(channel);
-                if (clog.needsReopen || !clog.file.is_open()) {
-                    _reopenChannelLog(clog);
+    void _waitForRecords() {
+        _consumerSleeping.store(true, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        {
+            std::unique_lock<std::mutex> lock(_wakeMutex);
+            _wakeCv.wait_for(lock, kIdleWait, [this] {
+                return !_queueEmpty() || _stopping.load(std::memory_order_relaxed);
+            });
+        }
+        _consumerSleeping.store(false, std::memory_order_relaxed);
+    }
+
+    // 按目标聚合后写出：控制台两路各一次 writev，每个通道文件一次 writev
+    void _writeBatch(Record* records, size_t count) {
+        std::vector<struct iovec> out;
+        std::vector<struct iovec> err;
+        std::vector<ChannelLog*> touched;
+        ChannelLog* last = nullptr;
+        const std::string* lastChannel = nullptr;
+
+        for (size_t i = 0; i < count; ++i) {
+            Record& record = records[i];
+            struct iovec iov{const_cast<char*>(record.line.data()), record.line.size()};
+            if (record.targets & kStdout) out.push_back(iov);
+            if (record.targets & kStderr) err.push_back(iov);
+            if (record.targets & kFile) {
+                if (!lastChannel || *lastChannel != record.channel) {
+                    last = &_getChannelLog(record.channel);
+                    lastChannel = &record.channel;
                 }
-                if (clog.file.is_open()) {
-                    clog.file << logLine << std::endl;
-                    clog.file.flush();
+                if (last->pending.empty()) touched.push_back(last);
+                last->pending.push_back(iov);
+            }
+        }
+
+        if (!out.empty()) _writeAll(STDOUT_FILENO, out, nullptr);
+        if (!err.empty()) _writeAll(STDERR_FILENO, err, nullptr);
+        for (ChannelLog* clog : touched) {
+            if (clog->needsReopen || clog->fd < 0) {
+                _reopenChannelLog(*clog);
+            }
+            if (clog->fd >= 0) {
+                _writeAll(clog->fd, clog->pending, clog);
+            }
+            clog->pending.clear();
+        }
+    }
+
+    // 写出全部 iovec（处理部分写入与 IOV_MAX 限制）
+    void _writeAll(int fd, std::vector<struct iovec>& iovs, ChannelLog* clog) {
+        size_t index = 0;
+        while (index < iovs.size()) {
+            const int count = static_cast<int>(std::min<size_t>(iovs.size() - index, IOV_MAX));
+            ssize_t written = ::writev(fd, &iovs[index], count);
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                if (clog) {
+                    std::cerr << "Error writing log " << clog->filename << ": " << strerror(errno) << std::endl;
+                    clog->needsReopen = true;
                 }
-            } catch (const std::exception& e) {
-                std::cerr << "Error writing binary text log: " << e.what() << std::endl;
+                return;
+            }
+            // 跳过已完整写出的部分，调整部分写入的条目
+            size_t left = static_cast<size_t>(written);
+            while (index < iovs.size() && left >= iovs[index].iov_len) {
+                left -= iovs[index].iov_len;
+                ++index;
+            }
+            if (left > 0) {
+                iovs[index].iov_base = static_cast<char*>(iovs[index].iov_base) + left;
+                iovs[index].iov_len -= left;
             }
         }
-    } catch (const std::exception& e) {
-        std::cerr << "Error in binary text log: " << e.what() << std::endl;
     }
-}
 
-    // 在 _getChannelLog 函数中添加文件创建逻辑
-ChannelLog& _getChannelLog(const std::string& channel) {
-    auto it = _channelLogs.find(channel);
-    if (it != _channelLogs.end()) {
-        return it->second;
-    }
-    
-    // 创建新的通道日志
-    ChannelLog newLog;
-    newLog.filename = (_logDir / (channel + ".txt")).string();
-    
-    try {
-        // 确保目录存在
-        _ensureLogDirectory();
-        
-        // 尝试创建并打开文件
-        newLog.file.open(newLog.filename, std::ios::out | std::ios::app | std::ios::binary);
-        
-        if (newLog.file.is_open()) {
-            // 检查文件是否为空（新创建的文件）
-            newLog.file.seekp(0, std::ios::end);
-            if (newLog.file.tellp() == 0) {
-                // 写入UTF-8 BOM标记
-                const unsigned char bom[] = {0xEF, 0xBB, 0xBF};
-                newLog.file.write(reinterpret_cast<const char*>(bom), sizeof(bom));
+    // Count 策略：输出自上次报告以来被丢弃的条数
+    void _reportDropped() {
+        const uint64_t dropped = _dropped.exchange(0, std::memory_order_relaxed);
+        if (dropped == 0) return;
+
+        char buffer[96];
+        snprintf(buffer, sizeof(buffer), "%llu log records dropped (queue full)",
+                 static_cast<unsigned long long>(dropped));
+        Record record;
+        _formatLogLine(record.line, "", LogLevel::WARNING, buffer, strlen(buffer));
+        record.channel = "main";
+        record.targets = (_consoleLog ? kStderr : 0) | (_fileLog ? kFile : 0);
+        _writeBatch(&record, 1);
+    }
+
+    // 日志文件被删除或轮转（rename）后重新打开
+    void _checkLogFiles() {
+        for (auto& entry : _channelLogs) {
+            ChannelLog& clog = entry.second;
+            if (clog.fd < 0 || clog.needsReopen) continue;
+            struct stat byPath;
+            struct stat byFd;
+            if (::stat(clog.filename.c_str(), &byPath) != 0 || ::fstat(clog.fd, &byFd) != 0 ||
+                byPath.st_ino != byFd.st_ino || byPath.st_dev != byFd.st_dev) {
+                clog.needsReopen = true;
             }
-            newLog.needsReopen = false;
+        }
+    }
+
+    // 打开日志文件，新文件写入 UTF-8 BOM 标记
+    static int _openLogFile(const std::string& filename) {
+        int fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (fd < 0) return -1;
+        struct stat st;
+        if (::fstat(fd, &st) == 0 && st.st_size == 0) {
+            const unsigned char bom[] = {0xEF, 0xBB, 0xBF};
+            ssize_t ret = ::write(fd, bom, sizeof(bom));
+            (void)ret;
+        }
+        return fd;
+    }
+
+    // 重新打开通道日志文件
+    void _reopenChannelLog(ChannelLog& clog) {
+        // 关闭现有文件（如果打开）
+        if (clog.fd >= 0) {
+            ::close(clog.fd);
+            clog.fd = -1;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _ensureLogDirectory();
+        }
+        clog.fd = _openLogFile(clog.filename);
+        if (clog.fd >= 0) {
+            clog.needsReopen = false;
+            // 直接使用标准输出，避免依赖日志宏
+            std::cout << "Reopened log file: " << clog.filename << std::endl;
         } else {
+            std::cerr << "ERROR: Failed to reopen log file: " << clog.filename << std::endl;
+            clog.needsReopen = true;
+        }
+    }
+
+    // 查找或创建通道日志（仅后台线程调用）
+    ChannelLog& _getChannelLog(const std::string& channel) {
+        auto it = _channelLogs.find(channel);
+        if (it != _channelLogs.end()) {
+            return it->second;
+        }
+
+        // 创建新的通道日志
+        ChannelLog newLog;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            newLog.filename = (_logDir / (channel + ".txt")).string();
+            _ensureLogDirectory();
+        }
+        newLog.fd = _openLogFile(newLog.filename);
+        if (newLog.fd < 0) {
             std::cerr << "WARNING: Failed to create log file: " << newLog.filename << std::endl;
             newLog.needsReopen = true;
         }
-    } catch (const std::exception& e) {
-        std::cerr << "Error creating log file: " << e.what() << std::endl;
-        newLog.needsReopen = true;
+
+        return _channelLogs.emplace(channel, std::move(newLog)).first->second;
     }
-    
-    return _channelLogs.emplace(channel, std::move(newLog)).first->second;
-}
 
-    std::string _formatLogLine(const std::string& channel, LogLevel level, const char* message) {
-        std::ostringstream oss;
-        oss << _currentTimeStr();
-        
+    // 时间、级别、通道标记
+    static void _appendLinePrefix(std::string& out, const std::string& channel, LogLevel level) {
+        _appendTime(out);
+
         // 日志级别标记
         switch (level) {
-            case LogLevel::DEBUG:    oss << " [DEBUG] "; break;
-            case LogLevel::INFO:     oss << " [INFO ] "; break;
-            case LogLevel::WARNING:  oss << " [WARN ] "; break;
-            case LogLevel::ERROR:    oss << " [ERROR] "; break;
+            case LogLevel::DEBUG:    out += " [DEBUG] "; break;
+            case LogLevel::INFO:     out += " [INFO ] "; break;
+            case LogLevel::WARNING:  out += " [WARN ] "; break;
+            case LogLevel::ERROR:    out += " [ERROR] "; break;
+            case LogLevel::OFF:      out += " "; break;
         }
-        
+
         // 通道标记（如果有）
         if (!channel.empty()) {
-            oss << "[" << channel << "] ";
+            out += '[';
+            out += channel;
+            out += "] ";
         }
-        
-        oss << message;
-        return oss.str();
     }
 
-    // 获取当前时间字符串
-    std::string _currentTimeStr() {
+    static void _formatLogLine(std::string& out, const std::string& channel, LogLevel level,
+                               const char* message, size_t len) {
+        out.reserve(32 + channel.size() + len);
+        _appendLinePrefix(out, channel, level);
+        out.append(message, len);
+        out += '\n';
+    }
+
+    // 直接格式化到行缓冲区（不经中间缓冲区，消息超过 1KB 时截断）
+    static void _vformatLogLine(std::string& out, const std::string& channel, LogLevel level,
+                                const char* format, va_list args) {
+        static constexpr size_t kMaxMessage = 1023;
+        out.reserve(160 + channel.size());
+        _appendLinePrefix(out, channel, level);
+
+        const size_t start = out.size();
+        out.resize(start + kMaxMessage + 1);
+        const int len = vsnprintf(&out[start], kMaxMessage + 1, format, args);
+        out.resize(start + std::min<size_t>(len > 0 ? static_cast<size_t>(len) : 0, kMaxMessage));
+        out += '\n';
+    }
+
+    // 追加当前时间（秒以上部分按线程缓存，每秒只调用一次 localtime_r）
+    static void _appendTime(std::string& out) {
         auto now = std::chrono::system_clock::now();
         auto now_time = std::chrono::system_clock::to_time_t(now);
         auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
             now.time_since_epoch()) % 1000;
-        
-        std::tm tm;
-        #ifdef _WIN32
-            localtime_s(&tm, &now_time);
-        #else
+
+        thread_local std::time_t cachedTime = -1;
+        thread_local char cachedPrefix[32];
+        thread_local size_t cachedLen = 0;
+        if (now_time != cachedTime) {
+            std::tm tm;
             localtime_r(&now_time, &tm);
-        #endif
-        
-        std::ostringstream oss;
-        oss << std::put_time(&tm, "%Y-%m-%d %H:%M:%S")
-            << '.' << std::setfill('0') << std::setw(3) << ms.count();
-        return oss.str();
+            cachedLen = strftime(cachedPrefix, sizeof(cachedPrefix), "%Y-%m-%d %H:%M:%S", &tm);
+            cachedTime = now_time;
+        }
+
+        const int millis = static_cast<int>(ms.count());
+        char fraction[4] = {'.', static_cast<char>('0' + millis / 100),
+                            static_cast<char>('0' + millis / 10 % 10), static_cast<char>('0' + millis % 10)};
+        out.append(cachedPrefix, cachedLen);
+        out.append(fraction, sizeof(fraction));
     }
 };
 
+// 日志宏：先做编译期级别判断（常量），再做运行时级别判断（relaxed 原子读取），
+// 两者都通过才会求值参数并格式化
+#define LOG_COMPILED(level) (static_cast<int>(level) >= LOG_MIN_LEVEL)
+
+#define LOG_AT_(level, format, ...) \
+    do { \
+        if (LOG_COMPILED(level) && LogRecord::enabled(level)) \
+            LogRecord::addLog(level, format, ##__VA_ARGS__); \
+    } while (0)
+
+#define CH_LOG_AT_(channel, level, format, ...) \
+    do { \
+        if (LOG_COMPILED(level) && LogRecord::channelEnabled(channel, level)) \
+            LogRecord::addChannelLog(LogRecord::channelName(channel), level, format, ##__VA_ARGS__); \
+    } while (0)
+
 // 全局日志宏
-#define LOG_DEBUG(format, ...)    LogRecord::addLog(LogLevel::DEBUG, format, ##__VA_ARGS__)
-#define LOG_INFO(format, ...)     LogRecord::addLog(LogLevel::INFO, format, ##__VA_ARGS__)
-#define LOG_WARNING(format, ...)  LogRecord::addLog(LogLevel::WARNING, format, ##__VA_ARGS__)
-#define LOG_ERROR(format, ...)    LogRecord::addLog(LogLevel::ERROR, format, ##__VA_ARGS__)
+#define LOG_DEBUG(format, ...)    LOG_AT_(LogLevel::DEBUG, format, ##__VA_ARGS__)
+#define LOG_INFO(format, ...)     LOG_AT_(LogLevel::INFO, format, ##__VA_ARGS__)
+#define LOG_WARNING(format, ...)  LOG_AT_(LogLevel::WARNING, format, ##__VA_ARGS__)
+#define LOG_ERROR(format, ...)    LOG_AT_(LogLevel::ERROR, format, ##__VA_ARGS__)
 
-// 通道日志宏
-#define CH_LOG_DEBUG(channel, format, ...)    LogRecord::addChannelLog(channel, LogLevel::DEBUG, format, ##__VA_ARGS__)
-#define CH_LOG_INFO(channel, format, ...)     LogRecord::addChannelLog(channel, LogLevel::INFO, format, ##__VA_ARGS__)
-#define CH_LOG_WARNING(channel, format, ...)  LogRecord::addChannelLog(channel, LogLevel::WARNING, format, ##__VA_ARGS__)
-#define CH_LOG_ERROR(channel, format, ...)    LogRecord::addChannelLog(channel, LogLevel::ERROR, format, ##__VA_ARGS__)
+// 通道日志宏（channel 为 LogChannel 时按通道级别过滤，为名称字符串时按全局级别过滤）
+#define CH_LOG_DEBUG(channel, format, ...)    CH_LOG_AT_(channel, LogLevel::DEBUG, format, ##__VA_ARGS__)
+#define CH_LOG_INFO(channel, format, ...)     CH_LOG_AT_(channel, LogLevel::INFO, format, ##__VA_ARGS__)
+#define CH_LOG_WARNING(channel, format, ...)  CH_LOG_AT_(channel, LogLevel::WARNING, format, ##__VA_ARGS__)
+#define CH_LOG_ERROR(channel, format, ...)    CH_LOG_AT_(channel, LogLevel::ERROR, format, ##__VA_ARGS__)
 
-// 二进制日志宏（十六进制格式）
-#define LOG_BINARY(channel, prefix, data, len) LogRecord::logBinary(channel, prefix, data, len)
+// 二进制日志宏（十六进制格式）；报文日志按 DEBUG 级别过滤，通道级别为 info 及以上时不记录
+#define LOG_BINARY(channel, prefix, data, len) \
+    do { \
+        if (LOG_COMPILED(LogLevel::DEBUG) && LogRecord::channelEnabled(channel, LogLevel::DEBUG)) \
+            LogRecord::logBinary(LogRecord::channelName(channel), prefix, data, len); \
+    } while (0)
 
 // 二进制日志宏（文本格式）
-#define LOG_BINARY_TEXT(channel, prefix, data, len) LogRecord::logBinaryAsText(channel, prefix, data, len)
+#define LOG_BINARY_TEXT(channel, prefix, data, len) \
+    do { \
+        if (LOG_COMPILED(LogLevel::DEBUG) && LogRecord::channelEnabled(channel, LogLevel::DEBUG)) \
+            LogRecord::logBinaryAsText(LogRecord::channelName(channel), prefix, data, len); \
+    } while (0)
 
-#endif // LOGRECORD_H
\ No newline at end of file
+#endif // LOGRECORD_H
@@ -1,6 +1,9 @@
 #include "channel_manager.h"
 #include "config_parser.h"
 #include "database.h"
+#include "reactor.h"
+#include "traffic_capture.h"
+#include "stats_server.h"
 #include <iostream>
 #include <csignal>
 #include <atomic>
@@ -8,8 +11,15 @@
 #include <thread>
 #include <chrono>
 #include <unordered_map>
+#include <unordered_set>
 #include "logrecord.h"
 std::atomic<bool> running{true};
+std::atomic<bool> dumpStats{false};
+
+// 配置变更检查间隔：每次只执行一条 PRAGMA data_version，数据库未变化时不读取任何配置
+constexpr auto kConfigPollInterval = std::chrono::milliseconds(50);
+// 应用失败的通道（创建端点失败等）的重试间隔
+constexpr auto kConfigRetryInterval = std::chrono::seconds(1);
 
 void signalHandler(int signal) {
     running = false;
@@ -20,11 +30,194 @@ void signalHandler(int signal) {
     }
 }
 
+// kill -USR1 <PID>：在日志中输出各通道统计
+void statsSignalHandler(int) {
+    dumpStats = true;
+}
+
+// 输出统计快照：每个通道每个方向一行
+void logStats(ChannelManager& manager) {
+    static const char* const kDirections[2] = {"NODE1->NODE2", "NODE2->NODE1"};
+    for (const auto& stats : manager.snapshot()) {
+        for (int i = 0; i < 2; ++i) {
+            const DirectionStats& d = stats.directions[i];
+            LOG_INFO("Stats [%s] %s: in %llu B / %llu pkts, out %llu B / %llu pkts, dropped %llu B / %llu, "
+                     "ring high %llu/%zu B, runs %llu, blocked %llu, errors %llu, "
+                     "latency p50 %.1f us / p99 %.1f us / max %.1f us",
+                     stats.name.c_str(), kDirections[i],
+                     (unsigned long long)d.bytes_in, (unsigned long long)d.packets_in,
+                     (unsigned long long)d.bytes_out, (unsigned long long)d.packets_out,
+                     (unsigned long long)d.dropped_bytes, (unsigned long long)d.drops,
+                     (unsigned long long)d.ring_high_water, stats.ring_capacity,
+                     (unsigned long long)d.forward_runs, (unsigned long long)d.write_blocked,
+                     (unsigned long long)d.write_errors,
+                     d.latency.p50 / 1e3, d.latency.p99 / 1e3, d.latency.max / 1e3);
+        }
+    }
+}
+
+// 原地更新已有通道：日志级别直接生效，只有 input 或只有 output 变化时替换该端点
+// 其他字段变化（或两个端点都变化）返回 false，由调用方重建通道
+bool updateChannel(ChannelManager& manager, const ChannelConfig& current, const ChannelConfig& updated) {
+    ChannelConfig base = current;
+    base.log_level = updated.log_level;
+    base.input = updated.input;
+    base.output = updated.output;
+    const bool inputChanged = current.input != updated.input;
+    const bool outputChanged = current.output != updated.output;
+    if (base != updated || (inputChanged && outputChanged)) return false;
+
+    const auto& name = updated.name;
+    if (current.log_level != updated.log_level) {
+        LogLevel level;
+        if (!parseLogLevel(updated.log_level, level) || !manager.setChannelLogLevel(name, level)) {
+            return false;
+        }
+        LOG_INFO("Channel %s log level changed to %s", name.c_str(), updated.log_level.c_str());
+    }
+    if (inputChanged && !manager.replaceEndpoint(name, 0, updated.input)) return false;
+    if (outputChanged && !manager.replaceEndpoint(name, 1, updated.output)) return false;
+    return true;
+}
+
+// 应用一个新增或修改的通道：能原地更新时直接更新，否则重建
+void applyChannel(ChannelManager& manager, std::unordered_map<std::string, ChannelConfig>& configs,
+                  const ChannelConfig& config) {
+    const auto& name = config.name;
+    auto it = configs.find(name);
+    if (it != configs.end()) {
+        if (it->second == config) return;
+        if (updateChannel(manager, it->second, config)) {
+            it->second = config;
+            return;
+        }
+        manager.removeChannel(name);
+        configs.erase(it);
+    }
+    manager.addChannel(std::make_unique<ProtocolChannel>(config, manager.getThreadPool()));
+    configs[name] = config;
+}
+
+// 应用增量配置：只处理有变化的通道
+// 每个通道单独处理，失败的通道记入 failed 等待重试，不影响同一批中的其他通道；应用成功后从 failed 中移除
+void applyChanges(ChannelManager& manager, std::unordered_map<std::string, ChannelConfig>& configs,
+                  const ChannelChanges& changes, std::unordered_set<std::string>& failed) {
+    std::unordered_map<std::string, const ChannelConfig*> changed;
+    for (const auto& config : changes.changed) {
+        changed[config.name] = &config;
+    }
+
+    // 删除：删除后又以同名重新插入的通道按修改处理
+    for (const auto& name : changes.removed) {
+        if (changed.count(name) != 0) continue;
+        failed.erase(name);
+        if (configs.erase(name) > 0) {
+            manager.removeChannel(name);
+        }
+    }
+
+    for (const auto& config : changes.changed) {
+        try {
+            applyChannel(manager, configs, config);
+            failed.erase(config.name);
+        } catch (const std::exception& e) {
+            LOG_ERROR("Failed to apply channel %s: %s", config.name.c_str(), e.what());
+            failed.insert(config.name);
+        }
+    }
+}
+
+// 重试应用失败的通道：只按名称读取这些通道的当前配置，已删除或端点不完整的通道按删除处理
+ChannelChanges failedChanges(Database& db, const std::unordered_set<std::string>& failed) {
+    ChannelChanges changes;
+    for (const auto& name : failed) {
+        ChannelConfig config;
+        if (db.loadChannel(name, config)) {
+            changes.changed.push_back(std::move(config));
+        } else {
+            changes.removed.push_back(name);
+        }
+    }
+    return changes;
+}
+
 int main(int argc, char* argv[]) {
     signal(SIGINT, signalHandler);
     signal(SIGTERM, signalHandler);
+    signal(SIGUSR1, statsSignalHandler);
 
     LogRecord::init(true, true, "logs");
+
+    // 解析 --loops <n>：事件循环线程数（默认CPU核心数）
+    // 解析 --io-backend <epoll|io_uring>：I/O 后端（默认 epoll）
+    // 解析 --workers <n>：转发线程池线程数（默认 12）
+    // 解析 --scheduling <shared|affine>：转发任务调度方式（默认 shared）
+    // 解析 --worker-cpus <list>：转发线程绑定的 CPU 列表，如 "2-5,8"
+    // 解析 --log-overflow <block|drop|count>：日志队列满时的处理策略（默认 block）
+    // 解析 --log-level <debug|info|warning|error|off>：全局日志级别（默认 debug，通道日志级别见通道配置 log_level）
+    // 解析 --capture <dir>：报文以二进制抓包格式写入 dir（替代十六进制报文日志），用 capture_decode 查看
+    // 解析 --capture-segment-mb <n>：抓包分段文件大小（默认 64MB）
+    // 解析 --stats-listen <port|unix:path>：在 127.0.0.1:port 或 Unix 域套接字上提供统计（/metrics、/stats）
+    size_t numLoops = 0;
+    Reactor::Backend backend = Reactor::Backend::Epoll;
+    size_t numWorkers = 12;
+    ChannelManager::Scheduling scheduling = ChannelManager::Scheduling::Shared;
+    std::vector<int> workerCpus;
+    std::string captureDir;
+    size_t captureSegment = TrafficCapture::kDefaultSegmentSize;
+    std::string statsAddress;
+    for (int i = 1; i + 1 < argc; ) {
+        if (strcmp(argv[i], "--loops") == 0) {
+            numLoops = std::strtoul(argv[i + 1], nullptr, 10);
+        } else if (strcmp(argv[i], "--io-backend") == 0) {
+            if (!Reactor::parseBackend(argv[i + 1], backend)) {
+                LOG_ERROR("Unknown I/O backend: %s (expected epoll or io_uring)", argv[i + 1]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--workers") == 0) {
+            numWorkers = std::strtoul(argv[i + 1], nullptr, 10);
+        } else if (strcmp(argv[i], "--scheduling") == 0) {
+            if (!ChannelManager::parseScheduling(argv[i + 1], scheduling)) {
+                LOG_ERROR("Unknown scheduling mode: %s (expected shared or affine)", argv[i + 1]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--log-overflow") == 0) {
+            LogRecord::OverflowPolicy policy;
+            if (!LogRecord::parseOverflowPolicy(argv[i + 1], policy)) {
+                LOG_ERROR("Unknown log overflow policy: %s (expected block, drop or count)", argv[i + 1]);
+                return 1;
+            }
+            LogRecord::setOverflowPolicy(policy);
+        } else if (strcmp(argv[i], "--log-level") == 0) {
+            LogLevel level;
+            if (!parseLogLevel(argv[i + 1], level)) {
+                LOG_ERROR("Unknown log level: %s (expected debug, info, warning, error or off)", argv[i + 1]);
+                return 1;
+            }
+            LogRecord::setLevel(level);
+        } else if (strcmp(argv[i], "--capture") == 0) {
+            captureDir = argv[i + 1];
+        } else if (strcmp(argv[i], "--capture-segment-mb") == 0) {
+            captureSegment = std::strtoull(argv[i + 1], nullptr, 10) * 1024 * 1024;
+        } else if (strcmp(argv[i], "--stats-listen") == 0) {
+            statsAddress = argv[i + 1];
+        } else if (strcmp(argv[i], "--worker-cpus") == 0) {
+            if (!ChannelManager::parseCpuList(argv[i + 1], workerCpus)) {
+                LOG_ERROR("Invalid CPU list: %s (expected e.g. 0-3,6)", argv[i + 1]);
+                return 1;
+            }
+        } else {
+            ++i;
+            continue;
+        }
+        // 移除选项和参数
+        for (int j = i; j + 2 < argc; ++j) {
+            argv[j] = argv[j + 2];
+        }
+        argc -= 2;
+    }
+    Reactor::init(numLoops, backend);
+
     try {
         // 处理命令行参数 
          if (argc > 1 && strcmp(argv[1], "--update") == 0) {
@@ -45,62 +238,72 @@ int main(int argc, char* argv[]) {
         }
         
         
+        if (!captureDir.empty() && !TrafficCapture::getInstance().open(captureDir, captureSegment)) {
+            return 1;
+        }
+
         // 从数据库加载初始配置
         Database db;
-        auto channels = db.loadChannels();
+        int64_t dataVersion = db.dataVersion();
+        ChannelChanges initial = db.loadChangesSince(-1);
+        int64_t configVersion = initial.version;
         
-        ChannelManager manager;
+        ChannelManager manager(numWorkers, scheduling, workerCpus);
         std::unordered_map<std::string, ChannelConfig> last_configs;
+        std::unordered_set<std::string> failed_channels; // 应用失败、等待重试的通道
+        StatsServer statsServer(manager);
+        if (!statsAddress.empty() && !statsServer.start(statsAddress)) {
+            return 1;
+        }
         
         // 初始加载配置
-        for (const auto& config : channels) {
-            manager.addChannel(std::make_unique<ProtocolChannel>(
-                config.name, config.input, config.output, manager.getThreadPool()));
-            last_configs[config.name] = config;
-        }
+        applyChanges(manager, last_configs, initial, failed_channels);
         LOG_INFO("Starting protocol converter...");
         
-        // 主循环：定期检查数据库更新
+        auto nextRetry = std::chrono::steady_clock::now();
+        std::unordered_set<std::string> retrying; // 上次输出日志时待重试的通道
+        // 主循环：data_version 变化（其他连接提交了写事务）时只读取配置版本之后变更的通道
         while (running) {
-            std::this_thread::sleep_for(std::chrono::seconds(1));
+            std::this_thread::sleep_for(kConfigPollInterval);
+            if (dumpStats.exchange(false)) {
+                logStats(manager);
+            }
             
             try {
-                // 加载最新配置
-                auto new_configs = db.loadChannels();
-                std::unordered_map<std::string, ChannelConfig> new_config_map;
-                for (const auto& config : new_configs) {
-                    new_config_map[config.name] = config;
-                }
-                
-                // 检查更新：停止并移除已删除或修改的通道
-                for (auto it = last_configs.begin(); it != last_configs.end(); ) {
-                    const auto& name = it->first;
-                    if (new_config_map.find(name) == new_config_map.end()) {
-                        manager.removeChannel(name);
-                        it = last_configs.erase(it);
-                    } else if (new_config_map[name] != it->second) {
-                        manager.removeChannel(name);
-                        it = last_configs.erase(it);
-                    } else {
-                        ++it;
+                const int64_t currentDataVersion = db.dataVersion();
+                if (currentDataVersion != dataVersion) {
+                    ChannelChanges changes = db.loadChangesSince(configVersion);
+                    if (changes.version != configVersion) {
+                        LOG_INFO("Configuration version %lld -> %lld: %zu changed, %zu removed",
+                                 (long long)configVersion, (long long)changes.version,
+                                 changes.changed.size(), changes.removed.size());
+                        applyChanges(manager, last_configs, changes, failed_channels);
                     }
+                    // 整批应用完成后才推进版本；其中应用失败的通道由下面的重试处理
+                    configVersion = changes.version;
+                    dataVersion = currentDataVersion;
                 }
-                
-                // 添加新增或修改的通道
-                for (const auto& config : new_configs) {
-                    const auto& name = config.name;
-                    if (last_configs.find(name) == last_configs.end()) {
-                        manager.addChannel(std::make_unique<ProtocolChannel>(
-                            name, config.input, config.output, manager.getThreadPool()));
-                        last_configs[name] = config;
+
+                const auto now = std::chrono::steady_clock::now();
+                if (failed_channels.empty()) {
+                    retrying.clear();
+                } else if (now >= nextRetry) {
+                    nextRetry = now + kConfigRetryInterval;
+                    // 只在待重试的通道集合变化时输出
+                    if (failed_channels != retrying) {
+                        retrying = failed_channels;
+                        LOG_INFO("Retrying %zu failed channels", retrying.size());
                     }
+                    applyChanges(manager, last_configs, failedChanges(db, failed_channels), failed_channels);
                 }
             } catch (const std::exception& e) {
                 LOG_ERROR("Error updating channels: %s", e.what());
             }
         }
         // 停止所有通道
+        statsServer.stop();
         manager.stopAll();
+        TrafficCapture::getInstance().close();
     }
     catch (const std::exception& e) {
         LOG_ERROR("Fatal error: %s", e.what());
@@ -0,0 +1,242 @@
+// modbus_gateway.cpp
+#include "modbus_gateway.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+// Modbus 异常码
+constexpr uint8_t kServerBusy = 0x06;          // 请求队列已满
+constexpr uint8_t kPathUnavailable = 0x0A;     // 请求无法写入 RTU 端缓冲区
+constexpr uint8_t kTargetNoResponse = 0x0B;    // RTU 从站响应超时
+
+// CRC16（Modbus：多项式 0xA001，初值 0xFFFF）查表，表在编译期生成
+struct CrcTable {
+    uint16_t values[256];
+    constexpr CrcTable() : values() {
+        for (int i = 0; i < 256; ++i) {
+            uint16_t crc = static_cast<uint16_t>(i);
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc & 1) ? static_cast<uint16_t>((crc >> 1) ^ 0xA001) : static_cast<uint16_t>(crc >> 1);
+            }
+            values[i] = crc;
+        }
+    }
+};
+constexpr CrcTable kCrcTable;
+
+uint16_t crc16(const uint8_t* data, size_t len) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; ++i) {
+        crc = static_cast<uint16_t>((crc >> 8) ^ kCrcTable.values[(crc ^ data[i]) & 0xFF]);
+    }
+    return crc;
+}
+
+uint16_t readBigEndian(const uint8_t* p) {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+void writeBigEndian(uint8_t* p, uint16_t value) {
+    p[0] = static_cast<uint8_t>(value >> 8);
+    p[1] = static_cast<uint8_t>(value);
+}
+
+} // namespace
+
+constexpr std::chrono::milliseconds ModbusGateway::kDefaultTimeout;
+constexpr std::chrono::milliseconds ModbusGateway::kBroadcastDelay;
+
+std::unique_ptr<ModbusGateway> ModbusGateway::create(const ChannelConfig& config, const LogChannel& log) {
+    const std::string& type = config.conversion;
+    if (type.empty() || type == "none") return nullptr;
+
+    int tcpNode;
+    if (type == "modbus_tcp_rtu") {
+        tcpNode = 0;
+    } else if (type == "modbus_rtu_tcp") {
+        tcpNode = 1;
+    } else {
+        throw std::invalid_argument("Unknown conversion: " + type);
+    }
+    const auto timeout = config.modbus_timeout_ms > 0 ? std::chrono::milliseconds(config.modbus_timeout_ms)
+                                                      : kDefaultTimeout;
+    return std::unique_ptr<ModbusGateway>(new ModbusGateway(tcpNode, timeout, log));
+}
+
+ModbusGateway::ModbusGateway(int tcpNode, std::chrono::milliseconds timeout, const LogChannel& log)
+    : _tcpNode(tcpNode), _rtuNode(1 - tcpNode), _timeout(timeout), _log(log) {}
+
+EndpointConfig ModbusGateway::framedEndpoint(const EndpointConfig& config, int node) const {
+    EndpointConfig framed = config;
+    if (node == _tcpNode) {
+        // MBAP：长度字段位于偏移 4（2 字节），其值为单元 ID + PDU 的字节数
+        framed.framing = "length";
+        framed.frame_length_offset = 4;
+        framed.frame_length_size = 2;
+        framed.frame_length_adjust = 0;
+        framed.max_frame_size = kMaxTcpFrame;
+    } else if (framed.framing.empty() || framed.framing == "none") {
+        framed.framing = "gap";
+        if (framed.max_frame_size == 0) framed.max_frame_size = kMaxRtuFrame;
+    }
+    return framed;
+}
+
+void ModbusGateway::onFrame(int direction, const uint8_t* data, size_t len) {
+    if (direction == _tcpNode) {
+        handleRequest(data, len);
+    } else {
+        handleResponse(data, len);
+    }
+}
+
+void ModbusGateway::handleRequest(const uint8_t* data, size_t len) {
+    // 长度字段已由分帧器校验与帧长度一致；单元 ID + PDU 至少 2 字节（单元 ID + 功能码）
+    if (len < kMbapHeader + 1 || len > kMaxTcpFrame || readBigEndian(data + 2) != 0) {
+        if (_drop) _drop(_tcpNode, "invalid MBAP header", len);
+        return;
+    }
+    _requests.fetch_add(1, std::memory_order_relaxed);
+
+    const uint16_t transaction = readBigEndian(data);
+    if (_count == kQueueDepth) {
+        CH_LOG_WARNING(_log, "Modbus request queue full, rejected transaction %u", transaction);
+        sendException(transaction, data[6], data[7], kServerBusy);
+        return;
+    }
+
+    Request& request = _queue[(_head + _count) % kQueueDepth];
+    request.transaction = transaction;
+    request.unit = data[6];
+    request.function = data[7];
+    // RTU 帧：单元 ID + PDU（MBAP 头之后的部分）+ CRC16（低字节在前），直接写入队列中的缓冲区
+    const size_t body = len - (kMbapHeader - 1);
+    std::memcpy(request.frame.data(), data + kMbapHeader - 1, body);
+    const uint16_t crc = crc16(request.frame.data(), body);
+    request.frame[body] = static_cast<uint8_t>(crc);
+    request.frame[body + 1] = static_cast<uint8_t>(crc >> 8);
+    request.length = body + 2;
+    ++_count;
+    sendNext();
+}
+
+void ModbusGateway::handleResponse(const uint8_t* data, size_t len) {
+    // 单元 ID + 功能码 + CRC16
+    if (len < 4 || len > kMaxRtuFrame) {
+        if (_drop) _drop(_rtuNode, "invalid RTU frame length", len);
+        return;
+    }
+    const uint16_t crc = static_cast<uint16_t>(data[len - 2] | (data[len - 1] << 8));
+    if (crc != crc16(data, len - 2)) {
+        // 继续等待：从站可能在超时前重新发送
+        _crcErrors.fetch_add(1, std::memory_order_relaxed);
+        if (_drop) _drop(_rtuNode, "RTU CRC error", len);
+        return;
+    }
+    // 没有等待响应的请求（超时后才到达的响应、广播请求的响应），或单元 ID / 功能码与队首请求不符
+    const Request& request = _queue[_head];
+    if (!_outstanding || request.unit == 0 || data[0] != request.unit || (data[1] & 0x7F) != request.function) {
+        if (_drop) _drop(_rtuNode, "unexpected RTU response", len);
+        return;
+    }
+
+    std::memcpy(_response.data() + kMbapHeader - 1, data, len - 2);
+    sendResponse(request.transaction, len - 2);
+    _responses.fetch_add(1, std::memory_order_relaxed);
+    complete();
+}
+
+void ModbusGateway::complete() {
+    _outstanding = false;
+    _head = (_head + 1) % kQueueDepth;
+    --_count;
+    sendNext();
+}
+
+void ModbusGateway::sendNext() {
+    while (_count > 0 && !_outstanding) {
+        const Request& request = _queue[_head];
+        if (!_send || !_send(_tcpNode, request.frame.data(), request.length)) {
+            sendException(request.transaction, request.unit, request.function, kPathUnavailable);
+            _head = (_head + 1) % kQueueDepth;
+            --_count;
+            continue;
+        }
+        _outstanding = true;
+        _deadline = Clock::now() + (request.unit == 0 ? kBroadcastDelay : _timeout);
+        armTimer();
+    }
+}
+
+void ModbusGateway::sendResponse(uint16_t transaction, size_t len) {
+    writeBigEndian(_response.data(), transaction);
+    writeBigEndian(_response.data() + 2, 0);
+    writeBigEndian(_response.data() + 4, static_cast<uint16_t>(len));
+    if (_send) _send(_rtuNode, _response.data(), kMbapHeader - 1 + len);
+}
+
+void ModbusGateway::sendException(uint16_t transaction, uint8_t unit, uint8_t function, uint8_t code) {
+    // 广播请求没有响应
+    if (unit == 0) return;
+    _exceptions.fetch_add(1, std::memory_order_relaxed);
+    uint8_t* pdu = _response.data() + kMbapHeader - 1;
+    pdu[0] = unit;
+    pdu[1] = static_cast<uint8_t>(function | 0x80);
+    pdu[2] = code;
+    sendResponse(transaction, 3);
+}
+
+void ModbusGateway::armTimer() {
+    if (!_loop) return;
+    if (_timer != 0) {
+        if (_timerDue <= _deadline) return;
+        _loop->cancelTimer(_timer);
+    }
+    // 定时器精度为毫秒：向上取整
+    const auto delay = std::chrono::ceil<std::chrono::milliseconds>(_deadline - Clock::now());
+    _timerDue = _deadline;
+    _timer = _loop->runAfter(std::max(delay, std::chrono::milliseconds(0)), [this] {
+        _timer = 0;
+        onTimer();
+    });
+}
+
+void ModbusGateway::onTimer() {
+    if (!_outstanding) return;
+    if (Clock::now() < _deadline) {
+        armTimer();
+        return;
+    }
+    const Request& request = _queue[_head];
+    if (request.unit != 0) {
+        _timeouts.fetch_add(1, std::memory_order_relaxed);
+        CH_LOG_WARNING(_log, "Modbus unit %u function 0x%02X: no response within %lld ms (transaction %u)",
+                       request.unit, request.function, static_cast<long long>(_timeout.count()),
+                       request.transaction);
+        sendException(request.transaction, request.unit, request.function, kTargetNoResponse);
+    }
+    complete();
+}
+
+void ModbusGateway::stop() {
+    if (_timer != 0 && _loop) {
+        _loop->cancelTimer(_timer);
+    }
+    _timer = 0;
+    _head = 0;
+    _count = 0;
+    _outstanding = false;
+}
+
+ModbusStats ModbusGateway::stats() const {
+    ModbusStats stats;
+    stats.requests = _requests.load(std::memory_order_relaxed);
+    stats.responses = _responses.load(std::memory_order_relaxed);
+    stats.timeouts = _timeouts.load(std::memory_order_relaxed);
+    stats.crc_errors = _crcErrors.load(std::memory_order_relaxed);
+    stats.exceptions = _exceptions.load(std::memory_order_relaxed);
+    return stats;
+}
@@ -0,0 +1,109 @@
+// modbus_gateway.h
+#pragma once
+#include "shared_structs.h"
+#include "channel_metrics.h"
+#include "event_loop.h"
+#include "logrecord.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+// Modbus TCP <-> Modbus RTU 转换（网关）：TCP 端为主站，RTU 端（串口）为从站
+// 通道配置 conversion 选择 TCP 端："modbus_tcp_rtu" NODE1 为 TCP、NODE2 为 RTU；"modbus_rtu_tcp" 相反
+//  - 请求（TCP -> RTU）：去掉 MBAP 头（事务 ID、协议 ID、长度），保留单元 ID 与 PDU，追加 CRC16
+//  - 响应（RTU -> TCP）：校验并去掉 CRC16，加上 MBAP 头，事务 ID 还原为对应请求的事务 ID
+//  - RTU 端同一时刻只有一个未完成的请求，其余请求在队列中等待；响应超时返回异常码 0x0B
+//  - 广播请求（单元 ID 0）没有响应，发送后等待转换间隔再发送下一个请求
+//  - 响应不区分 TCP 连接：TCP 端只能有一个主站（tcp_server 端点限制为一个客户端）
+// 两端的帧由分帧器输出（TCP 端按 MBAP 长度字段分帧，RTU 端按字符间隔分帧）。
+// 请求队列与响应缓冲区预先分配，转换过程不分配内存。
+// 由事件循环线程调用（帧回调与超时定时器），非线程安全；stats() 可在任意线程调用
+class ModbusGateway {
+public:
+    using Clock = std::chrono::steady_clock;
+    // 发送回调：写入 direction 方向的缓冲区（0 = NODE1->NODE2，1 = NODE2->NODE1），缓冲区满时返回 false
+    using SendCallback = std::function<bool(int direction, const uint8_t* data, size_t len)>;
+    // 丢弃回调：无法转换的帧（direction 为帧的来源方向）
+    using DropCallback = std::function<void(int direction, const char* reason, size_t len)>;
+
+    static constexpr size_t kMbapHeader = 7;                 // 事务 ID + 协议 ID + 长度 + 单元 ID
+    static constexpr size_t kMaxPdu = 253;                   // 功能码 + 数据
+    static constexpr size_t kMaxRtuFrame = 1 + kMaxPdu + 2;  // 单元 ID + PDU + CRC16
+    static constexpr size_t kMaxTcpFrame = kMbapHeader + kMaxPdu;
+    static constexpr size_t kQueueDepth = 32;                // 等待发往 RTU 端的请求数上限
+    static constexpr std::chrono::milliseconds kDefaultTimeout{1000};
+    static constexpr std::chrono::milliseconds kBroadcastDelay{100}; // 广播后的转换间隔
+
+    // 按通道配置创建：未配置转换时返回 nullptr，配置非法时抛出 std::invalid_argument
+    static std::unique_ptr<ModbusGateway> create(const ChannelConfig& config, const LogChannel& log);
+
+    ModbusGateway(int tcpNode, std::chrono::milliseconds timeout, const LogChannel& log);
+    ModbusGateway(const ModbusGateway&) = delete;
+    ModbusGateway& operator=(const ModbusGateway&) = delete;
+
+    void setSendCallback(SendCallback cb) { _send = std::move(cb); }
+    void setDropCallback(DropCallback cb) { _drop = std::move(cb); }
+    void setEventLoop(EventLoop* loop) { _loop = loop; }
+
+    // node 端点的分帧配置：TCP 端固定按 MBAP 长度字段分帧；RTU 端未配置分帧时按字符间隔（t3.5）分帧
+    EndpointConfig framedEndpoint(const EndpointConfig& config, int node) const;
+
+    // 分帧器输出的完整帧（direction 为帧的来源方向，data 只在调用期间有效）
+    void onFrame(int direction, const uint8_t* data, size_t len);
+
+    // 取消超时定时器并清空请求队列（事件循环线程中调用，不再有帧回调）
+    void stop();
+
+    int tcpNode() const { return _tcpNode; }
+    ModbusStats stats() const;
+
+private:
+    // 等待发往 RTU 端的请求：frame 中为已转换的 RTU 帧
+    struct Request {
+        uint16_t transaction = 0; // 主站的事务 ID，响应中还原
+        uint8_t unit = 0;
+        uint8_t function = 0;
+        size_t length = 0;
+        std::array<uint8_t, kMaxRtuFrame> frame;
+    };
+
+    void handleRequest(const uint8_t* data, size_t len);
+    void handleResponse(const uint8_t* data, size_t len);
+    // 队首请求完成（收到响应 / 超时 / 广播间隔结束），发送下一个
+    void complete();
+    void sendNext();
+    // 向 TCP 端发送 MBAP 帧：header 之后的 len 字节（单元 ID + PDU）已在 _response 中
+    void sendResponse(uint16_t transaction, size_t len);
+    void sendException(uint16_t transaction, uint8_t unit, uint8_t function, uint8_t code);
+    // 按队首请求的截止时间设置定时器：已有更早到期的定时器时不重新设置，到期后再按截止时间判断
+    void armTimer();
+    void onTimer();
+
+    const int _tcpNode;
+    const int _rtuNode;
+    const std::chrono::milliseconds _timeout;
+    const LogChannel& _log;
+    EventLoop* _loop = nullptr;
+    SendCallback _send;
+    DropCallback _drop;
+
+    // 请求环形队列：_head 为队首，_outstanding 时队首请求已发往 RTU 端
+    std::array<Request, kQueueDepth> _queue;
+    size_t _head = 0;
+    size_t _count = 0;
+    bool _outstanding = false;
+    Clock::time_point _deadline{};
+    EventLoop::TimerId _timer = 0;
+    Clock::time_point _timerDue{};
+    std::array<uint8_t, kMaxTcpFrame> _response; // RTU -> TCP 转换缓冲区
+
+    std::atomic<uint64_t> _requests{0};
+    std::atomic<uint64_t> _responses{0};
+    std::atomic<uint64_t> _timeouts{0};
+    std::atomic<uint64_t> _crcErrors{0};
+    std::atomic<uint64_t> _exceptions{0};
+};
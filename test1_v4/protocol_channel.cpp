@@ -6,158 +6,723 @@
 #include "udp_client_endpoint.h"
 #include "serial_endpoint.h"
 #include "logrecord.h"
+#include "reactor.h"
 #include <iostream>
 #include <iomanip>
 #include <ctime>
 #include <memory>
 #include <atomic>
 #include <array>
+#include <algorithm>
+#include <chrono>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+#include <thread>
 
-std::unique_ptr<Endpoint> ProtocolChannel::createEndpoint(const EndpointConfig& config) {
+std::unique_ptr<Endpoint> ProtocolChannel::createEndpoint(const EndpointConfig& config, int node) {
     if (config.type == "tcp_server") {
-        return std::make_unique<TcpServerEndpoint>(config.port);
+        auto endpoint = std::make_unique<TcpServerEndpoint>(config.port);
+        // Modbus 转换的 TCP 端只接受一个主站：响应写回通道后广播到所有连接，无法送回发出请求的主站
+        if (gateway_ && node == gateway_->tcpNode()) endpoint->setMaxClients(1);
+        return endpoint;
     }
     else if (config.type == "tcp_client") {
-        return std::make_unique<TcpClientEndpoint>(config.ip, config.port);
+        auto endpoint = std::make_unique<TcpClientEndpoint>(config.ip, config.port);
+        endpoint->setWriteWatermarks(config.write_high_watermark, config.write_low_watermark);
+        return endpoint;
     }
     else if (config.type == "udp_server") {
-        return std::make_unique<UdpServerEndpoint>(config.port);
+        auto endpoint = std::make_unique<UdpServerEndpoint>(config.port);
+        endpoint->setClientIdleTimeout(std::chrono::seconds(config.client_idle_timeout));
+        return endpoint;
     }
     else if (config.type == "udp_client") {
         return std::make_unique<UdpClientEndpoint>(config.ip, config.port);
     }
     else if (config.type == "serial") {
-        return std::make_unique<SerialEndpoint>(config.serial_port, config.baud_rate);
+        auto endpoint = std::make_unique<SerialEndpoint>(config.serial_port, config.baud_rate);
+        endpoint->setReceiveOptions(config.low_latency, config.vmin, config.vtime);
+        return endpoint;
     }
     
     throw std::runtime_error("Unknown endpoint type: " + config.type);
 }
 
+namespace {
+ChannelConfig makeChannelConfig(const std::string& name,
+                                const EndpointConfig& node1_config,
+                                const EndpointConfig& node2_config) {
+    ChannelConfig config;
+    config.name = name;
+    config.input = node1_config;
+    config.output = node2_config;
+    return config;
+}
+
+constexpr size_t kSplicePipeSize = 1024 * 1024; // 与 RingBuffer 容量一致
+constexpr size_t kSpliceChunk = 64 * 1024;
+
+// 背压水位（缓冲区容量的比例）：高水位之上保留的空间用于吸收暂停生效前已读出的数据
+constexpr size_t kPauseNumerator = 3;   // 高水位 3/4
+constexpr size_t kResumeNumerator = 1;  // 低水位 1/4
+constexpr size_t kWatermarkDenominator = 4;
+
+const char* const kDirections[2] = {"[NODE1->NODE2]", "[NODE2->NODE1]"};
+
+// 通道日志级别为 level 时是否记录报文日志（与 LOG_BINARY 的条件一致）
+bool packetLogging(LogLevel level) {
+    return LOG_COMPILED(LogLevel::DEBUG) && LogLevel::DEBUG >= level;
+}
+
+// 配置中的日志级别，无法识别时使用 debug 并记录警告
+LogLevel channelLogLevel(const ChannelConfig& config) {
+    LogLevel level = LogLevel::DEBUG;
+    if (!parseLogLevel(config.log_level, level)) {
+        CH_LOG_WARNING(config.name, "Unknown log_level '%s', using debug", config.log_level.c_str());
+    }
+    return level;
+}
+} // namespace
+
 ProtocolChannel::ProtocolChannel(const std::string& name,
                                const EndpointConfig& node1_config,
                                const EndpointConfig& node2_config,
-                               ThreadPool& thread_pool): name_(name), thread_pool_(thread_pool),
+                               ThreadPool& thread_pool)
+    : ProtocolChannel(makeChannelConfig(name, node1_config, node2_config), thread_pool) {}
+
+ProtocolChannel::ProtocolChannel(const ChannelConfig& config, ThreadPool& thread_pool)
+    : name_(config.name), log_(config.name, channelLogLevel(config)), thread_pool_(thread_pool),
     forwarding_task_active_{{ATOMIC_FLAG_INIT, ATOMIC_FLAG_INIT}} {
     
-    CH_LOG_INFO(name_, "Creating channel %s", name_.c_str());
-    CH_LOG_INFO(name_, "Input: %s, Output: %s", node1_config.type.c_str(), node2_config.type.c_str());
+    CH_LOG_INFO(log_, "Creating channel %s", name_.c_str());
+    CH_LOG_INFO(log_, "Input: %s, Output: %s", config.input.type.c_str(), config.output.type.c_str());
+
+    if (config.flow_control == "drop") {
+        flow_control_ = FlowControl::Drop;
+    } else if (!config.flow_control.empty() && config.flow_control != "backpressure") {
+        CH_LOG_WARNING(log_, "Unknown flow_control '%s', using backpressure", config.flow_control.c_str());
+    }
+    CH_LOG_INFO(log_, "Flow control: %s", flow_control_ == FlowControl::Drop ? "drop" : "backpressure");
+    CH_LOG_INFO(log_, "Log level: %s", config.log_level.c_str());
     
+    node_types_ = {config.input.type, config.output.type};
     try {
-        node1_ = createEndpoint(node1_config);
-        node2_ = createEndpoint(node2_config);
+        setupGateway(config);
+        node1_ = createEndpoint(config.input, 0);
+        node2_ = createEndpoint(config.output, 1);
+        framers_[0] = createFramer(config.input, 0);
+        framers_[1] = createFramer(config.output, 1);
     } catch (const std::exception& e) {
-        CH_LOG_ERROR(name_, "Endpoint creation failed: %s", e.what());
+        CH_LOG_ERROR(log_, "Endpoint creation failed: %s", e.what());
         throw;
     }
 
-    // 设置日志回调
-    auto make_log_callback = [this](const std::string& prefix) {
-        return [this, prefix](const std::string& msg) {
-            CH_LOG_INFO(name_, "[%s] %s", prefix.c_str(), msg.c_str());
-        };
-    };
-    
-    node1_->setLogCallback(make_log_callback("NODE1"));
-    node2_->setLogCallback(make_log_callback("NODE2"));
-    
-    // 设置错误回调
-    auto make_error_callback = [this](const std::string& prefix) {
-        return [this, prefix](const std::string& msg) {
-            CH_LOG_ERROR(name_, "[%s] %s", prefix.c_str(), msg.c_str());
-        };
-    };
-    
-    node1_->setErrorCallback(make_error_callback("NODE1"));
-    node2_->setErrorCallback(make_error_callback("NODE2"));
-    
+    // 同一通道的两个端点分配到同一个事件循环（按通道分片）
+    EventLoop* loop = Reactor::getInstance().nextLoop();
+    node1_->setEventLoop(loop);
+    node2_->setEventLoop(loop);
+    if (gateway_) gateway_->setEventLoop(loop);
+
     // 设置数据转发
-    setupForwarding();
+    capture_id_ = TrafficCapture::getInstance().registerChannel(name_);
+    setupZeroCopy(config);
+    setupEndpoint(*node1_, 0);
+    setupEndpoint(*node2_, 1);
 }
 
-void ProtocolChannel::setupForwarding() {
-    // Node1 -> Node2 数据回调
-    node1_->setDataCallback([this](const uint8_t* data, size_t len) {
-        LOG_BINARY(name_, "[NODE1 RECV]", data, len);
-        
-        if (!node1_to_node2_buffer_.push(data, len)) {
-            CH_LOG_WARNING(name_, "NODE1_TO_NODE2 buffer full, dropped %zu bytes", len);
+void ProtocolChannel::setupZeroCopy(const ChannelConfig& config) {
+    if (!config.zero_copy) return;
+
+    if (!node1_->supportsSplice() || !node2_->supportsSplice()) {
+        CH_LOG_WARNING(log_, "Zero-copy requested but only TCP<->TCP channels support it, using buffered mode");
+        return;
+    }
+    // 分帧需要在用户态解析数据
+    if (framers_[0] || framers_[1]) {
+        CH_LOG_INFO(log_, "Zero-copy disabled: framing is configured");
+        return;
+    }
+    // 报文日志（通道日志级别为 debug）/ 抓包需要用户态数据副本，自动回退
+    if (capture_id_ >= 0) {
+        CH_LOG_INFO(log_, "Zero-copy disabled: traffic capture is enabled");
+        return;
+    }
+    if (packetLogging(log_.level())) {
+        zero_copy_log_fallback_ = true;
+        CH_LOG_INFO(log_, "Zero-copy disabled: packet logging is enabled (log_level debug)");
+        return;
+    }
+
+    for (auto& pipe : splice_pipes_) {
+        int fds[2];
+        if (pipe2(fds, O_NONBLOCK | O_CLOEXEC) < 0) {
+            CH_LOG_ERROR(log_, "Splice pipe creation failed: %s, using buffered mode", strerror(errno));
+            for (auto& p : splice_pipes_) {
+                if (p.readFd >= 0) ::close(p.readFd);
+                if (p.writeFd >= 0) ::close(p.writeFd);
+                p = SplicePipe{};
+            }
             return;
         }
-        
-        // 提交转发任务（如果尚未提交）
-        if (!forwarding_task_active_[0].test_and_set(std::memory_order_acq_rel)) {
-            thread_pool_.enqueue([this] {
-                forwardDataTask(node1_to_node2_buffer_, *node2_, "[NODE1->NODE2]", 0);
-            });
-        }
+        pipe.readFd = fds[0];
+        pipe.writeFd = fds[1];
+        // 尽量放大管道容量，失败时保持默认大小
+        fcntl(pipe.writeFd, F_SETPIPE_SZ, static_cast<int>(kSplicePipeSize));
+    }
+
+    zero_copy_ = true;
+    CH_LOG_INFO(log_, "Zero-copy (splice) forwarding enabled");
+}
+
+void ProtocolChannel::setupEndpoint(Endpoint& endpoint, int node) {
+    // 以该端点为源的转发方向与 node 相同，以该端点为目标的方向为另一个
+    const int source = node;
+    const int target = 1 - node;
+    const std::string prefix = node == 0 ? "NODE1" : "NODE2";
+
+    endpoint.setLogCallback([this, prefix](const std::string& msg) {
+        CH_LOG_INFO(log_, "[%s] %s", prefix.c_str(), msg.c_str());
     });
-    
-    // Node2 -> Node1 数据回调
-    node2_->setDataCallback([this](const uint8_t* data, size_t len) {
-        LOG_BINARY(name_, "[NODE2 RECV]", data, len);
-        
-        if (!node2_to_node1_buffer_.push(data, len)) {
-            CH_LOG_WARNING(name_, "NODE2_TO_NODE1 buffer full, dropped %zu bytes", len);
-            return;
+    // 错误计入以该端点为目标的方向的 write_errors
+    endpoint.setErrorCallback([this, prefix, target](const std::string& msg) {
+        metrics_.add(target, ChannelMetrics::WriteErrors);
+        CH_LOG_ERROR(log_, "[%s] %s", prefix.c_str(), msg.c_str());
+    });
+
+    if (zero_copy_) {
+        endpoint.setSpliceCallback([this, source](int fd) { return spliceForward(fd, source); });
+        // 目标恢复可写后发送管道积压数据并恢复源端读取（回调在事件循环线程中执行）
+        endpoint.setWritableCallback([this, target] { flushSplicePipe(target); });
+        return;
+    }
+
+    endpoint.setDataCallback([this, source](const uint8_t* data, size_t len) {
+        handleData(source, data, len);
+    });
+    // 目标端点恢复可写后继续转发积压数据
+    endpoint.setWritableCallback([this, target] {
+        writable_seq_[target].fetch_add(1, std::memory_order_acq_rel);
+        scheduleForward(target);
+    });
+}
+
+void ProtocolChannel::handleData(int index, const uint8_t* data, size_t len) {
+    const auto received = LatencyTracker::Clock::now();
+    logReceived(index, data, len);
+    metrics_.add(index, ChannelMetrics::BytesIn, len);
+    metrics_.add(index, ChannelMetrics::PacketsIn);
+
+    if (framers_[index]) {
+        // 完整的帧由分帧器回调 enqueue，未完成的部分留在分帧器中
+        framers_[index]->feed(data, len, received);
+        armFrameTimer(index);
+        return;
+    }
+    enqueue(index, data, len, received);
+}
+
+bool ProtocolChannel::enqueue(int index, const uint8_t* data, size_t len,
+                              LatencyTracker::Clock::time_point received) {
+    RingBuffer& buffer = index == 0 ? node1_to_node2_buffer_ : node2_to_node1_buffer_;
+    const bool framed = framers_[index] != nullptr;
+    if (!(framed ? buffer.pushRecord(data, len) : buffer.push(data, len))) {
+        metrics_.add(index, ChannelMetrics::Drops);
+        metrics_.add(index, ChannelMetrics::DroppedBytes, len);
+        CH_LOG_WARNING(log_, "%s buffer full, dropped %zu bytes%s", kDirections[index], len, framed ? " (frame)" : "");
+        return false;
+    }
+    metrics_.updateHighWater(index, buffer.size());
+    latency_trackers_[index].received(len, received);
+
+    pauseSourceIfFull(index);
+    // 提交转发任务（如果尚未提交）
+    scheduleForward(index);
+    return true;
+}
+
+std::unique_ptr<Framer> ProtocolChannel::createFramer(const EndpointConfig& config, int node) {
+    std::unique_ptr<Framer> framer = Framer::create(gateway_ ? gateway_->framedEndpoint(config, node) : config);
+    if (!framer) return nullptr;
+
+    const int index = node;
+    if (gateway_) {
+        framer->setFrameCallback([this, index](const uint8_t* data, size_t len) {
+            gateway_->onFrame(index, data, len);
+        });
+    } else {
+        framer->setFrameCallback([this, index](const uint8_t* data, size_t len) {
+            enqueue(index, data, len, LatencyTracker::Clock::now());
+        });
+    }
+    framer->setDiscardCallback([this, index](const char* reason, size_t len) {
+        metrics_.add(index, ChannelMetrics::Drops);
+        metrics_.add(index, ChannelMetrics::DroppedBytes, len);
+        CH_LOG_WARNING(log_, "%s %s, dropped %zu bytes", kDirections[index], reason, len);
+    });
+    CH_LOG_INFO(log_, "NODE%d framing: %s", node + 1, framer->name());
+    return framer;
+}
+
+void ProtocolChannel::setupGateway(const ChannelConfig& config) {
+    gateway_ = ModbusGateway::create(config, log_);
+    if (!gateway_) return;
+    conversion_ = config.conversion;
+
+    // 转换后的帧写入缓冲区，两个方向均为帧记录
+    gateway_->setSendCallback([this](int index, const uint8_t* data, size_t len) {
+        return enqueue(index, data, len, LatencyTracker::Clock::now());
+    });
+    gateway_->setDropCallback([this](int index, const char* reason, size_t len) {
+        metrics_.add(index, ChannelMetrics::Drops);
+        metrics_.add(index, ChannelMetrics::DroppedBytes, len);
+        CH_LOG_WARNING(log_, "%s %s, dropped %zu bytes", kDirections[index], reason, len);
+    });
+    CH_LOG_INFO(log_, "Conversion: %s (Modbus TCP on NODE%d, RTU on NODE%d, response timeout %u ms)",
+                config.conversion.c_str(), gateway_->tcpNode() + 1, 2 - gateway_->tcpNode(),
+                config.modbus_timeout_ms > 0 ? config.modbus_timeout_ms
+                                             : static_cast<uint32_t>(ModbusGateway::kDefaultTimeout.count()));
+}
+
+void ProtocolChannel::armFrameTimer(int index) {
+    if (frame_timers_[index] != 0) return;
+    const auto deadline = framers_[index]->deadline();
+    if (deadline == Framer::Clock::time_point::max()) return;
+
+    // 定时器精度为毫秒：向上取整，到期后由 flushIdle 按实际间隔判断
+    const auto delay = std::chrono::ceil<std::chrono::milliseconds>(deadline - Framer::Clock::now());
+    Endpoint& source = index == 0 ? *node1_ : *node2_;
+    frame_timers_[index] = source.getEventLoop()->runAfter(
+        std::max(delay, std::chrono::milliseconds(0)), [this, index] {
+            frame_timers_[index] = 0;
+            framers_[index]->flushIdle(Framer::Clock::now());
+            armFrameTimer(index);
+        });
+}
+
+void ProtocolChannel::replaceFramer(int node, std::unique_ptr<Framer> framer) {
+    if (frame_timers_[node] != 0) {
+        (node == 0 ? *node1_ : *node2_).getEventLoop()->cancelTimer(frame_timers_[node]);
+        frame_timers_[node] = 0;
+    }
+    // 原端点未完成的帧不会再补齐
+    if (framers_[node]) framers_[node]->reset();
+    // 字节流与帧记录互不兼容：在两者之间切换时丢弃该方向缓冲区中的数据
+    if ((framers_[node] != nullptr) != (framer != nullptr)) {
+        discardBuffered(node);
+    }
+    framers_[node] = std::move(framer);
+}
+
+void ProtocolChannel::discardBuffered(int index) {
+    RingBuffer& buffer = index == 0 ? node1_to_node2_buffer_ : node2_to_node1_buffer_;
+    const size_t size = buffer.size();
+    frame_offset_[index] = 0;
+    if (size == 0) return;
+
+    buffer.consume(size);
+    latency_trackers_[index].clear();
+    metrics_.add(index, ChannelMetrics::Drops);
+    metrics_.add(index, ChannelMetrics::DroppedBytes, size);
+    CH_LOG_WARNING(log_, "%s framing changed, dropped %zu buffered bytes", kDirections[index], size);
+}
+
+bool ProtocolChannel::replaceEndpoint(int node, const EndpointConfig& config) {
+    std::unique_ptr<Endpoint> fresh;
+    std::unique_ptr<Framer> framer;
+    try {
+        fresh = createEndpoint(config, node);
+        framer = createFramer(config, node);
+    } catch (const std::exception& e) {
+        CH_LOG_ERROR(log_, "Endpoint creation failed: %s", e.what());
+        return false;
+    }
+    if (zero_copy_ && (!fresh->supportsSplice() || framer)) {
+        CH_LOG_INFO(log_, "New %s endpoint does not support zero-copy, channel must be rebuilt", config.type.c_str());
+        return false;
+    }
+
+    std::unique_ptr<Endpoint>& slot = node == 0 ? node1_ : node2_;
+    EventLoop* loop = slot->getEventLoop();
+    fresh->setEventLoop(loop);
+    setupEndpoint(*fresh, node);
+
+    // 停止两个方向的转发任务：等待运行中的任务结束并占住任务标志，
+    // 期间另一端点的数据照常写入缓冲区，只是不提交转发任务
+    for (auto& active : forwarding_task_active_) {
+        while (active.test_and_set(std::memory_order_acq_rel)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
         }
-        
-        if (!forwarding_task_active_[1].test_and_set(std::memory_order_acq_rel)) {
-            thread_pool_.enqueue([this] {
-                forwardDataTask(node2_to_node1_buffer_, *node1_, "[NODE2->NODE1]", 1);
-            });
+    }
+
+    // 关闭后事件循环不再回调原端点；事件循环线程中的回调（零拷贝的 flushSplicePipe）
+    // 通过 node1_ / node2_ 访问目标端点，因此在循环线程中替换
+    slot->close();
+    loop->runAndWait([&] {
+        std::lock_guard<std::mutex> lock(endpoints_mutex_);
+        slot.swap(fresh);
+        node_types_[node] = config.type;
+        replaceFramer(node, std::move(framer));
+        // 以新端点为目标的方向：队首帧已有一部分写入原端点，剩余部分丢弃
+        const int target = 1 - node;
+        if (frame_offset_[target] > 0) {
+            RingBuffer& buffer = target == 0 ? node1_to_node2_buffer_ : node2_to_node1_buffer_;
+            struct iovec spans[2];
+            size_t frame;
+            if (buffer.peekRecord(spans, frame) > 0) {
+                buffer.consumeRecord(frame);
+                latency_trackers_[target].discarded(frame - frame_offset_[target]);
+            }
+            frame_offset_[target] = 0;
         }
     });
+
+    // 新端点的源方向缓冲区中可能仍有原端点读入的数据，按水位决定是否先暂停读取
+    pauseSourceIfFull(node);
+    if (running_) {
+        slot->open();
+    }
+    CH_LOG_INFO(log_, "NODE%d endpoint replaced: %s", node + 1, config.type.c_str());
+
+    for (auto& active : forwarding_task_active_) {
+        active.clear(std::memory_order_release);
+    }
+    // 继续转发替换期间积压的数据
+    if (zero_copy_) {
+        loop->runInLoop([this, node] { flushSplicePipe(1 - node); });
+    } else {
+        if (!node1_to_node2_buffer_.empty()) scheduleForward(0);
+        if (!node2_to_node1_buffer_.empty()) scheduleForward(1);
+    }
+    return true;
+}
+
+void ProtocolChannel::logReceived(int index, const uint8_t* data, size_t len) {
+    if (capture_id_ >= 0) {
+        TrafficCapture::getInstance().write(capture_id_, index == 0 ? capture::Direction::Node1Recv
+                                                                    : capture::Direction::Node2Recv, data, len);
+    } else {
+        LOG_BINARY(log_, index == 0 ? "[NODE1 RECV]" : "[NODE2 RECV]", data, len);
+    }
+}
+
+void ProtocolChannel::logForwarded(int index, const uint8_t* data, size_t len) {
+    if (capture_id_ >= 0) {
+        TrafficCapture::getInstance().write(capture_id_, index == 0 ? capture::Direction::Node1ToNode2
+                                                                    : capture::Direction::Node2ToNode1, data, len);
+    } else {
+        LOG_BINARY_TEXT(log_, kDirections[index], data, len);
+    }
+}
+
+void ProtocolChannel::scheduleForward(int index) {
+    if (!forwarding_task_active_[index].test_and_set(std::memory_order_acq_rel)) {
+        const int home = home_worker_.load(std::memory_order_relaxed);
+        if (home >= 0) {
+            thread_pool_.enqueueTo(home, [this, index] {
+                forwardDataTask(index);
+            });
+        } else {
+            thread_pool_.enqueue([this, index] {
+                forwardDataTask(index);
+            });
+        }
+    }
+}
+
+void ProtocolChannel::pauseSourceIfFull(int index) {
+    if (flow_control_ != FlowControl::Backpressure) return;
+
+    RingBuffer& buffer = index == 0 ? node1_to_node2_buffer_ : node2_to_node1_buffer_;
+    Endpoint& source = index == 0 ? *node1_ : *node2_;
+    if (source.isReadPaused() ||
+        buffer.size() < buffer.capacity() / kWatermarkDenominator * kPauseNumerator) {
+        return;
+    }
+
+    source.setReadPaused(true);
+    CH_LOG_DEBUG(log_, "%s buffer above high watermark, source reading paused", kDirections[index]);
+
+    // 转发任务可能在暂停标志生效前已排空缓冲区并退出，此处复查，避免源端永久暂停
+    resumeSourceIfDrained(index);
+}
+
+void ProtocolChannel::resumeSourceIfDrained(int index) {
+    RingBuffer& buffer = index == 0 ? node1_to_node2_buffer_ : node2_to_node1_buffer_;
+    Endpoint& source = index == 0 ? *node1_ : *node2_;
+
+    // 与 pauseSourceIfFull 配对：写暂停标志 / 读位置后各自读取对方，保证至少一方看到对方的更新
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!source.isReadPaused() ||
+        buffer.size() > buffer.capacity() / kWatermarkDenominator * kResumeNumerator) {
+        return;
+    }
+
+    source.setReadPaused(false);
+    CH_LOG_DEBUG(log_, "%s buffer below low watermark, source reading resumed", kDirections[index]);
 }
 
-void ProtocolChannel::forwardDataTask(RingBuffer& source, Endpoint& target, 
-                                    const std::string& direction, int index) {
+void ProtocolChannel::forwardDataTask(int index) {
+    RingBuffer& source = index == 0 ? node1_to_node2_buffer_ : node2_to_node1_buffer_;
+    Endpoint& target = index == 0 ? *node2_ : *node1_;
+    const char* direction = kDirections[index];
+    const auto task_start = std::chrono::steady_clock::now();
+    metrics_.add(index, ChannelMetrics::ForwardRuns);
+
+    bool blocked = false;
+    const uint32_t seq = writable_seq_[index].load(std::memory_order_acquire);
     try {
-        uint8_t buffer[4096];
-        size_t total_forwarded = 0;
-        size_t len;
-        
-        // 处理当前所有可用数据
-        while ((len = source.pop(buffer, sizeof(buffer)))) {
-            LOG_BINARY_TEXT(name_, direction, buffer, len);
-            target.write(buffer, len);
-            total_forwarded += len;
-        }
-        
-        // if (total_forwarded > 0) {
-        //     CH_LOG_DEBUG(name_, "%s forwarded %zu bytes", direction.c_str(), total_forwarded);
-        // }
+        blocked = framers_[index] ? forwardFrames(index, source, target) : forwardBytes(index, source, target);
     } 
     catch (const std::runtime_error& e) {
-        CH_LOG_ERROR(name_, "%s forwarding error: %s", direction.c_str(), e.what());
+        metrics_.add(index, ChannelMetrics::WriteErrors);
+        CH_LOG_ERROR(log_, "%s forwarding error: %s", direction, e.what());
     } 
     catch (const std::exception& e) {
-        CH_LOG_ERROR(name_, "%s unexpected error: %s", direction.c_str(), e.what());
+        metrics_.add(index, ChannelMetrics::WriteErrors);
+        CH_LOG_ERROR(log_, "%s unexpected error: %s", direction, e.what());
     }
     
+    busy_ns_.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - task_start).count(), std::memory_order_relaxed);
+
     // 标记任务完成
     forwarding_task_active_[index].clear(std::memory_order_release);
     
+    // 目标阻塞时由可写通知重新提交；若通知已在本轮期间到达则立即重试
+    if (blocked) {
+        if (writable_seq_[index].load(std::memory_order_acquire) != seq) {
+            scheduleForward(index);
+        }
+        return;
+    }
+
     // 检查是否有新数据到达，需要重新提交任务
     if (!source.empty()) {
-        if (forwarding_task_active_[index].test_and_set(std::memory_order_acq_rel)) {
-            // 已经有任务在运行（可能是新数据触发的）
-            return;
+        scheduleForward(index);
+    }
+}
+
+bool ProtocolChannel::forwardBytes(int index, RingBuffer& source, Endpoint& target) {
+    const size_t max_write = target.maxWriteSize();
+    struct iovec spans[2];
+    size_t available;
+    int count;
+
+    // 处理当前所有可用数据：可读区域最多两段，一次向量写提交
+    while ((count = source.peek(spans, available, max_write)) > 0) {
+        ssize_t written = target.writev(spans, count);
+        if (written < 0) {
+            source.consume(available);
+            dropUnavailable(index, available);
+            resumeSourceIfDrained(index);
+            continue;
+        }
+        if (written == 0) {
+            metrics_.add(index, ChannelMetrics::WriteBlocked);
+            return true;
+        }
+        metrics_.add(index, ChannelMetrics::BytesOut, written);
+        metrics_.add(index, ChannelMetrics::PacketsOut);
+        latency_trackers_[index].written(written, LatencyTracker::Clock::now(), latency_[index]);
+
+        // 只记录并确认内核已接收的部分
+        logWritten(index, spans, count, written);
+        source.consume(written);
+        resumeSourceIfDrained(index);
+
+        if (static_cast<size_t>(written) < available) {
+            metrics_.add(index, ChannelMetrics::WriteBlocked);
+            return true; // 目标暂时无法接收更多数据，等待可写通知
         }
-        thread_pool_.enqueue([this, index, &source, &target, direction] {
-            forwardDataTask(source, target, direction, index);
-        });
     }
+    return false;
+}
+
+bool ProtocolChannel::forwardFrames(int index, RingBuffer& source, Endpoint& target) {
+    const size_t max_write = target.maxWriteSize();
+    size_t& offset = frame_offset_[index];
+    struct iovec spans[2];
+    size_t frame;
+    int count;
+
+    // 每帧一次向量写：数据报目标每帧一个数据报；流式目标部分接收时从 offset 继续写出该帧剩余部分
+    while ((count = source.peekRecord(spans, frame)) > 0) {
+        if (frame > max_write) {
+            source.consumeRecord(frame);
+            latency_trackers_[index].discarded(frame);
+            metrics_.add(index, ChannelMetrics::Drops);
+            metrics_.add(index, ChannelMetrics::DroppedBytes, frame);
+            CH_LOG_WARNING(log_, "%s frame of %zu bytes exceeds target write size %zu, dropped",
+                           kDirections[index], frame, max_write);
+            resumeSourceIfDrained(index);
+            continue;
+        }
+
+        // 跳过已写出的部分
+        struct iovec* remaining = spans;
+        for (size_t skip = offset; skip > 0;) {
+            if (skip >= remaining->iov_len) {
+                skip -= remaining->iov_len;
+                ++remaining;
+                --count;
+            } else {
+                remaining->iov_base = static_cast<uint8_t*>(remaining->iov_base) + skip;
+                remaining->iov_len -= skip;
+                skip = 0;
+            }
+        }
+
+        ssize_t written = target.writev(remaining, count);
+        if (written < 0) {
+            // 帧的剩余部分一并丢弃（已写出的部分无法撤回）
+            dropUnavailable(index, frame - offset);
+            offset = 0;
+            source.consumeRecord(frame);
+            resumeSourceIfDrained(index);
+            continue;
+        }
+        if (written == 0) {
+            metrics_.add(index, ChannelMetrics::WriteBlocked);
+            return true;
+        }
+        metrics_.add(index, ChannelMetrics::BytesOut, written);
+        metrics_.add(index, ChannelMetrics::PacketsOut);
+        latency_trackers_[index].written(written, LatencyTracker::Clock::now(), latency_[index]);
+        logWritten(index, remaining, count, written);
+
+        offset += written;
+        if (offset < frame) {
+            metrics_.add(index, ChannelMetrics::WriteBlocked);
+            return true; // 目标暂时无法接收该帧的剩余部分，等待可写通知
+        }
+        offset = 0;
+        source.consumeRecord(frame);
+        resumeSourceIfDrained(index);
+    }
+    return false;
+}
+
+void ProtocolChannel::dropUnavailable(int index, size_t len) {
+    latency_trackers_[index].discarded(len);
+    metrics_.add(index, ChannelMetrics::Drops);
+    metrics_.add(index, ChannelMetrics::DroppedBytes, len);
+    CH_LOG_WARNING(log_, "%s target unavailable, dropped %zu bytes", kDirections[index], len);
+}
+
+void ProtocolChannel::logWritten(int index, const struct iovec* spans, int count, size_t written) {
+    size_t logged = 0;
+    for (int i = 0; i < count && logged < written; ++i) {
+        size_t part = std::min(spans[i].iov_len, written - logged);
+        logForwarded(index, static_cast<const uint8_t*>(spans[i].iov_base), part);
+        logged += part;
+    }
+}
+
+bool ProtocolChannel::spliceForward(int fd, int index) {
+    // 管道中仍有目标未接收的数据时不再读取，保证顺序
+    if (!flushSplicePipe(index)) {
+        return true;
+    }
+
+    ssize_t moved = splice(fd, nullptr, splice_pipes_[index].writeFd, nullptr, kSpliceChunk,
+                           SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+    if (moved == 0) {
+        return false; // 对端关闭
+    }
+    if (moved < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+            return true;
+        }
+        CH_LOG_ERROR(log_, "%s splice read error: %s", kDirections[index], strerror(errno));
+        return false;
+    }
+
+    metrics_.add(index, ChannelMetrics::BytesIn, moved);
+    metrics_.add(index, ChannelMetrics::PacketsIn);
+    metrics_.updateHighWater(index, moved);
+    latency_trackers_[index].received(moved, LatencyTracker::Clock::now());
+    splice_pending_[index] = moved;
+    flushSplicePipe(index);
+    return true;
+}
+
+bool ProtocolChannel::flushSplicePipe(int index) {
+    size_t& pending = splice_pending_[index];
+    Endpoint& source = index == 0 ? *node1_ : *node2_;
+    Endpoint& target = index == 0 ? *node2_ : *node1_;
+
+    if (pending > 0) {
+        ssize_t written = target.spliceFrom(splice_pipes_[index].readFd, pending);
+        if (written < 0) {
+            Endpoint::spliceDiscard(splice_pipes_[index].readFd, pending);
+            dropUnavailable(index, pending);
+            pending = 0;
+        } else if (written > 0) {
+            pending -= written;
+            metrics_.add(index, ChannelMetrics::BytesOut, written);
+            metrics_.add(index, ChannelMetrics::PacketsOut);
+            latency_trackers_[index].written(written, LatencyTracker::Clock::now(), latency_[index]);
+        }
+        if (pending > 0) {
+            metrics_.add(index, ChannelMetrics::WriteBlocked);
+        }
+    }
+
+    if (pending > 0 && flow_control_ == FlowControl::Drop) {
+        // 与缓冲模式的"buffer full"一致：目标暂时无法接收的数据被丢弃
+        Endpoint::spliceDiscard(splice_pipes_[index].readFd, pending);
+        metrics_.add(index, ChannelMetrics::Drops);
+        metrics_.add(index, ChannelMetrics::DroppedBytes, pending);
+        latency_trackers_[index].discarded(pending);
+        CH_LOG_WARNING(log_, "%s target busy, dropped %zu bytes", kDirections[index], pending);
+        pending = 0;
+    }
+
+    // 背压：数据留在管道中，暂停源端读取直到目标可写
+    source.setReadPaused(pending > 0);
+    return pending == 0;
+}
+
+ChannelStats ProtocolChannel::stats() const {
+    ChannelStats stats;
+    stats.name = name_;
+    stats.ring_capacity = node1_to_node2_buffer_.capacity();
+    stats.directions[0] = metrics_.read(0);
+    stats.directions[1] = metrics_.read(1);
+    stats.directions[0].latency = latency_[0].summary();
+    stats.directions[1].latency = latency_[1].summary();
+    stats.conversion = conversion_;
+    if (gateway_) stats.modbus = gateway_->stats();
+    std::lock_guard<std::mutex> lock(endpoints_mutex_);
+    stats.endpoints[0].type = node_types_[0];
+    stats.endpoints[1].type = node_types_[1];
+    node1_->fillStats(stats.endpoints[0]);
+    node2_->fillStats(stats.endpoints[1]);
+    return stats;
 }
 
 ProtocolChannel::~ProtocolChannel() {
     stop();
+    for (auto& pipe : splice_pipes_) {
+        if (pipe.readFd >= 0) ::close(pipe.readFd);
+        if (pipe.writeFd >= 0) ::close(pipe.writeFd);
+    }
+}
+
+bool ProtocolChannel::setLogLevel(LogLevel level) {
+    if ((zero_copy_ && packetLogging(level)) || (zero_copy_log_fallback_ && !packetLogging(level))) {
+        return false;
+    }
+    log_.setLevel(level);
+    return true;
 }
 
 void ProtocolChannel::start() {
     running_ = true;
     node1_->open();
     node2_->open();
-    CH_LOG_INFO(name_, "---------------Channel started---------------");
+    CH_LOG_INFO(log_, "---------------Channel started---------------");
 }
 
 void ProtocolChannel::stop() {
@@ -171,6 +736,16 @@ void ProtocolChannel::stop() {
     // 关闭端点
     node1_->close();
     node2_->close();
+
+    // 端点关闭后不再有数据回调，在事件循环线程中取消分帧与转换的定时器
+    node1_->getEventLoop()->runAndWait([this] {
+        for (int i = 0; i < 2; ++i) {
+            if (frame_timers_[i] == 0) continue;
+            (i == 0 ? *node1_ : *node2_).getEventLoop()->cancelTimer(frame_timers_[i]);
+            frame_timers_[i] = 0;
+        }
+        if (gateway_) gateway_->stop();
+    });
     
     // 等待活动任务完成（最多50ms）
     constexpr int max_wait = 5;
@@ -185,5 +760,5 @@ void ProtocolChannel::stop() {
         std::this_thread::sleep_for(std::chrono::milliseconds(10));
     }
     
-    CH_LOG_INFO(name_, "Channel stopped");
+    CH_LOG_INFO(log_, "Channel stopped");
 }
\ No newline at end of file
@@ -3,9 +3,16 @@
 #include "endpoint.h"
 #include "ring_buffer.h"
 #include "thread_pool.h"
+#include "traffic_capture.h"
+#include "logrecord.h"
+#include "channel_metrics.h"
+#include "framer.h"
+#include "modbus_gateway.h"
 #include <memory>
 #include <string>
 #include <atomic>
+#include <array>
+#include <mutex>
 #include "shared_structs.h"
 class ProtocolChannel {
 public:
@@ -13,26 +20,120 @@ public:
                    const EndpointConfig& node1_config,
                    const EndpointConfig& node2_config,
                    ThreadPool& thread_pool);
+    ProtocolChannel(const ChannelConfig& config, ThreadPool& thread_pool);
     
     ~ProtocolChannel();
     void start();
     void stop();
     const std::string& getName() const { return name_; }
+    bool isZeroCopy() const { return zero_copy_; }
+
+    // 缓冲区满时的流控策略
+    enum class FlowControl {
+        Backpressure, // 超过高水位暂停源端读取，回落到低水位后恢复
+        Drop          // 缓冲区满时丢弃数据
+    };
+    FlowControl flowControl() const { return flow_control_; }
+
+    // 统计快照（任意线程调用，汇总各线程分片）
+    ChannelStats stats() const;
+
+    // 原地替换一个端点（node: 0 = NODE1 / input，1 = NODE2 / output），另一端点的连接与两个方向缓冲区中的数据保留
+    // 新端点创建失败、或零拷贝通道的新端点不支持 splice 时返回 false（原端点保持不变，需重建通道）
+    // 只能由一个线程调用（配置变更线程），不可与 stop() 并发
+    bool replaceEndpoint(int node, const EndpointConfig& config);
+
+    // 运行时修改通道日志级别（立即生效，不影响转发）
+    // 零拷贝通道不记录报文日志：新级别改变零拷贝是否可用（开启 / 关闭报文日志）时不修改并返回 false，需重建通道
+    bool setLogLevel(LogLevel level);
+    LogLevel logLevel() const { return log_.level(); }
+
+    // 亲和调度：转发任务固定投递到线程池的 home 工作线程（-1 表示共享调度，由任意线程执行）
+    void setHomeWorker(int worker) { home_worker_.store(worker, std::memory_order_relaxed); }
+    int homeWorker() const { return home_worker_.load(std::memory_order_relaxed); }
+    // 取出并清零自上次调用以来转发任务的累计执行时间（纳秒），供重平衡统计负载
+    uint64_t takeBusyNanos() { return busy_ns_.exchange(0, std::memory_order_relaxed); }
 
 private:
-    std::unique_ptr<Endpoint> createEndpoint(const EndpointConfig& config);
-    void setupForwarding();
-    // 数据转发任务实现
-    void forwardDataTask(RingBuffer& source, Endpoint& target, 
-                         const std::string& direction, int index);
+    // splice 中转管道（每个方向一个）
+    struct SplicePipe {
+        int readFd = -1;
+        int writeFd = -1;
+    };
+
+    // 创建 node 端点（node: 0 = NODE1，1 = NODE2）
+    std::unique_ptr<Endpoint> createEndpoint(const EndpointConfig& config, int node);
+    // 设置端点的日志 / 错误 / 转发回调（node: 0 = NODE1，1 = NODE2）
+    void setupEndpoint(Endpoint& endpoint, int node);
+    // 数据回调：写入 index 方向的缓冲区（分帧方向先经过分帧器）并提交转发任务
+    void handleData(int index, const uint8_t* data, size_t len);
+    // 写入 index 方向的缓冲区：分帧方向每次写入一条帧记录，否则追加到字节流；缓冲区满时丢弃并返回 false
+    bool enqueue(int index, const uint8_t* data, size_t len, LatencyTracker::Clock::time_point received);
+    // 分帧：按源端点配置创建分帧器（node 同时是以该端点为源的方向），未配置分帧时返回 nullptr
+    // 配置了协议转换时使用转换需要的分帧，完整的帧交给转换器
+    std::unique_ptr<Framer> createFramer(const EndpointConfig& config, int node);
+    // 协议转换：按通道配置创建转换器并设置回调，未配置转换时 gateway_ 为 nullptr
+    void setupGateway(const ChannelConfig& config);
+    // 替换 node 端点的分帧器（事件循环线程中调用，两个方向的转发任务已停止）
+    void replaceFramer(int node, std::unique_ptr<Framer> framer);
+    // 字符间隔分帧：按分帧器的截止时间设置输出定时器（事件循环线程）
+    void armFrameTimer(int index);
+    // 丢弃 index 方向缓冲区中的全部数据（转发任务已停止）
+    void discardBuffered(int index);
+    void setupZeroCopy(const ChannelConfig& config);
+    // 零拷贝转发：source socket -> 管道 -> target，数据不经过用户态
+    bool spliceForward(int fd, int index);
+    // 发送管道中目标尚未接收的数据，返回 false 表示仍有积压（源端已暂停）
+    bool flushSplicePipe(int index);
+    // 背压：缓冲区超过高水位时暂停源端读取 / 回落到低水位后恢复
+    void pauseSourceIfFull(int index);
+    void resumeSourceIfDrained(int index);
+    // 报文日志：启用抓包时写二进制记录，否则写十六进制（接收）/ 文本（转发）日志
+    void logReceived(int index, const uint8_t* data, size_t len);
+    void logForwarded(int index, const uint8_t* data, size_t len);
+    // 提交转发任务（如果该方向尚未有任务在运行）
+    void scheduleForward(int index);
+    // 数据转发任务实现（index: 0 = NODE1->NODE2, 1 = NODE2->NODE1）
+    void forwardDataTask(int index);
+    // 转发字节流 / 帧记录，目标暂时无法接收更多数据时返回 true
+    bool forwardBytes(int index, RingBuffer& source, Endpoint& target);
+    bool forwardFrames(int index, RingBuffer& source, Endpoint& target);
+    // 目标不可用（writev / spliceFrom 返回 -1）：丢弃 len 字节并计入丢弃
+    void dropUnavailable(int index, size_t len);
+    // 报文日志：只记录目标已接收的 written 字节
+    void logWritten(int index, const struct iovec* spans, int count, size_t written);
 
     std::string name_;
+    LogChannel log_;
     std::unique_ptr<Endpoint> node1_;
     std::unique_ptr<Endpoint> node2_;
+    std::array<std::string, 2> node_types_; // 端点类型（统计输出使用）
+    mutable std::mutex endpoints_mutex_;    // 替换端点与 stats() 互斥（转发路径不加锁）
     RingBuffer node1_to_node2_buffer_{1024 * 1024}; // 1MB buffer
     RingBuffer node2_to_node1_buffer_{1024 * 1024}; // 1MB buffer
     ThreadPool& thread_pool_;
     std::atomic<bool> running_{false};
      // 使用原子标志跟踪转发任务状态
     std::array<std::atomic_flag, 2> forwarding_task_active_;
+    // 目标端点可写通知计数，用于避免部分写入后丢失唤醒
+    std::array<std::atomic<uint32_t>, 2> writable_seq_{};
+    FlowControl flow_control_ = FlowControl::Backpressure;
+    bool zero_copy_ = false;
+    bool zero_copy_log_fallback_ = false; // 请求了零拷贝，但因报文日志回退到缓冲模式
+    std::array<SplicePipe, 2> splice_pipes_;
+    std::array<size_t, 2> splice_pending_{}; // 管道中积压的字节数（仅事件循环线程访问）
+    int capture_id_ = -1; // 抓包通道 ID（-1 表示未启用抓包）
+    std::atomic<int> home_worker_{-1};
+    std::atomic<uint64_t> busy_ns_{0};
+    ChannelMetrics metrics_;
+    // 转发延迟：数据回调交付 -> 目标端点 writev 接收（每个方向一个）
+    std::array<LatencyTracker, 2> latency_trackers_;
+    std::array<LatencyHistogram, 2> latency_;
+    // 源端点的分帧器（index 为方向，nullptr 表示字节流；只在事件循环线程中使用，替换时转发任务已停止）
+    std::array<std::unique_ptr<Framer>, 2> framers_;
+    std::array<EventLoop::TimerId, 2> frame_timers_{}; // 字符间隔分帧的输出定时器（0 表示未设置，仅事件循环线程访问）
+    std::array<size_t, 2> frame_offset_{};             // 队首帧已被目标接收的字节数（仅转发任务访问）
+    // Modbus TCP <-> RTU 转换器（nullptr 表示透传；只在事件循环线程中使用，stats() 除外）
+    std::unique_ptr<ModbusGateway> gateway_;
+    std::string conversion_;
 };
\ No newline at end of file
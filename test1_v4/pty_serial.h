@@ -0,0 +1,161 @@
+// pty_serial.h
+#pragma once
+#include <string>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <stdexcept>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <asm/termbits.h>
+#include <sys/ioctl.h>
+
+// 伪终端串口模拟：posix_openpt 创建主 / 从设备对，从设备路径作为串口交给 SerialEndpoint（或 ChannelSerial）打开
+// 从设备与真实串口一样接受 TCSETS2 / BOTHER 配置；模拟端读写主设备，充当线路另一端的设备
+// 开启限速后按从设备上配置的波特率收发（8N1，每字节 10 位），模拟线路时序：
+//  - write：设备 -> 主机，每个字节在线路上传输完成后才写入主设备
+//  - read：主机 -> 设备，按线路速率从主设备取出数据，主设备缓冲区写满后主机端的写入被阻塞（与真实串口的背压一致）
+// 模拟端自身持有一个从设备句柄，端点关闭 / 重新打开期间主设备不会因从设备全部关闭而读到 EIO
+// 非线程安全：write 与 read 可以分别在两个线程中调用，同一方向只能有一个调用方
+class PtySerial {
+public:
+    // 8N1：起始位 + 8 个数据位 + 停止位
+    static constexpr int kBitsPerByte = 10;
+
+    PtySerial() {
+        _masterFd = posix_openpt(O_RDWR | O_NOCTTY);
+        if (_masterFd < 0) throw std::runtime_error("posix_openpt failed: " + std::string(strerror(errno)));
+        char name[64];
+        if (grantpt(_masterFd) != 0 || unlockpt(_masterFd) != 0 || ptsname_r(_masterFd, name, sizeof(name)) != 0) {
+            const std::string error = strerror(errno);
+            ::close(_masterFd);
+            throw std::runtime_error("pty setup failed: " + error);
+        }
+        _slavePath = name;
+        _slaveFd = ::open(name, O_RDWR | O_NOCTTY);
+        if (_slaveFd < 0) {
+            const std::string error = strerror(errno);
+            ::close(_masterFd);
+            throw std::runtime_error("open " + _slavePath + " failed: " + error);
+        }
+    }
+
+    ~PtySerial() {
+        ::close(_slaveFd);
+        ::close(_masterFd);
+    }
+
+    PtySerial(const PtySerial&) = delete;
+    PtySerial& operator=(const PtySerial&) = delete;
+
+    // 从设备路径（作为 serial_port 配置）
+    const std::string& slavePath() const { return _slavePath; }
+    // 主设备句柄（可用于 poll）
+    int fd() const { return _masterFd; }
+
+    // 从设备当前的终端配置（端点通过 TCSETS2 设置的内容）
+    termios2 slaveConfig() const {
+        termios2 tty{};
+        if (ioctl(_slaveFd, TCGETS2, &tty) != 0) {
+            throw std::runtime_error("TCGETS2 failed: " + std::string(strerror(errno)));
+        }
+        return tty;
+    }
+
+    // 从设备配置的波特率：内核在设置时按 CBAUD / BOTHER 换算到 c_ospeed
+    int baudRate() const { return static_cast<int>(slaveConfig().c_ospeed); }
+
+    // 等待端点把从设备配置为指定波特率的原始模式（非规范、无回显），超时返回 false
+    bool waitConfigured(int baud, std::chrono::milliseconds timeout) const {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (true) {
+            const termios2 tty = slaveConfig();
+            if (static_cast<int>(tty.c_ospeed) == baud && (tty.c_lflag & (ICANON | ECHO)) == 0) return true;
+            if (std::chrono::steady_clock::now() > deadline) return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    // 是否按从设备配置的波特率限速（默认关闭：以伪终端的速度收发）
+    void setPacing(bool enabled) { _pacing = enabled; }
+    bool pacing() const { return _pacing; }
+
+    // 设备 -> 主机：写完全部数据才返回，失败返回 false
+    bool write(const void* data, size_t len) {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        while (len > 0) {
+            size_t n = len;
+            if (_pacing) {
+                const Wire wire = wireTiming();
+                n = std::min(len, wire.chunk);
+                // 该段数据在线路上传输完成的时刻
+                std::this_thread::sleep_until(reserve(_txIdle, n, wire.byteTime));
+            }
+            if (!writeAll(p, n)) return false;
+            p += n;
+            len -= n;
+        }
+        return true;
+    }
+
+    // 主机 -> 设备：与 ::read 语义相同（无数据时阻塞）；限速时每次最多取出一段，按线路速率延迟返回
+    ssize_t read(void* buffer, size_t len) {
+        if (!_pacing) return ::read(_masterFd, buffer, len);
+        const Wire wire = wireTiming();
+        ssize_t n = ::read(_masterFd, buffer, std::min(len, wire.chunk));
+        if (n > 0) std::this_thread::sleep_until(reserve(_rxIdle, n, wire.byteTime));
+        return n;
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // 限速粒度：每段约 1ms 的线路时间（至少 1 字节），限制休眠次数
+    static constexpr auto kChunkTime = std::chrono::milliseconds(1);
+
+    struct Wire {
+        Clock::duration byteTime;
+        size_t chunk;
+    };
+
+    Wire wireTiming() const {
+        const int baud = std::max(baudRate(), 1);
+        const auto byteTime = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(static_cast<double>(kBitsPerByte) / baud));
+        const size_t chunk = static_cast<size_t>(std::max<Clock::rep>(kChunkTime / std::max(byteTime, Clock::duration(1)), 1));
+        return {byteTime, chunk};
+    }
+
+    // 占用线路传输 len 字节，返回传输完成的时刻
+    // 线路空闲超过一个限速粒度时从当前时刻开始；否则紧接上一段（休眠的超时不累积为速率误差）
+    static Clock::time_point reserve(Clock::time_point& idle, size_t len, Clock::duration byteTime) {
+        const auto now = Clock::now();
+        const auto start = idle + kChunkTime < now ? now : idle;
+        idle = start + byteTime * static_cast<Clock::rep>(len);
+        return idle;
+    }
+
+    bool writeAll(const uint8_t* data, size_t len) {
+        while (len > 0) {
+            ssize_t n = ::write(_masterFd, data, len);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            data += n;
+            len -= n;
+        }
+        return true;
+    }
+
+    int _masterFd = -1;
+    int _slaveFd = -1;
+    std::string _slavePath;
+    bool _pacing = false;
+    Clock::time_point _txIdle{};
+    Clock::time_point _rxIdle{};
+};
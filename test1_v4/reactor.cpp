@@ -0,0 +1,72 @@
+// reactor.cpp
+#include "reactor.h"
+#include "logrecord.h"
+#include <thread>
+
+size_t& Reactor::configuredLoops() {
+    static size_t numLoops = 0;
+    return numLoops;
+}
+
+Reactor::Backend& Reactor::configuredBackend() {
+    static Backend backend = Backend::Epoll;
+    return backend;
+}
+
+void Reactor::init(size_t numLoops, Backend backend) {
+    configuredLoops() = numLoops;
+    configuredBackend() = backend;
+}
+
+bool Reactor::parseBackend(const std::string& name, Backend& backend) {
+    if (name == "epoll") {
+        backend = Backend::Epoll;
+    } else if (name == "io_uring" || name == "uring") {
+        backend = Backend::IoUring;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+Reactor& Reactor::getInstance() {
+    static Reactor instance(configuredLoops(), configuredBackend());
+    return instance;
+}
+
+Reactor::Reactor(size_t numLoops, Backend backend) {
+    if (numLoops == 0) {
+        numLoops = std::thread::hardware_concurrency();
+        if (numLoops == 0) numLoops = 1;
+    }
+
+    size_t uringLoops = 0;
+    for (size_t i = 0; i < numLoops; ++i) {
+        _loops.push_back(std::make_unique<EventLoop>(i, backend == Backend::IoUring));
+        if (_loops.back()->hasIoUring()) ++uringLoops;
+        _loops.back()->start();
+    }
+    if (backend == Backend::IoUring) {
+        LOG_INFO("Reactor started with %zu event loops (io_uring on %zu)", numLoops, uringLoops);
+    } else {
+        LOG_INFO("Reactor started with %zu event loops", numLoops);
+    }
+}
+
+Reactor::~Reactor() {
+    shutdown();
+}
+
+EventLoop* Reactor::nextLoop() {
+    return _loops[_next.fetch_add(1, std::memory_order_relaxed) % _loops.size()].get();
+}
+
+EventLoop* Reactor::getLoop(size_t index) {
+    return _loops[index % _loops.size()].get();
+}
+
+void Reactor::shutdown() {
+    for (auto& loop : _loops) {
+        loop->stop();
+    }
+}
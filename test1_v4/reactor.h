@@ -0,0 +1,43 @@
+// reactor.h
+#pragma once
+#include "event_loop.h"
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <cstddef>
+#include <string>
+
+// 共享的多线程 Reactor：固定数量的 EventLoop 线程，端点按通道分片注册到各个循环
+class Reactor {
+public:
+    // 获取单例实例（首次调用时按配置的线程数创建并启动事件循环）
+    static Reactor& getInstance();
+
+    // I/O 后端：epoll 就绪通知 + 同步读写，或 io_uring 多发接收 + 异步数据报发送
+    enum class Backend { Epoll, IoUring };
+
+    // 配置事件循环线程数与 I/O 后端，需在首次 getInstance() 之前调用；0 表示使用 CPU 核心数
+    static void init(size_t numLoops, Backend backend = Backend::Epoll);
+    // 解析后端名称（"epoll" / "io_uring"），无法识别时返回 false
+    static bool parseBackend(const std::string& name, Backend& backend);
+
+    // 轮询分配一个事件循环（用于通道分片）
+    EventLoop* nextLoop();
+    EventLoop* getLoop(size_t index);
+    size_t size() const { return _loops.size(); }
+
+    void shutdown();
+
+private:
+    Reactor(size_t numLoops, Backend backend);
+    ~Reactor();
+
+    Reactor(const Reactor&) = delete;
+    Reactor& operator=(const Reactor&) = delete;
+
+    static size_t& configuredLoops();
+    static Backend& configuredBackend();
+
+    std::vector<std::unique_ptr<EventLoop>> _loops;
+    std::atomic<size_t> _next{0};
+};
@@ -1,89 +1,232 @@
 // ring_buffer.h
 #pragma once
 #include <vector>
-#include <mutex>
 #include <atomic>
 #include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <sys/uio.h>
 
+// 单生产者/单消费者(SPSC)无锁环形缓冲区
+// - 生产者: 端点的数据回调线程
+// - 消费者: 转发任务（由 forwarding_task_active_ 保证同一时刻只有一个）
+// head_/tail_ 为单调递增的字节计数，容量为2的幂，下标通过掩码取得
+// 字节流（push / peek / consume）与帧记录（pushRecord / peekRecord / consumeRecord）两种用法，
+// 同一缓冲区只使用其中一种
 class RingBuffer {
 public:
+    static constexpr size_t kCacheLine = 64;
+    // 帧记录头：帧长度（uint32_t，本机字节序）
+    static constexpr size_t kRecordHeader = sizeof(uint32_t);
+
     explicit RingBuffer(size_t capacity)
-        : buffer_(capacity), capacity_(capacity), 
-          read_pos_(0), write_pos_(0), count_(0),
-          shutdown_(false) {}
+        : capacity_(roundUpPow2(capacity)), mask_(capacity_ - 1),
+          buffer_(capacity_) {}
+
+    RingBuffer(const RingBuffer&) = delete;
+    RingBuffer& operator=(const RingBuffer&) = delete;
 
-    // 非阻塞写入
+    // 非阻塞写入（仅生产者调用），空间不足时整体失败
     bool push(const uint8_t* data, size_t size) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        
-        if (shutdown_ || size > capacity_ - count_) {
-            return false; // 已关闭或空间不足
+        if (shutdown_.load(std::memory_order_relaxed)) {
+            return false;
         }
 
-        // 分两部分写入（处理回绕）
-        size_t first_part = std::min(size, capacity_ - write_pos_);
-        std::copy(data, data + first_part, buffer_.begin() + write_pos_);
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (!hasSpace(head, size)) {
+            return false; // 空间不足
+        }
 
-        if (size > first_part) {
-            size_t second_part = size - first_part;
-            std::copy(data + first_part, data + size, buffer_.begin());
-            write_pos_ = second_part;
-        } else {
-            write_pos_ += first_part;
-            if (write_pos_ >= capacity_) write_pos_ -= capacity_;
+        copyIn(head, data, size);
+        head_.store(head + size, std::memory_order_release);
+        return true;
+    }
+
+    // 写入一条帧记录（仅生产者调用）：记录头与帧数据一次发布，消费者不会看到不完整的记录
+    // 空间不足时整体失败；空帧不写入
+    bool pushRecord(const uint8_t* data, size_t size) {
+        if (shutdown_.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        if (size == 0) {
+            return true;
+        }
+
+        const size_t head = head_.load(std::memory_order_relaxed);
+        const size_t total = kRecordHeader + size;
+        if (size > UINT32_MAX || !hasSpace(head, total)) {
+            return false;
         }
 
-        count_ += size;
+        const uint32_t length = static_cast<uint32_t>(size);
+        copyIn(head, reinterpret_cast<const uint8_t*>(&length), kRecordHeader);
+        copyIn(head + kRecordHeader, data, size);
+        head_.store(head + total, std::memory_order_release);
         return true;
     }
 
-    // 非阻塞读取
+    // 非阻塞读取（仅消费者调用）
     size_t pop(uint8_t* data, size_t max_size) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        
-        if (shutdown_ || count_ == 0) {
-            return 0; // 已关闭或无数据
+        if (shutdown_.load(std::memory_order_relaxed)) {
+            return 0;
         }
 
-        size_t to_read = std::min(count_, max_size);
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        size_t available = cached_head_ - tail;
+        if (available == 0) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            available = cached_head_ - tail;
+            if (available == 0) {
+                return 0; // 无数据
+            }
+        }
 
-        // 分两部分读取（处理回绕）
-        size_t first_part = std::min(to_read, capacity_ - read_pos_);
-        std::copy(buffer_.begin() + read_pos_, 
-                 buffer_.begin() + read_pos_ + first_part, 
-                 data);
+        const size_t to_read = std::min(available, max_size);
 
+        // 分两部分读取（处理回绕）
+        const size_t offset = tail & mask_;
+        const size_t first_part = std::min(to_read, capacity_ - offset);
+        std::memcpy(data, buffer_.data() + offset, first_part);
         if (to_read > first_part) {
-            size_t second_part = to_read - first_part;
-            std::copy(buffer_.begin(), buffer_.begin() + second_part, data + first_part);
-            read_pos_ = second_part;
-        } else {
-            read_pos_ += first_part;
-            if (read_pos_ >= capacity_) read_pos_ -= capacity_;
+            std::memcpy(data + first_part, buffer_.data(), to_read - first_part);
         }
 
-        count_ -= to_read;
+        tail_.store(tail + to_read, std::memory_order_release);
         return to_read;
     }
 
+    // 获取可读区域（仅消费者调用）：最多两段连续内存，不移动读位置
+    // 返回段数，total 为可读字节数（不超过 max_size）
+    int peek(struct iovec (&spans)[2], size_t& total,
+             size_t max_size = static_cast<size_t>(-1)) {
+        total = 0;
+        if (shutdown_.load(std::memory_order_relaxed)) {
+            return 0;
+        }
+
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        cached_head_ = head_.load(std::memory_order_acquire);
+        const size_t available = std::min(cached_head_ - tail, max_size);
+        if (available == 0) {
+            return 0;
+        }
+
+        total = available;
+        return spansAt(tail, available, spans);
+    }
+
+    // 获取队首帧记录的数据区域（仅消费者调用）：最多两段连续内存，不移动读位置
+    // 返回段数（0 表示没有记录），size 为帧长度
+    int peekRecord(struct iovec (&spans)[2], size_t& size) {
+        size = 0;
+        if (shutdown_.load(std::memory_order_relaxed)) {
+            return 0;
+        }
+
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        cached_head_ = head_.load(std::memory_order_acquire);
+        if (cached_head_ - tail < kRecordHeader) {
+            return 0;
+        }
+
+        uint32_t length;
+        copyOut(tail, reinterpret_cast<uint8_t*>(&length), kRecordHeader);
+        size = length;
+        return spansAt(tail + kRecordHeader, size, spans);
+    }
+
+    // 确认已处理队首的帧记录（仅消费者调用，size 为 peekRecord 返回的帧长度）
+    void consumeRecord(size_t size) {
+        consume(kRecordHeader + size);
+    }
+
+    // 确认已处理 size 字节（仅消费者调用，size 不得超过 peek 返回的字节数）
+    void consume(size_t size) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        tail_.store(tail + size, std::memory_order_release);
+    }
+
     // 检查是否为空
     bool empty() const {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return count_ == 0;
+        return head_.load(std::memory_order_acquire) ==
+               tail_.load(std::memory_order_acquire);
     }
 
+    // 当前已缓存字节数（近似值，任意线程可调用）
+    size_t size() const {
+        const size_t tail = tail_.load(std::memory_order_acquire);
+        const size_t head = head_.load(std::memory_order_acquire);
+        return head - tail;
+    }
+
+    size_t capacity() const { return capacity_; }
+
     // 关闭缓冲区
     void shutdown() {
-        std::lock_guard<std::mutex> lock(mutex_);
-        shutdown_ = true;
+        shutdown_.store(true, std::memory_order_relaxed);
     }
 
 private:
+    // 生产者：写位置 head 之后是否有 size 字节空间（缓存的读位置过旧时重新读取一次）
+    bool hasSpace(size_t head, size_t size) {
+        if (size <= capacity_ - (head - cached_tail_)) {
+            return true;
+        }
+        cached_tail_ = tail_.load(std::memory_order_acquire);
+        return size <= capacity_ - (head - cached_tail_);
+    }
+
+    // 分两部分复制（处理回绕），pos 为单调递增的字节位置
+    void copyIn(size_t pos, const uint8_t* data, size_t size) {
+        const size_t offset = pos & mask_;
+        const size_t first_part = std::min(size, capacity_ - offset);
+        std::memcpy(buffer_.data() + offset, data, first_part);
+        if (size > first_part) {
+            std::memcpy(buffer_.data(), data + first_part, size - first_part);
+        }
+    }
+
+    void copyOut(size_t pos, uint8_t* data, size_t size) const {
+        const size_t offset = pos & mask_;
+        const size_t first_part = std::min(size, capacity_ - offset);
+        std::memcpy(data, buffer_.data() + offset, first_part);
+        if (size > first_part) {
+            std::memcpy(data + first_part, buffer_.data(), size - first_part);
+        }
+    }
+
+    // 从 pos 开始的 size 字节对应的连续内存段（最多两段），返回段数
+    int spansAt(size_t pos, size_t size, struct iovec (&spans)[2]) {
+        const size_t offset = pos & mask_;
+        const size_t first_part = std::min(size, capacity_ - offset);
+        spans[0].iov_base = buffer_.data() + offset;
+        spans[0].iov_len = first_part;
+        if (size > first_part) {
+            spans[1].iov_base = buffer_.data();
+            spans[1].iov_len = size - first_part;
+            return 2;
+        }
+        return 1;
+    }
+
+    static size_t roundUpPow2(size_t v) {
+        size_t n = 1;
+        while (n < v) n <<= 1;
+        return n;
+    }
+
+    const size_t capacity_;
+    const size_t mask_;
     std::vector<uint8_t> buffer_;
-    size_t capacity_;
-    size_t read_pos_;
-    size_t write_pos_;
-    size_t count_;
-    mutable std::mutex mutex_;
-    bool shutdown_ = false;
-};
\ No newline at end of file
+    std::atomic<bool> shutdown_{false};
+
+    // 生产者独占的缓存行：写位置 + 缓存的读位置
+    alignas(kCacheLine) std::atomic<size_t> head_{0};
+    size_t cached_tail_ = 0;
+
+    // 消费者独占的缓存行：读位置 + 缓存的写位置
+    // （对象大小按 alignas 向上取整到缓存行，其后的对象不会与该行共用）
+    alignas(kCacheLine) std::atomic<size_t> tail_{0};
+    size_t cached_head_ = 0;
+};
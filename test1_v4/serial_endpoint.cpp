@@ -3,8 +3,26 @@
 #include <fcntl.h>
 #include <cstring>
 #include <stdexcept>
+#include <algorithm>
 #include <asm/termbits.h>
+#include <linux/serial.h>
 #include <sys/ioctl.h>
+#include <sys/uio.h>
+
+namespace {
+// 8N1：每字节 10 位
+constexpr uint64_t kBitsPerByte = 10;
+// 读缓冲区容纳约 20ms 的线路数据：高波特率下每次唤醒用更少的 read 取空终端缓冲区
+constexpr uint64_t kReadWindowMs = 20;
+constexpr size_t kMinReadSize = 256;
+// 终端行规程缓冲区大小（N_TTY_BUF_SIZE），单次 read 不会超过
+constexpr size_t kMaxReadSize = 4096;
+
+size_t readBufferSize(int baudrate) {
+    const uint64_t bytes = static_cast<uint64_t>(std::max(baudrate, 0)) / kBitsPerByte * kReadWindowMs / 1000;
+    return std::clamp<size_t>(bytes, kMinReadSize, kMaxReadSize);
+}
+} // namespace
 
 SerialEndpoint::SerialEndpoint(const std::string& device, int baudrate)
     : _device(device), _baudrate(baudrate) {}
@@ -13,6 +31,19 @@ SerialEndpoint::~SerialEndpoint() {
     close();
 }
 
+void SerialEndpoint::setReceiveOptions(bool lowLatency, uint32_t vmin, uint32_t vtime) {
+    _lowLatency = lowLatency;
+    _vmin = static_cast<uint8_t>(std::min<uint32_t>(vmin, 255));
+    _vtime = static_cast<uint8_t>(std::min<uint32_t>(vtime, 255));
+}
+
+void SerialEndpoint::fillStats(EndpointStats& stats) const {
+    Endpoint::fillStats(stats);
+    stats.rx_wakeups = _rxWakeups.load(std::memory_order_relaxed);
+    stats.rx_reads = _rxReads.load(std::memory_order_relaxed);
+    stats.rx_drain_time = _rxDrainTime.summary();
+}
+
 bool SerialEndpoint::open() {
     if (isRunning()) return true;
     
@@ -29,45 +60,37 @@ bool SerialEndpoint::open() {
         _serialFd = -1;
         return false;
     }
-    
-    // 创建epoll实例
-    _epollFd = epoll_create1(0);
-    if (_epollFd < 0) {
-        logError("Epoll creation failed: " + std::string(strerror(errno)));
-        ::close(_serialFd);
-        _serialFd = -1;
-        return false;
-    }
-    
-    // 添加串口到epoll
-    epoll_event event{};
-    event.events = EPOLLIN;
-    event.data.fd = _serialFd;
-    if (epoll_ctl(_epollFd, EPOLL_CTL_ADD, _serialFd, &event) < 0) {
+    if (_lowLatency) enableLowLatency();
+
+    _readBuffer.resize(readBufferSize(_baudrate));
+    _byteTimeNs = _baudrate > 0 ? kBitsPerByte * 1000000000ull / _baudrate : 0;
+    
+    // 注册到事件循环
+    if (!getEventLoop()->addFd(_serialFd, readEvents(), [this](uint32_t events) {
+            if (events & EPOLLOUT) handleWritable();
+            if (events & EPOLLIN) handleSerialData();
+        })) {
         logError("Epoll_ctl failed: " + std::string(strerror(errno)));
-        ::close(_epollFd);
         ::close(_serialFd);
-        _epollFd = -1;
         _serialFd = -1;
         return false;
     }
     
+    _running = true;
     setState(State::CONNECTED);
-    startThread();
     return true;
 }
 
 void SerialEndpoint::close() {
-    stopThread();
-    
-    if (_epollFd >= 0) {
-        ::close(_epollFd);
-        _epollFd = -1;
-    }
+    if (!_running.exchange(false)) return;
     
+    // 注销后事件循环不会再回调本端点
     if (_serialFd >= 0) {
+        getEventLoop()->removeFd(_serialFd);
+        std::lock_guard<std::mutex> lock(_mutex);
         ::close(_serialFd);
         _serialFd = -1;
+        _writeBlocked = false;
     }
     
     setState(State::DISCONNECTED);
@@ -83,6 +106,47 @@ void SerialEndpoint::write(const uint8_t* data, size_t len) {
     }
 }
 
+ssize_t SerialEndpoint::writev(const struct iovec* iov, int iovcnt) {
+    const size_t total = iovLength(iov, iovcnt);
+    if (!isConnected()) return -1;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    ssize_t written = ::writev(_serialFd, iov, iovcnt);
+    if (written < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            logError("Serial write failed: " + std::string(strerror(errno)));
+            setState(State::ERROR);
+            return -1;
+        }
+        written = 0;
+    }
+
+    // 发送缓冲区已满：注册 EPOLLOUT，可写后通知调用方继续
+    if (static_cast<size_t>(written) < total && !_writeBlocked) {
+        _writeBlocked = getEventLoop()->modifyFd(_serialFd, readEvents() | EPOLLOUT);
+    }
+    return written;
+}
+
+void SerialEndpoint::handleWritable() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_writeBlocked) return;
+        getEventLoop()->modifyFd(_serialFd, readEvents());
+        _writeBlocked = false;
+    }
+    notifyWritable();
+}
+
+void SerialEndpoint::updateReadInterest() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_serialFd < 0) return;
+
+    uint32_t events = readEvents();
+    if (_writeBlocked) events |= EPOLLOUT;
+    getEventLoop()->modifyFd(_serialFd, events);
+}
+
 bool SerialEndpoint::configureSerialPort() {
     termios2 tty{};
     if (ioctl(_serialFd, TCGETS2, &tty) != 0) {
@@ -110,14 +174,16 @@ bool SerialEndpoint::configureSerialPort() {
     
     // 禁用软件流控
     tty.c_iflag &= ~(IXON | IXOFF | IXANY);
+    // 二进制透传：不转换 CR/LF、不剥离第 8 位、不处理 BREAK / 校验标记
+    tty.c_iflag &= ~(IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR | IGNCR | ICRNL);
     
     // 原始输入模式
     tty.c_lflag = 0;
     tty.c_oflag = 0;
     
-    // 特殊字符处理
-    tty.c_cc[VMIN] = 0;
-    tty.c_cc[VTIME] = 10; // 1秒超时
+    // 非阻塞读取：VTIME 为 0 且 VMIN > 0 时，终端缓冲区积累 VMIN 字节才产生读事件
+    tty.c_cc[VMIN] = _vmin;
+    tty.c_cc[VTIME] = _vtime;
     
     if (ioctl(_serialFd, TCSETS2, &tty) != 0) {
         logError("Set serial config failed: " + std::string(strerror(errno)));
@@ -127,33 +193,42 @@ bool SerialEndpoint::configureSerialPort() {
     return true;
 }
 
-void SerialEndpoint::run() {
-    epoll_event events[2];
-    while (isRunning()) {
-        int numEvents = epoll_wait(_epollFd, events, 2, 100);
-        if (numEvents < 0) {
-            if (errno != EINTR) {
-                logError("Epoll_wait error: " + std::string(strerror(errno)));
-            }
-            continue;
-        }
-        
-        for (int i = 0; i < numEvents; ++i) {
-            if (events[i].events & EPOLLIN) {
-                handleSerialData();
-            }
-        }
+void SerialEndpoint::enableLowLatency() {
+    // 不支持的驱动（如伪终端）只记录日志，按默认延迟继续工作
+    serial_struct serial{};
+    if (ioctl(_serialFd, TIOCGSERIAL, &serial) != 0) {
+        logMessage("Low latency mode not supported: " + std::string(strerror(errno)));
+        return;
+    }
+    serial.flags |= ASYNC_LOW_LATENCY;
+    if (ioctl(_serialFd, TIOCSSERIAL, &serial) != 0) {
+        logMessage("Set low latency mode failed: " + std::string(strerror(errno)));
     }
 }
 
 void SerialEndpoint::handleSerialData() {
-    uint8_t buffer[256];
-    ssize_t bytesRead = read(_serialFd, buffer, sizeof(buffer));
-    
-    if (bytesRead > 0) {
-        processData(buffer, bytesRead);
-    } else if (bytesRead < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
-        logError("Serial read error: " + std::string(strerror(errno)));
-        setState(State::ERROR);
+    _rxWakeups.fetch_add(1, std::memory_order_relaxed);
+
+    // 一次唤醒读到 EAGAIN，取空终端缓冲区（读暂停后停止，剩余数据留在内核中）
+    size_t drained = 0;
+    while (!isReadPaused()) {
+        ssize_t bytesRead = read(_serialFd, _readBuffer.data(), _readBuffer.size());
+        _rxReads.fetch_add(1, std::memory_order_relaxed);
+
+        if (bytesRead > 0) {
+            drained += bytesRead;
+            processData(_readBuffer.data(), bytesRead);
+            continue;
+        }
+        if (bytesRead < 0 && errno == EINTR) continue;
+        if (bytesRead < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+            logError("Serial read error: " + std::string(strerror(errno)));
+            setState(State::ERROR);
+        }
+        break;
     }
+
+    // 本次取出的数据按波特率换算的线路时间（批量大小，不是测得的延迟）
+    // 驱动延迟定时器、VMIN 批量唤醒越长，每次取出的数据越多
+    if (drained > 0) _rxDrainTime.record(drained * _byteTimeNs);
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
 #pragma once
 #include "endpoint.h"
+#include "latency_histogram.h"
+#include <vector>
 #include <sys/epoll.h>
 
 class SerialEndpoint : public Endpoint {
@@ -10,14 +12,33 @@ public:
     bool open() override;
     void close() override;
     void write(const uint8_t* data, size_t len) override;
+    ssize_t writev(const struct iovec* iov, int iovcnt) override;
+
+    // 接收参数（需在 open() 之前设置）：lowLatency 设置驱动的 ASYNC_LOW_LATENCY 标志，
+    // vmin / vtime 写入终端配置（上限 255）
+    void setReceiveOptions(bool lowLatency, uint32_t vmin, uint32_t vtime);
+    void fillStats(EndpointStats& stats) const override;
 
 private:
-    void run() override;
     bool configureSerialPort();
+    void enableLowLatency();
     void handleSerialData();
+    void handleWritable();
+    void updateReadInterest() override;
 
     const std::string _device;
     const int _baudrate;
     int _serialFd = -1;
-    int _epollFd = -1;
+    bool _writeBlocked = false; // 已注册 EPOLLOUT 等待可写（受 _mutex 保护）
+
+    bool _lowLatency = false;
+    uint8_t _vmin = 0;
+    uint8_t _vtime = 0;
+    std::vector<uint8_t> _readBuffer; // 按波特率确定大小（open 时分配）
+    uint64_t _byteTimeNs = 0;         // 每字节线路时间（8N1）
+
+    // 接收统计（事件循环线程写入，统计线程读取）
+    std::atomic<uint64_t> _rxWakeups{0};
+    std::atomic<uint64_t> _rxReads{0};
+    LatencyHistogram _rxDrainTime; // 每次读事件取出的数据的线路时间
 };
\ No newline at end of file
@@ -12,6 +12,28 @@ struct EndpointConfig {
     // 串口专用字段
     std::string serial_port;
     uint32_t baud_rate = 0;
+    // 低延迟接收：TIOCSSERIAL 设置 ASYNC_LOW_LATENCY（驱动支持时，如 USB 转串口的 1ms 延迟定时器）
+    bool low_latency = false;
+    // 终端 VMIN / VTIME（默认 0）：非阻塞读取下 VTIME 为 0 时，积累 VMIN 字节才产生读事件（减少唤醒，增加延迟）
+    uint32_t vmin = 0;
+    uint32_t vtime = 0;
+
+    // TCP客户端发送队列水位（字节，0 表示默认值）
+    uint32_t write_high_watermark = 0;
+    uint32_t write_low_watermark = 0;
+
+    // UDP服务端客户端空闲超时（秒，0 表示默认值）
+    uint32_t client_idle_timeout = 0;
+
+    // 报文分帧（本端点作为源时）：""/"none" 字节流；"length" 长度前缀；"delimiter" 分隔符；"fixed" 定长；"gap" 字符间隔
+    std::string framing;
+    uint32_t frame_length_offset = 0; // length：长度字段在帧内的偏移
+    uint32_t frame_length_size = 0;   // length：长度字段字节数 1 / 2 / 4（大端，0 表示 2）
+    int32_t frame_length_adjust = 0;  // length：帧长度 = 偏移 + 字段字节数 + 字段值 + 调整值
+    std::string frame_delimiter;      // delimiter：分隔符
+    uint32_t frame_size = 0;          // fixed：帧长度
+    uint32_t frame_gap_us = 0;        // gap：帧间隔（微秒，0 表示 3.5 个字符时间，19200 以上为 1750）
+    uint32_t max_frame_size = 0;      // 帧长度上限（0 表示 64KB）
 
     // 添加比较运算符
     bool operator==(const EndpointConfig& other) const {
@@ -19,7 +41,21 @@ struct EndpointConfig {
                port == other.port &&
                ip == other.ip &&
                serial_port == other.serial_port &&
-               baud_rate == other.baud_rate;
+               baud_rate == other.baud_rate &&
+               low_latency == other.low_latency &&
+               vmin == other.vmin &&
+               vtime == other.vtime &&
+               write_high_watermark == other.write_high_watermark &&
+               write_low_watermark == other.write_low_watermark &&
+               client_idle_timeout == other.client_idle_timeout &&
+               framing == other.framing &&
+               frame_length_offset == other.frame_length_offset &&
+               frame_length_size == other.frame_length_size &&
+               frame_length_adjust == other.frame_length_adjust &&
+               frame_delimiter == other.frame_delimiter &&
+               frame_size == other.frame_size &&
+               frame_gap_us == other.frame_gap_us &&
+               max_frame_size == other.max_frame_size;
     }
     
     bool operator!=(const EndpointConfig& other) const {
@@ -31,12 +67,25 @@ struct ChannelConfig {
     std::string name;
     EndpointConfig input;
     EndpointConfig output;
+    bool zero_copy = false; // TCP<->TCP 通道使用 splice 零拷贝转发
+    // 缓冲区满时的流控策略："backpressure" 暂停源端读取；"drop" 丢弃数据（适用于可丢失的遥测）
+    std::string flow_control = "backpressure";
+    // 通道日志级别："debug"（含报文日志）/ "info" / "warning" / "error" / "off"，运行时修改无需重建通道
+    std::string log_level = "debug";
+    // 协议转换："modbus_tcp_rtu"（NODE1 为 Modbus TCP，NODE2 为 Modbus RTU）/ "modbus_rtu_tcp"（相反），空表示透传
+    std::string conversion;
+    uint32_t modbus_timeout_ms = 0; // RTU 从站响应超时（0 = 默认 1000ms）
 
     // 添加比较运算符
     bool operator==(const ChannelConfig& other) const {
         return name == other.name &&
                input == other.input &&
-               output == other.output;
+               output == other.output &&
+               zero_copy == other.zero_copy &&
+               flow_control == other.flow_control &&
+               log_level == other.log_level &&
+               conversion == other.conversion &&
+               modbus_timeout_ms == other.modbus_timeout_ms;
     }
     
     bool operator!=(const ChannelConfig& other) const {
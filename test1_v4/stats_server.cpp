@@ -0,0 +1,570 @@
+// stats_server.cpp
+#include "stats_server.h"
+#include "channel_manager.h"
+#include "logrecord.h"
+#include <nlohmann/json.hpp>
+#include <cstring>
+#include <cstdio>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+namespace {
+constexpr size_t kMaxConnections = 32;
+constexpr size_t kMaxRequestSize = 8192;
+constexpr auto kIdleTimeout = std::chrono::seconds(10);
+constexpr auto kIdleCheckInterval = std::chrono::milliseconds(1000);
+
+const char* const kDirectionLabels[2] = {"node1_to_node2", "node2_to_node1"};
+const char* const kNodeLabels[2] = {"node1", "node2"};
+
+// 方向级指标：名称、类型、说明、取值字段
+struct DirectionMetric {
+    const char* name;
+    const char* type;
+    const char* help;
+    uint64_t DirectionStats::*field;
+};
+
+const DirectionMetric kDirectionMetrics[] = {
+    {"protocol_converter_channel_received_bytes_total", "counter",
+     "Bytes received from the source endpoint", &DirectionStats::bytes_in},
+    {"protocol_converter_channel_received_packets_total", "counter",
+     "Receive callbacks (splice calls in zero-copy mode)", &DirectionStats::packets_in},
+    {"protocol_converter_channel_forwarded_bytes_total", "counter",
+     "Bytes accepted by the target endpoint", &DirectionStats::bytes_out},
+    {"protocol_converter_channel_forwarded_packets_total", "counter",
+     "Successful writes to the target endpoint", &DirectionStats::packets_out},
+    {"protocol_converter_channel_drops_total", "counter",
+     "Drop events (buffer full or target busy)", &DirectionStats::drops},
+    {"protocol_converter_channel_dropped_bytes_total", "counter",
+     "Bytes dropped", &DirectionStats::dropped_bytes},
+    {"protocol_converter_channel_ring_high_water_bytes", "gauge",
+     "Highest buffer occupancy since start", &DirectionStats::ring_high_water},
+    {"protocol_converter_channel_forward_runs_total", "counter",
+     "Forwarding task runs", &DirectionStats::forward_runs},
+    {"protocol_converter_channel_write_blocked_total", "counter",
+     "Writes stopped by EAGAIN or a partial write", &DirectionStats::write_blocked},
+    {"protocol_converter_channel_write_errors_total", "counter",
+     "Errors reported by the target endpoint or the forwarding task", &DirectionStats::write_errors},
+};
+
+// 端点级指标：只对 types 中列出的端点类型输出（nullptr 表示全部）
+struct EndpointMetric {
+    const char* name;
+    const char* type;
+    const char* help;
+    const char* endpointType;
+    uint64_t (*value)(const EndpointStats&);
+};
+
+const EndpointMetric kEndpointMetrics[] = {
+    {"protocol_converter_endpoint_connected", "gauge", "1 if the endpoint is connected",
+     nullptr, [](const EndpointStats& s) -> uint64_t { return s.connected ? 1 : 0; }},
+    {"protocol_converter_endpoint_clients", "gauge", "Connected TCP clients",
+     "tcp_server", [](const EndpointStats& s) { return s.clients; }},
+    {"protocol_converter_endpoint_accepted_connections_total", "counter", "Accepted TCP connections",
+     "tcp_server", [](const EndpointStats& s) { return s.accepted; }},
+    {"protocol_converter_endpoint_reconnects_total", "counter", "TCP client reconnect attempts",
+     "tcp_client", [](const EndpointStats& s) { return s.reconnects; }},
+    {"protocol_converter_endpoint_write_queue_bytes", "gauge", "Bytes queued for sending",
+     "tcp_client", [](const EndpointStats& s) { return s.queued_bytes; }},
+    {"protocol_converter_endpoint_rx_wakeups_total", "counter", "Serial read events",
+     "serial", [](const EndpointStats& s) { return s.rx_wakeups; }},
+    {"protocol_converter_endpoint_rx_reads_total", "counter", "Serial read calls",
+     "serial", [](const EndpointStats& s) { return s.rx_reads; }},
+};
+
+// Modbus 转换指标：只对配置了 conversion 的通道输出
+struct ModbusMetric {
+    const char* name;
+    const char* help;
+    uint64_t ModbusStats::*field;
+};
+
+const ModbusMetric kModbusMetrics[] = {
+    {"protocol_converter_modbus_requests_total", "Modbus TCP requests received", &ModbusStats::requests},
+    {"protocol_converter_modbus_responses_total", "Modbus RTU responses forwarded", &ModbusStats::responses},
+    {"protocol_converter_modbus_timeouts_total", "Modbus RTU response timeouts", &ModbusStats::timeouts},
+    {"protocol_converter_modbus_crc_errors_total", "Modbus RTU frames failing CRC check", &ModbusStats::crc_errors},
+    {"protocol_converter_modbus_exceptions_total", "Exception responses generated by the gateway",
+     &ModbusStats::exceptions},
+};
+
+// Prometheus 标签值转义：反斜杠、双引号、换行
+void appendLabelValue(std::string& out, const std::string& value) {
+    for (char c : value) {
+        switch (c) {
+            case '\\': out += "\\\\"; break;
+            case '"':  out += "\\\""; break;
+            case '\n': out += "\\n"; break;
+            default:   out += c; break;
+        }
+    }
+}
+
+void appendHeader(std::string& out, const char* name, const char* type, const char* help) {
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += ' ';
+    out += type;
+    out += '\n';
+}
+
+void appendValue(std::string& out, uint64_t value) {
+    char buffer[24];
+    int len = snprintf(buffer, sizeof(buffer), " %llu\n", static_cast<unsigned long long>(value));
+    out.append(buffer, len);
+}
+
+// 纳秒 -> 秒（Prometheus 时间单位）
+void appendSeconds(std::string& out, uint64_t ns) {
+    char buffer[32];
+    int len = snprintf(buffer, sizeof(buffer), " %.9g\n", static_cast<double>(ns) / 1e9);
+    out.append(buffer, len);
+}
+
+void appendChannelLabel(std::string& out, const char* name, const std::string& channel) {
+    out += name;
+    out += "{channel=\"";
+    appendLabelValue(out, channel);
+    out += '"';
+}
+
+void appendDirectionLabels(std::string& out, const char* name, const std::string& channel, int direction) {
+    appendChannelLabel(out, name, channel);
+    out += ",direction=\"";
+    out += kDirectionLabels[direction];
+    out += '"';
+}
+
+void appendEndpointLabels(std::string& out, const char* name, const std::string& channel, int node,
+                          const std::string& type) {
+    appendChannelLabel(out, name, channel);
+    out += ",node=\"";
+    out += kNodeLabels[node];
+    out += "\",type=\"";
+    appendLabelValue(out, type);
+    out += '"';
+}
+
+// 串口每次读事件取出的数据的线路时间：summary（p50 / p99 / p99.9 + sum / count），只输出串口端点
+void appendReceiveDrainTime(std::string& out, const std::vector<ChannelStats>& channels) {
+    static const char* const kSummary = "protocol_converter_endpoint_rx_drain_wire_seconds";
+    static const char* const kQuantiles[3] = {"0.5", "0.99", "0.999"};
+
+    appendHeader(out, kSummary, "summary", "Wire time of the data drained per serial read event (bytes drained x byte time at the configured baud rate)");
+    for (const ChannelStats& channel : channels) {
+        for (int i = 0; i < 2; ++i) {
+            const EndpointStats& endpoint = channel.endpoints[i];
+            if (endpoint.type != "serial") continue;
+            const LatencySummary& latency = endpoint.rx_drain_time;
+            const uint64_t values[3] = {latency.p50, latency.p99, latency.p999};
+            for (int q = 0; q < 3; ++q) {
+                appendEndpointLabels(out, kSummary, channel.name, i, endpoint.type);
+                out += ",quantile=\"";
+                out += kQuantiles[q];
+                out += "\"}";
+                appendSeconds(out, values[q]);
+            }
+            out += kSummary;
+            out += "_sum";
+            appendEndpointLabels(out, "", channel.name, i, endpoint.type);
+            out += '}';
+            appendSeconds(out, latency.sum);
+            out += kSummary;
+            out += "_count";
+            appendEndpointLabels(out, "", channel.name, i, endpoint.type);
+            out += '}';
+            appendValue(out, latency.count);
+        }
+    }
+}
+
+// 转发延迟：summary（p50 / p99 / p99.9 + sum / count）与最大值
+void appendLatency(std::string& out, const std::vector<ChannelStats>& channels) {
+    static const char* const kSummary = "protocol_converter_channel_forward_latency_seconds";
+    static const char* const kMax = "protocol_converter_channel_forward_latency_max_seconds";
+    static const char* const kQuantiles[3] = {"0.5", "0.99", "0.999"};
+
+    appendHeader(out, kSummary, "summary", "Receive callback to target write latency");
+    for (const ChannelStats& channel : channels) {
+        for (int i = 0; i < 2; ++i) {
+            const LatencySummary& latency = channel.directions[i].latency;
+            const uint64_t values[3] = {latency.p50, latency.p99, latency.p999};
+            for (int q = 0; q < 3; ++q) {
+                appendDirectionLabels(out, kSummary, channel.name, i);
+                out += ",quantile=\"";
+                out += kQuantiles[q];
+                out += "\"}";
+                appendSeconds(out, values[q]);
+            }
+            out += kSummary;
+            out += "_sum";
+            appendDirectionLabels(out, "", channel.name, i);
+            out += '}';
+            appendSeconds(out, latency.sum);
+            out += kSummary;
+            out += "_count";
+            appendDirectionLabels(out, "", channel.name, i);
+            out += '}';
+            appendValue(out, latency.count);
+        }
+    }
+
+    appendHeader(out, kMax, "gauge", "Highest receive to target write latency since start");
+    for (const ChannelStats& channel : channels) {
+        for (int i = 0; i < 2; ++i) {
+            appendDirectionLabels(out, kMax, channel.name, i);
+            out += '}';
+            appendSeconds(out, channel.directions[i].latency.max);
+        }
+    }
+}
+
+std::string httpResponse(const char* status, const char* contentType, const std::string& body) {
+    std::string response = "HTTP/1.1 ";
+    response += status;
+    response += "\r\nContent-Type: ";
+    response += contentType;
+    response += "\r\nContent-Length: ";
+    response += std::to_string(body.size());
+    response += "\r\nConnection: close\r\n\r\n";
+    response += body;
+    return response;
+}
+} // namespace
+
+StatsServer::StatsServer(ChannelManager& manager) : manager_(manager) {}
+
+StatsServer::~StatsServer() {
+    stop();
+}
+
+bool StatsServer::start(const std::string& address) {
+    const bool ok = address.compare(0, 5, "unix:") == 0
+        ? listenUnix(address.substr(5))
+        : listenTcp(static_cast<uint16_t>(std::strtoul(address.c_str(), nullptr, 10)));
+    if (!ok) return false;
+
+    loop_.start();
+    if (!loop_.addFd(listen_fd_, EPOLLIN, [this](uint32_t) { handleAccept(); })) {
+        LOG_ERROR("Stats server: epoll_ctl failed: %s", strerror(errno));
+        stop();
+        return false;
+    }
+    idle_timer_ = loop_.runEvery(kIdleCheckInterval, [this] { closeIdleConnections(); });
+    LOG_INFO("Stats server listening on %s (GET /metrics, GET /stats)",
+             unix_path_.empty() ? ("127.0.0.1:" + address).c_str() : unix_path_.c_str());
+    return true;
+}
+
+void StatsServer::stop() {
+    if (listen_fd_ < 0) return;
+
+    loop_.runAndWait([this] {
+        if (idle_timer_) {
+            loop_.cancelTimer(idle_timer_);
+            idle_timer_ = 0;
+        }
+        while (!connections_.empty()) {
+            closeConnection(connections_.begin()->first);
+        }
+        loop_.removeFd(listen_fd_);
+    });
+    loop_.stop();
+
+    ::close(listen_fd_);
+    listen_fd_ = -1;
+    if (!unix_path_.empty()) {
+        ::unlink(unix_path_.c_str());
+        unix_path_.clear();
+    }
+}
+
+bool StatsServer::listenTcp(uint16_t port) {
+    if (port == 0) {
+        LOG_ERROR("Stats server: invalid port");
+        return false;
+    }
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        LOG_ERROR("Stats server: socket failed: %s", strerror(errno));
+        return false;
+    }
+    int opt = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+    // 只监听回环地址
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || listen(fd, 16) < 0) {
+        LOG_ERROR("Stats server: cannot listen on 127.0.0.1:%u: %s", port, strerror(errno));
+        ::close(fd);
+        return false;
+    }
+    listen_fd_ = fd;
+    return true;
+}
+
+bool StatsServer::listenUnix(const std::string& path) {
+    sockaddr_un addr{};
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+        LOG_ERROR("Stats server: invalid unix socket path: %s", path.c_str());
+        return false;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        LOG_ERROR("Stats server: socket failed: %s", strerror(errno));
+        return false;
+    }
+
+    // 删除上次运行残留的套接字文件
+    ::unlink(path.c_str());
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.size());
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || listen(fd, 16) < 0) {
+        LOG_ERROR("Stats server: cannot listen on %s: %s", path.c_str(), strerror(errno));
+        ::close(fd);
+        return false;
+    }
+    listen_fd_ = fd;
+    unix_path_ = path;
+    return true;
+}
+
+void StatsServer::handleAccept() {
+    while (true) {
+        int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                LOG_WARNING("Stats server: accept failed: %s", strerror(errno));
+            }
+            return;
+        }
+        if (connections_.size() >= kMaxConnections) {
+            ::close(fd);
+            continue;
+        }
+        if (!loop_.addFd(fd, EPOLLIN | EPOLLRDHUP, [this, fd](uint32_t events) { handleConnection(fd, events); })) {
+            ::close(fd);
+            continue;
+        }
+        connections_[fd].lastActive = EventLoop::Clock::now();
+    }
+}
+
+void StatsServer::handleConnection(int fd, uint32_t events) {
+    auto it = connections_.find(fd);
+    if (it == connections_.end()) return;
+    Connection& connection = it->second;
+    connection.lastActive = EventLoop::Clock::now();
+
+    if (events & (EPOLLHUP | EPOLLERR)) {
+        closeConnection(fd);
+        return;
+    }
+    if (!connection.response.empty()) {
+        if (events & EPOLLOUT) flushResponse(fd, connection);
+        return;
+    }
+
+    char buffer[2048];
+    ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+    if (n <= 0) {
+        if (n < 0 && (errno == EAGAIN || errno == EINTR)) return;
+        closeConnection(fd);
+        return;
+    }
+    connection.request.append(buffer, n);
+    if (connection.request.find("\r\n\r\n") != std::string::npos ||
+        connection.request.find("\n\n") != std::string::npos) {
+        handleRequest(fd, connection);
+    } else if (connection.request.size() > kMaxRequestSize) {
+        closeConnection(fd);
+    }
+}
+
+void StatsServer::handleRequest(int fd, Connection& connection) {
+    // 请求行：GET <path>[?query] HTTP/1.x
+    const std::string& request = connection.request;
+    const size_t methodEnd = request.find(' ');
+    const size_t pathEnd = methodEnd == std::string::npos ? std::string::npos : request.find_first_of(" ?\r\n", methodEnd + 1);
+    const std::string method = request.substr(0, methodEnd);
+    const std::string path = pathEnd == std::string::npos ? "" : request.substr(methodEnd + 1, pathEnd - methodEnd - 1);
+
+    if (method != "GET") {
+        connection.response = httpResponse("405 Method Not Allowed", "text/plain", "Only GET is supported\n");
+    } else if (path == "/metrics") {
+        connection.response = httpResponse("200 OK", "text/plain; version=0.0.4; charset=utf-8",
+                                           renderPrometheus(takeSnapshot()));
+    } else if (path == "/stats" || path == "/stats.json") {
+        connection.response = httpResponse("200 OK", "application/json", renderJson(takeSnapshot()));
+    } else {
+        connection.response = httpResponse("404 Not Found", "text/plain", "Try /metrics or /stats\n");
+    }
+    connection.request.clear();
+    flushResponse(fd, connection);
+}
+
+void StatsServer::flushResponse(int fd, Connection& connection) {
+    while (connection.sent < connection.response.size()) {
+        ssize_t n = send(fd, connection.response.data() + connection.sent,
+                         connection.response.size() - connection.sent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                // 大响应（上千个通道）分多次发送，等待可写
+                loop_.modifyFd(fd, EPOLLOUT | EPOLLRDHUP);
+                return;
+            }
+            break;
+        }
+        connection.sent += n;
+    }
+    closeConnection(fd);
+}
+
+void StatsServer::closeConnection(int fd) {
+    loop_.removeFd(fd);
+    ::close(fd);
+    connections_.erase(fd);
+}
+
+void StatsServer::closeIdleConnections() {
+    const auto deadline = EventLoop::Clock::now() - kIdleTimeout;
+    for (auto it = connections_.begin(); it != connections_.end(); ) {
+        const int fd = it->first;
+        const bool idle = it->second.lastActive < deadline;
+        ++it;
+        if (idle) closeConnection(fd);
+    }
+}
+
+StatsSnapshot StatsServer::takeSnapshot() {
+    StatsSnapshot snapshot;
+    snapshot.channels = manager_.snapshot();
+    snapshot.pool_threads = manager_.getThreadPool().size();
+    snapshot.pool_queue_depth = manager_.getThreadPool().queueDepth();
+    return snapshot;
+}
+
+std::string StatsServer::renderPrometheus(const StatsSnapshot& snapshot) {
+    std::string out;
+    // 每个通道约 3KB 文本
+    out.reserve(1024 + snapshot.channels.size() * 3072);
+
+    appendHeader(out, "protocol_converter_thread_pool_threads", "gauge", "Forwarding worker threads");
+    out += "protocol_converter_thread_pool_threads";
+    appendValue(out, snapshot.pool_threads);
+    appendHeader(out, "protocol_converter_thread_pool_queue_depth", "gauge", "Queued forwarding tasks");
+    out += "protocol_converter_thread_pool_queue_depth";
+    appendValue(out, snapshot.pool_queue_depth);
+
+    appendHeader(out, "protocol_converter_channel_ring_capacity_bytes", "gauge", "Buffer capacity per direction");
+    for (const ChannelStats& channel : snapshot.channels) {
+        appendChannelLabel(out, "protocol_converter_channel_ring_capacity_bytes", channel.name);
+        out += '}';
+        appendValue(out, channel.ring_capacity);
+    }
+
+    for (const DirectionMetric& metric : kDirectionMetrics) {
+        appendHeader(out, metric.name, metric.type, metric.help);
+        for (const ChannelStats& channel : snapshot.channels) {
+            for (int i = 0; i < 2; ++i) {
+                appendDirectionLabels(out, metric.name, channel.name, i);
+                out += '}';
+                appendValue(out, channel.directions[i].*metric.field);
+            }
+        }
+    }
+
+    appendLatency(out, snapshot.channels);
+
+    for (const EndpointMetric& metric : kEndpointMetrics) {
+        appendHeader(out, metric.name, metric.type, metric.help);
+        for (const ChannelStats& channel : snapshot.channels) {
+            for (int i = 0; i < 2; ++i) {
+                const EndpointStats& endpoint = channel.endpoints[i];
+                if (metric.endpointType && endpoint.type != metric.endpointType) continue;
+                appendEndpointLabels(out, metric.name, channel.name, i, endpoint.type);
+                out += '}';
+                appendValue(out, metric.value(endpoint));
+            }
+        }
+    }
+
+    appendReceiveDrainTime(out, snapshot.channels);
+
+    for (const ModbusMetric& metric : kModbusMetrics) {
+        appendHeader(out, metric.name, "counter", metric.help);
+        for (const ChannelStats& channel : snapshot.channels) {
+            if (channel.conversion.empty()) continue;
+            appendChannelLabel(out, metric.name, channel.name);
+            out += '}';
+            appendValue(out, channel.modbus.*metric.field);
+        }
+    }
+    return out;
+}
+
+std::string StatsServer::renderJson(const StatsSnapshot& snapshot) {
+    nlohmann::json root;
+    root["thread_pool"] = {{"threads", snapshot.pool_threads}, {"queue_depth", snapshot.pool_queue_depth}};
+
+    nlohmann::json channels = nlohmann::json::array();
+    for (const ChannelStats& channel : snapshot.channels) {
+        nlohmann::json directions;
+        for (int i = 0; i < 2; ++i) {
+            const DirectionStats& d = channel.directions[i];
+            directions[kDirectionLabels[i]] = {
+                {"bytes_in", d.bytes_in}, {"packets_in", d.packets_in},
+                {"bytes_out", d.bytes_out}, {"packets_out", d.packets_out},
+                {"drops", d.drops}, {"dropped_bytes", d.dropped_bytes},
+                {"ring_high_water", d.ring_high_water}, {"forward_runs", d.forward_runs},
+                {"write_blocked", d.write_blocked}, {"write_errors", d.write_errors},
+                {"latency_ns", {{"count", d.latency.count}, {"p50", d.latency.p50}, {"p99", d.latency.p99},
+                                {"p999", d.latency.p999}, {"max", d.latency.max}}},
+            };
+        }
+        nlohmann::json endpoints;
+        for (int i = 0; i < 2; ++i) {
+            const EndpointStats& e = channel.endpoints[i];
+            nlohmann::json endpoint = {{"type", e.type}, {"connected", e.connected}};
+            if (e.type == "tcp_server") {
+                endpoint["clients"] = e.clients;
+                endpoint["accepted"] = e.accepted;
+            } else if (e.type == "tcp_client") {
+                endpoint["reconnects"] = e.reconnects;
+                endpoint["queued_bytes"] = e.queued_bytes;
+            } else if (e.type == "serial") {
+                endpoint["rx_wakeups"] = e.rx_wakeups;
+                endpoint["rx_reads"] = e.rx_reads;
+                endpoint["rx_drain_wire_ns"] = {{"count", e.rx_drain_time.count}, {"p50", e.rx_drain_time.p50},
+                                                {"p99", e.rx_drain_time.p99}, {"p999", e.rx_drain_time.p999},
+                                                {"max", e.rx_drain_time.max}};
+            }
+            endpoints[kNodeLabels[i]] = std::move(endpoint);
+        }
+        nlohmann::json entry = {{"name", channel.name}, {"ring_capacity", channel.ring_capacity},
+                                {"directions", std::move(directions)}, {"endpoints", std::move(endpoints)}};
+        if (!channel.conversion.empty()) {
+            const ModbusStats& m = channel.modbus;
+            entry["conversion"] = {{"type", channel.conversion}, {"requests", m.requests},
+                                   {"responses", m.responses}, {"timeouts", m.timeouts},
+                                   {"crc_errors", m.crc_errors}, {"exceptions", m.exceptions}};
+        }
+        channels.push_back(std::move(entry));
+    }
+    root["channels"] = std::move(channels);
+    return root.dump() + "\n";
+}
@@ -0,0 +1,64 @@
+// stats_server.h
+#pragma once
+#include "event_loop.h"
+#include "channel_metrics.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+class ChannelManager;
+
+// 一次抓取的全部统计
+struct StatsSnapshot {
+    std::vector<ChannelStats> channels;
+    size_t pool_threads = 0;
+    size_t pool_queue_depth = 0; // 线程池排队中的转发任务数
+};
+
+// 本地统计服务：HTTP/1.1（每个连接一个请求），监听回环 TCP 端口或 Unix 域套接字
+//   GET /metrics  Prometheus 文本格式
+//   GET /stats    JSON
+// 使用独立的 EventLoop 线程（不属于 Reactor 的通道分片），快照的汇总与格式化都在该线程中完成；
+// 计数器读取为 relaxed 原子读取，不加端点锁，不占用数据通道的事件循环与转发线程
+class StatsServer {
+public:
+    explicit StatsServer(ChannelManager& manager);
+    ~StatsServer();
+
+    StatsServer(const StatsServer&) = delete;
+    StatsServer& operator=(const StatsServer&) = delete;
+
+    // address 为端口号（监听 127.0.0.1）或 "unix:<path>"，失败返回 false
+    bool start(const std::string& address);
+    void stop();
+
+    static std::string renderPrometheus(const StatsSnapshot& snapshot);
+    static std::string renderJson(const StatsSnapshot& snapshot);
+
+private:
+    struct Connection {
+        std::string request;
+        std::string response;
+        size_t sent = 0;
+        EventLoop::Clock::time_point lastActive;
+    };
+
+    bool listenTcp(uint16_t port);
+    bool listenUnix(const std::string& path);
+    // 以下在事件循环线程中执行
+    void handleAccept();
+    void handleConnection(int fd, uint32_t events);
+    void handleRequest(int fd, Connection& connection);
+    void flushResponse(int fd, Connection& connection);
+    void closeConnection(int fd);
+    void closeIdleConnections();
+
+    StatsSnapshot takeSnapshot();
+
+    ChannelManager& manager_;
+    EventLoop loop_;
+    int listen_fd_ = -1;
+    std::string unix_path_;
+    std::unordered_map<int, Connection> connections_;
+    EventLoop::TimerId idle_timer_ = 0;
+};
@@ -0,0 +1,102 @@
+// task.h
+#pragma once
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// 只可移动的任务对象（小缓冲区优化）
+// - 捕获不超过 kInlineSize 字节、且可无异常移动的可调用对象直接存放在对象内部，不分配内存
+// - 更大的可调用对象退化为一次堆分配
+// 与 std::function 相比不要求可拷贝，也没有类型擦除之外的额外开销
+class Task {
+public:
+    static constexpr size_t kInlineSize = 64;
+
+    Task() noexcept = default;
+
+    template <typename F,
+              typename Fn = std::decay_t<F>,
+              typename = std::enable_if_t<!std::is_same<Fn, Task>::value>>
+    Task(F&& f) {
+        if constexpr (fitsInline<Fn>()) {
+            ::new (static_cast<void*>(storage_)) Fn(std::forward<F>(f));
+            ops_ = &kInlineOps<Fn>;
+        } else {
+            *reinterpret_cast<Fn**>(storage_) = new Fn(std::forward<F>(f));
+            ops_ = &kHeapOps<Fn>;
+        }
+    }
+
+    Task(Task&& other) noexcept { moveFrom(other); }
+
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            reset();
+            moveFrom(other);
+        }
+        return *this;
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() { reset(); }
+
+    explicit operator bool() const noexcept { return ops_ != nullptr; }
+
+    void operator()() { ops_->invoke(storage_); }
+
+    void reset() noexcept {
+        if (ops_) {
+            ops_->destroy(storage_);
+            ops_ = nullptr;
+        }
+    }
+
+    // 可调用对象类型 Fn 是否内联存放（供测试 / 基准确认不分配）
+    template <typename Fn>
+    static constexpr bool fitsInline() {
+        return sizeof(Fn) <= kInlineSize &&
+               alignof(Fn) <= alignof(std::max_align_t) &&
+               std::is_nothrow_move_constructible<Fn>::value;
+    }
+
+private:
+    struct Ops {
+        void (*invoke)(void* storage);
+        void (*relocate)(void* dst, void* src) noexcept; // 移动到 dst 并销毁 src 中的对象
+        void (*destroy)(void* storage) noexcept;
+    };
+
+    template <typename Fn>
+    static constexpr Ops kInlineOps = {
+        [](void* s) { (*static_cast<Fn*>(s))(); },
+        [](void* dst, void* src) noexcept {
+            Fn* from = static_cast<Fn*>(src);
+            ::new (dst) Fn(std::move(*from));
+            from->~Fn();
+        },
+        [](void* s) noexcept { static_cast<Fn*>(s)->~Fn(); },
+    };
+
+    template <typename Fn>
+    static constexpr Ops kHeapOps = {
+        [](void* s) { (**static_cast<Fn**>(s))(); },
+        [](void* dst, void* src) noexcept {
+            *static_cast<Fn**>(dst) = *static_cast<Fn**>(src);
+        },
+        [](void* s) noexcept { delete *static_cast<Fn**>(s); },
+    };
+
+    void moveFrom(Task& other) noexcept {
+        if (other.ops_) {
+            other.ops_->relocate(storage_, other.storage_);
+            ops_ = other.ops_;
+            other.ops_ = nullptr;
+        }
+    }
+
+    alignas(std::max_align_t) unsigned char storage_[kInlineSize];
+    const Ops* ops_ = nullptr;
+};
@@ -7,10 +7,10 @@
 #include <cstring>
 #include <stdexcept>
 #include <system_error>
+#include <algorithm>
 
 TcpClientEndpoint::TcpClientEndpoint(const std::string& host, uint16_t port, int reconnect_interval)
-    : _host(host), _port(port), _reconnect_interval(reconnect_interval),
-      _last_reconnect_time(std::chrono::steady_clock::now()) {}
+    : _host(host), _port(port), _reconnect_interval(reconnect_interval) {}
 
 TcpClientEndpoint::~TcpClientEndpoint() {
     close();
@@ -19,139 +19,313 @@ TcpClientEndpoint::~TcpClientEndpoint() {
 bool TcpClientEndpoint::open() {
     if (isRunning()) return true;
     
+    _running = true;
     setState(State::CONNECTING);
-    startThread();
+    getEventLoop()->runInLoop([this] { startConnect(); });
     return true;
 }
 
 void TcpClientEndpoint::close() {
-    stopThread();
-    resetConnection();
+    if (!_running.exchange(false)) return;
+
+    // 在事件循环线程中清理，保证之后不再有回调访问本端点
+    getEventLoop()->runAndWait([this] {
+        if (_reconnectTimer) {
+            getEventLoop()->cancelTimer(_reconnectTimer);
+            _reconnectTimer = 0;
+        }
+        resetConnection();
+    });
     setState(State::DISCONNECTED);
 }
 
 void TcpClientEndpoint::resetConnection() {
-    // 从 epoll 中移除 socket 监控
-    if (_epollFd >= 0 && _socketFd >= 0) {
-        epoll_ctl(_epollFd, EPOLL_CTL_DEL, _socketFd, nullptr);
-    }
-    
+    // 从事件循环中移除 socket 监控
     if (_socketFd >= 0) {
+        getEventLoop()->removeFd(_socketFd);
+        std::lock_guard<std::mutex> lock(_mutex);
         ::close(_socketFd);
         _socketFd = -1;
+        _sendFailed = false;
+        // 已确认给写入方的排队数据随连接丢弃
+        _droppedBytes.fetch_add(queuedLocked(), std::memory_order_relaxed);
+        clearQueueLocked();
+        _writerWaiting = false;
     }
     
     _connecting = false;
+    // 断开期间 writev 不接收数据，重新连接成功后再通知写入方
+}
+
+void TcpClientEndpoint::setWriteWatermarks(size_t high, size_t low) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _highWatermark = high > 0 ? high : kDefaultHighWatermark;
+    _lowWatermark = std::min(low > 0 ? low : kDefaultLowWatermark, _highWatermark);
+}
+
+TcpClientEndpoint::WriteQueueStats TcpClientEndpoint::getWriteQueueStats() const {
+    WriteQueueStats stats;
+    stats.queuedBytes = _queuedBytes.load(std::memory_order_relaxed);
+    stats.stallCount = _stallCount.load(std::memory_order_relaxed);
+    stats.stallTimeUs = _stallTimeUs.load(std::memory_order_relaxed);
+    stats.droppedBytes = _droppedBytes.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void TcpClientEndpoint::fillStats(EndpointStats& stats) const {
+    Endpoint::fillStats(stats);
+    stats.reconnects = _reconnects.load(std::memory_order_relaxed);
+    stats.queued_bytes = _queuedBytes.load(std::memory_order_relaxed);
 }
 
 void TcpClientEndpoint::write(const uint8_t* data, size_t len) {
     if (!isConnected()) return;
     
     std::lock_guard<std::mutex> lock(_mutex);
-    if (send(_socketFd, data, len, MSG_NOSIGNAL) < 0) {
-        logError("Send failed: " + std::string(strerror(errno)));
-        setState(State::ERROR);
-        handleDisconnectEvent();
+    if (_socketFd < 0) return;
+
+    // write() 无法反馈部分接收，允许排队到高水位的4倍，超出部分丢弃
+    struct iovec iov{const_cast<uint8_t*>(data), len};
+    size_t accepted = sendOrQueueLocked(&iov, 1, _highWatermark * 4);
+    if (accepted < len) {
+        _droppedBytes.fetch_add(len - accepted, std::memory_order_relaxed);
+        logMessage("Write queue full, dropped " + std::to_string(len - accepted) + " bytes");
+    }
+}
+
+ssize_t TcpClientEndpoint::writev(const struct iovec* iov, int iovcnt) {
+    const size_t total = iovLength(iov, iovcnt);
+    // 未连接（或发送出错、等待断开处理）时不接收数据：数据留在调用方缓冲区（源端按水位暂停读取），
+    // 连接建立后由 handleConnectEvent 通知继续
+    if (!isConnected()) return 0;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_socketFd < 0 || _sendFailed) return 0;
+
+    size_t accepted = sendOrQueueLocked(iov, iovcnt, _highWatermark);
+    if (accepted < total) {
+        _writerWaiting = true;
     }
+    return accepted;
 }
 
-void TcpClientEndpoint::run() {
-    while (isRunning()) {
-        // 创建或重新创建 epoll 实例
-        if (_epollFd < 0) {
-            _epollFd = epoll_create1(0);
-            if (_epollFd < 0) {
-                logError("Epoll creation failed: " + std::string(strerror(errno)));
-                setState(State::ERROR);
-                std::this_thread::sleep_for(std::chrono::seconds(1));
-                continue;
+size_t TcpClientEndpoint::sendOrQueueLocked(const struct iovec* iov, int iovcnt, size_t queueLimit) {
+    const size_t total = iovLength(iov, iovcnt);
+
+    // 先尝试清空积压数据，保证发送顺序
+    flushLocked();
+    if (_socketFd < 0 || _sendFailed) return 0;
+
+    size_t sent = 0;
+    if (queuedLocked() == 0) {
+        msghdr msg{};
+        msg.msg_iov = const_cast<struct iovec*>(iov);
+        msg.msg_iovlen = iovcnt;
+        ssize_t n = sendmsg(_socketFd, &msg, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                logError("Send failed: " + std::string(strerror(errno)));
+                // 关闭读写方向，由事件循环收到 EPOLLHUP 后统一处理断开与重连
+                shutdown(_socketFd, SHUT_RDWR);
+                _sendFailed = true;
+                return 0;
             }
+            n = 0;
         }
+        sent = n;
+    }
 
-        // 处理重连逻辑
-        if (!isConnected() && !_connecting && !_reconnect_pending) {
-            auto now = std::chrono::steady_clock::now();
-            auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(
-                now - _last_reconnect_time).count();
-            
-            if (elapsed >= _reconnect_interval) {
-                logMessage("Attempting to connect...");
-                setState(State::CONNECTING);
-                if (tryConnect()) {
-                    _connecting = true;
-                } else {
-                    // 连接失败，等待下一次重连
-                    _last_reconnect_time = now;
-                    _reconnect_pending = true;
-                }
-            }
+    // 内核未接收的部分进入发送队列（不超过队列上限）
+    const size_t queued = queuedLocked();
+    const size_t room = queueLimit > queued ? queueLimit - queued : 0;
+    const size_t toQueue = std::min(total - sent, room);
+    appendLocked(iov, iovcnt, sent, toQueue);
+    updateWriteInterestLocked();
+    return sent + toQueue;
+}
+
+void TcpClientEndpoint::appendLocked(const struct iovec* iov, int iovcnt, size_t skip, size_t len) {
+    if (len == 0) return;
+
+    // 已发送部分过半时压缩缓冲区
+    if (_outOffset > 0 && _outOffset >= _outBuffer.size() / 2) {
+        _outBuffer.erase(_outBuffer.begin(), _outBuffer.begin() + _outOffset);
+        _outOffset = 0;
+    }
+
+    for (int i = 0; i < iovcnt && len > 0; ++i) {
+        const uint8_t* base = static_cast<const uint8_t*>(iov[i].iov_base);
+        size_t part = iov[i].iov_len;
+        if (skip >= part) {
+            skip -= part;
+            continue;
         }
+        base += skip;
+        part -= skip;
+        skip = 0;
 
-        // 事件循环 - 仅在有有效 epoll 描述符时执行
-        if (_epollFd >= 0) {
-            epoll_event events[2];
-            int numEvents = epoll_wait(_epollFd, events, 2, 100); // 100ms超时
-            
-            if (numEvents < 0) {
-                if (errno == EBADF) {
-                    // epoll 描述符无效，重置连接
-                    logError("Epoll_wait encountered bad file descriptor. Resetting connection.");
-                    resetConnection();
-                    continue;
-                } else if (errno != EINTR) {
-                    logError("Epoll_wait error: " + std::string(strerror(errno)));
-                }
-                continue;
-            }
+        part = std::min(part, len);
+        _outBuffer.insert(_outBuffer.end(), base, base + part);
+        len -= part;
+    }
+    _queuedBytes.store(queuedLocked(), std::memory_order_relaxed);
+}
 
-            for (int i = 0; i < numEvents; ++i) {
-                // 处理连接事件
-                if (events[i].events & EPOLLOUT && _connecting) {
-                    handleConnectEvent();
-                }
-                // 处理断开事件
-                else if (events[i].events & (EPOLLHUP | EPOLLERR | EPOLLRDHUP)) {
-                    handleDisconnectEvent();
-                }
-                // 处理数据事件
-                else if (events[i].events & EPOLLIN) {
-                    handleSocketData();
-                }
-            }
+void TcpClientEndpoint::flushLocked() {
+    while (_socketFd >= 0 && !_sendFailed && queuedLocked() > 0) {
+        ssize_t n = send(_socketFd, _outBuffer.data() + _outOffset, queuedLocked(), MSG_NOSIGNAL);
+        if (n > 0) {
+            _outOffset += n;
+            continue;
         }
+        if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+            logError("Send failed: " + std::string(strerror(errno)));
+            shutdown(_socketFd, SHUT_RDWR);
+            _sendFailed = true;
+            // 已确认给写入方的排队数据无法发送，计入丢弃
+            _droppedBytes.fetch_add(queuedLocked(), std::memory_order_relaxed);
+            clearQueueLocked();
+        }
+        break;
+    }
 
-        // 处理重连等待状态
-        if (_reconnect_pending) {
-            auto now = std::chrono::steady_clock::now();
-            auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(
-                now - _last_reconnect_time).count();
-            
-            if (elapsed >= _reconnect_interval) {
-                _reconnect_pending = false;
-            } else {
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            }
+    if (queuedLocked() == 0) {
+        _outBuffer.clear();
+        _outOffset = 0;
+    }
+    _queuedBytes.store(queuedLocked(), std::memory_order_relaxed);
+}
+
+void TcpClientEndpoint::updateWriteInterestLocked() {
+    // 仅在有排队数据时注册 EPOLLOUT
+    const bool want = _socketFd >= 0 && queuedLocked() > 0;
+    if (want == _writeBlocked) return;
+
+    if (!getEventLoop()->modifyFd(_socketFd, socketEventsLocked(want))) return;
+
+    _writeBlocked = want;
+    auto now = std::chrono::steady_clock::now();
+    if (want) {
+        _stallStart = now;
+        _stallCount.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        _stallTimeUs.fetch_add(std::chrono::duration_cast<std::chrono::microseconds>(
+            now - _stallStart).count(), std::memory_order_relaxed);
+    }
+}
+
+uint32_t TcpClientEndpoint::socketEventsLocked(bool wantWrite) const {
+    // 读暂停时同时去掉 EPOLLRDHUP，避免对端半关闭时丢弃 socket 中尚未读取的数据
+    uint32_t events = EPOLLERR | EPOLLHUP;
+    if (!isReadPaused()) events |= EPOLLIN | EPOLLRDHUP;
+    if (wantWrite) events |= EPOLLOUT;
+    return events;
+}
+
+void TcpClientEndpoint::updateReadInterest() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    // 连接建立前仅监控 EPOLLOUT，连接成功时会按当前读暂停状态注册
+    if (_socketFd < 0 || _connecting) return;
+    getEventLoop()->modifyFd(_socketFd, socketEventsLocked(_writeBlocked));
+}
+
+void TcpClientEndpoint::clearQueueLocked() {
+    if (_writeBlocked) {
+        _stallTimeUs.fetch_add(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - _stallStart).count(), std::memory_order_relaxed);
+        _writeBlocked = false;
+    }
+    _outBuffer.clear();
+    _outOffset = 0;
+    _queuedBytes.store(0, std::memory_order_relaxed);
+}
+
+ssize_t TcpClientEndpoint::spliceFrom(int pipeFd, size_t len) {
+    // 未连接时与 writev() 一致：数据留在管道中（源端暂停读取），连接建立后通知继续
+    if (!isConnected()) return 0;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_socketFd < 0 || _sendFailed) return 0;
+
+    // 有排队数据时先发送队列，保证顺序
+    flushLocked();
+    if (_sendFailed) return 0;
+
+    size_t total = 0;
+    while (queuedLocked() == 0 && total < len) {
+        ssize_t n = splice(pipeFd, nullptr, _socketFd, nullptr, len - total,
+                           SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        if (n > 0) {
+            total += n;
+            continue;
         }
+        if (n < 0 && errno != EAGAIN) {
+            logError("Splice failed: " + std::string(strerror(errno)));
+            shutdown(_socketFd, SHUT_RDWR);
+            _sendFailed = true;
+            // 连接即将断开，剩余数据留在管道中，重新连接后继续发送
+            return total;
+        }
+        break;
     }
-    
-    // 线程退出前清理资源
-    resetConnection();
-    if (_epollFd >= 0) {
-        ::close(_epollFd);
-        _epollFd = -1;
+
+    // 内核未接收的部分从管道读入发送队列（不超过高水位）
+    uint8_t buffer[4096];
+    while (total < len && queuedLocked() < _highWatermark) {
+        size_t want = std::min({sizeof(buffer), len - total, _highWatermark - queuedLocked()});
+        ssize_t n = ::read(pipeFd, buffer, want);
+        if (n <= 0) break;
+        struct iovec iov{buffer, static_cast<size_t>(n)};
+        appendLocked(&iov, 1, 0, n);
+        total += n;
+    }
+    updateWriteInterestLocked();
+    if (total < len) {
+        _writerWaiting = true;
+    }
+    return total;
+}
+
+void TcpClientEndpoint::startConnect() {
+    if (!isRunning()) return;
+
+    logMessage("Attempting to connect...");
+    setState(State::CONNECTING);
+    if (tryConnect()) {
+        _connecting = true;
+    } else {
+        // 连接失败，等待下一次重连
+        resetConnection();
+        setState(State::DISCONNECTED);
+        scheduleReconnect();
     }
 }
 
+void TcpClientEndpoint::scheduleReconnect() {
+    if (!isRunning() || _reconnectTimer) return;
+
+    _reconnectTimer = getEventLoop()->runAfter(
+        std::chrono::seconds(_reconnect_interval), [this] {
+            _reconnectTimer = 0;
+            _reconnects.fetch_add(1, std::memory_order_relaxed);
+            startConnect();
+        });
+}
+
 bool TcpClientEndpoint::tryConnect() {
     if (_socketFd >= 0) {
         resetConnection(); // 确保之前的连接已关闭
     }
 
-    _socketFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
-    if (_socketFd < 0) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (fd < 0) {
         logError("Socket creation failed: " + std::string(strerror(errno)));
         return false;
     }
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _socketFd = fd;
+    }
 
     sockaddr_in serverAddr{};
     serverAddr.sin_family = AF_INET;
@@ -169,19 +343,66 @@ bool TcpClientEndpoint::tryConnect() {
         return false;
     }
 
+    // io_uring 后端：连接建立（modifyFd 加入 EPOLLIN）后由多发接收交付数据
+    EventLoop* loop = getEventLoop();
+    if (loop->hasIoUring() && !_spliceCallback) {
+        loop->addRecv(_socketFd, false, false,
+                      [this](const uint8_t* data, ssize_t len, const sockaddr_in*) {
+                          handleReceived(data, len);
+                      });
+    }
+
     // 监控连接状态
-    epoll_event event{};
-    event.events = EPOLLOUT | EPOLLERR | EPOLLHUP;
-    event.data.fd = _socketFd;
-    
-    if (epoll_ctl(_epollFd, EPOLL_CTL_ADD, _socketFd, &event) < 0) {
+    if (!loop->addFd(_socketFd, EPOLLOUT | EPOLLERR | EPOLLHUP,
+                     [this](uint32_t events) { handleEvents(events); })) {
         logError("Epoll_ctl failed: " + std::string(strerror(errno)));
+        loop->removeFd(_socketFd);
         return false;
     }
 
     return true;
 }
 
+void TcpClientEndpoint::handleEvents(uint32_t events) {
+    // 处理连接事件
+    if (events & EPOLLOUT && _connecting) {
+        handleConnectEvent();
+        return;
+    }
+    // 处理断开事件
+    if (events & (EPOLLHUP | EPOLLERR)) {
+        handleDisconnectEvent();
+        return;
+    }
+    // 处理可写事件
+    if (events & EPOLLOUT) {
+        handleWritable();
+    }
+    // 处理数据事件（对端半关闭时先读完剩余数据，读到 EOF 后再断开）
+    if (events & (EPOLLIN | EPOLLRDHUP)) {
+        handleSocketData();
+    }
+}
+
+void TcpClientEndpoint::handleWritable() {
+    bool notify = false;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        flushLocked();
+        updateWriteInterestLocked();
+
+        // 回落到低水位以下才唤醒写入方，避免频繁抖动
+        if (_writerWaiting && queuedLocked() <= _lowWatermark) {
+            _writerWaiting = false;
+            notify = true;
+        }
+    }
+
+    if (notify) {
+        notifyWritable();
+    }
+}
+
 void TcpClientEndpoint::handleConnectEvent() {
     int error = 0;
     socklen_t len = sizeof(error);
@@ -197,41 +418,58 @@ void TcpClientEndpoint::handleConnectEvent() {
         return;
     }
 
-    // 连接成功，更新epoll监控事件
-    epoll_event event{};
-    event.events = EPOLLIN | EPOLLRDHUP | EPOLLERR | EPOLLHUP;
-    event.data.fd = _socketFd;
-    
-    if (epoll_ctl(_epollFd, EPOLL_CTL_MOD, _socketFd, &event) < 0) {
+    // 连接成功，更新epoll监控事件（持锁以免与读暂停切换交错）
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (getEventLoop()->modifyFd(_socketFd, socketEventsLocked(false))) {
+            _connecting = false;
+        }
+    }
+    if (_connecting) {
         logError("Epoll_ctl modify failed: " + std::string(strerror(errno)));
         handleDisconnectEvent();
         return;
     }
 
-    _connecting = false;
     setState(State::CONNECTED);
     logMessage("Connected to " + _host + ":" + std::to_string(_port));
+    // 通知转发方发送连接建立前积压的数据
+    notifyWritable();
 }
 
 void TcpClientEndpoint::handleDisconnectEvent() {
     logMessage("Connection closed");
     resetConnection();
     setState(State::DISCONNECTED);
-    _last_reconnect_time = std::chrono::steady_clock::now();
-    _reconnect_pending = true; // 进入重连等待状态
+    scheduleReconnect(); // 进入重连等待状态
 }
 
 void TcpClientEndpoint::handleSocketData() {
+    // 零拷贝模式：由通道直接从 socket splice 到目标端点
+    if (_spliceCallback) {
+        if (!_spliceCallback(_socketFd)) {
+            handleDisconnectEvent();
+        }
+        return;
+    }
+
     uint8_t buffer[4096];
     ssize_t bytesRead = recv(_socketFd, buffer, sizeof(buffer), 0);
-    
-    if (bytesRead > 0) {
-        processData(buffer, bytesRead);
-    } else if (bytesRead == 0) {
+    if (bytesRead < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) return;
+        bytesRead = -errno;
+    }
+    handleReceived(buffer, bytesRead);
+}
+
+void TcpClientEndpoint::handleReceived(const uint8_t* data, ssize_t len) {
+    if (len > 0) {
+        processData(data, len);
+    } else if (len == 0) {
         // 对端关闭连接
         handleDisconnectEvent();
-    } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
-        logError("Receive error: " + std::string(strerror(errno)));
+    } else {
+        logError("Receive error: " + std::string(strerror(-len)));
         handleDisconnectEvent();
     }
-}
\ No newline at end of file
+}
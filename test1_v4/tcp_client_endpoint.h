@@ -2,32 +2,83 @@
 #include "endpoint.h"
 #include <sys/epoll.h>
 #include <chrono>
-#include <thread>
 #include <atomic>
+#include <vector>
 
 class TcpClientEndpoint : public Endpoint {
 public:
+    // 发送队列统计
+    struct WriteQueueStats {
+        size_t queuedBytes = 0;     // 当前排队字节数
+        uint64_t stallCount = 0;    // 内核拒收（注册 EPOLLOUT）的次数
+        uint64_t stallTimeUs = 0;   // 累计等待可写的时间（微秒）
+        uint64_t droppedBytes = 0;  // write() 超出队列上限被丢弃的字节数
+    };
+
+    static constexpr size_t kDefaultHighWatermark = 256 * 1024;
+    static constexpr size_t kDefaultLowWatermark = 64 * 1024;
+
     TcpClientEndpoint(const std::string& host, uint16_t port, int reconnect_interval = 1);
     ~TcpClientEndpoint() override;
     
     bool open() override;
     void close() override;
     void write(const uint8_t* data, size_t len) override;
+    ssize_t writev(const struct iovec* iov, int iovcnt) override;
+
+    bool supportsSplice() const override { return true; }
+    ssize_t spliceFrom(int pipeFd, size_t len) override;
+
+    // 发送队列水位：排队超过高水位时 writev 只接收部分数据，
+    // 回落到低水位以下后发出可写通知
+    void setWriteWatermarks(size_t high, size_t low);
+    WriteQueueStats getWriteQueueStats() const;
+
+    void fillStats(EndpointStats& stats) const override;
 
 private:
-    void run() override;
+    void startConnect();
+    void scheduleReconnect();
     bool tryConnect();
+    void handleEvents(uint32_t events);
     void handleSocketData();
+    // 处理一次读取结果：len > 0 为数据，0 为对端关闭，< 0 为 -errno（epoll / io_uring 共用）
+    void handleReceived(const uint8_t* data, ssize_t len);
+    void handleWritable();
     void resetConnection();
     void handleConnectEvent();
     void handleDisconnectEvent();
+    void updateReadInterest() override;
+
+    // 发送队列（调用方需持有 _mutex）
+    size_t queuedLocked() const { return _outBuffer.size() - _outOffset; }
+    size_t sendOrQueueLocked(const struct iovec* iov, int iovcnt, size_t queueLimit);
+    void appendLocked(const struct iovec* iov, int iovcnt, size_t skip, size_t len);
+    void flushLocked();
+    void updateWriteInterestLocked();
+    uint32_t socketEventsLocked(bool wantWrite) const;
+    void clearQueueLocked();
 
     const std::string _host;
     const uint16_t _port;
     const int _reconnect_interval; // 重连间隔（秒）
     int _socketFd = -1;
-    int _epollFd = -1;
-    std::chrono::steady_clock::time_point _last_reconnect_time;
+    EventLoop::TimerId _reconnectTimer = 0;
     std::atomic<bool> _connecting{false}; // 使用原子操作确保线程安全
-    std::atomic<bool> _reconnect_pending{false}; // 标记重连等待状态
-};
\ No newline at end of file
+
+    // 以下成员受 _mutex 保护
+    std::vector<uint8_t> _outBuffer;   // 待发送数据，[_outOffset, size) 有效
+    size_t _outOffset = 0;
+    size_t _highWatermark = kDefaultHighWatermark;
+    size_t _lowWatermark = kDefaultLowWatermark;
+    bool _writeBlocked = false;        // 已注册 EPOLLOUT
+    bool _writerWaiting = false;       // writev 曾被限流，等待低水位通知
+    bool _sendFailed = false;          // 发送出错已 shutdown，等待事件循环处理断开（期间不再写入）
+    std::chrono::steady_clock::time_point _stallStart;
+
+    std::atomic<size_t> _queuedBytes{0};
+    std::atomic<uint64_t> _stallCount{0};
+    std::atomic<uint64_t> _stallTimeUs{0};
+    std::atomic<uint64_t> _droppedBytes{0};
+    std::atomic<uint64_t> _reconnects{0};
+};
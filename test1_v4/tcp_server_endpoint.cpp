@@ -6,6 +6,7 @@
 #include <arpa/inet.h>
 #include <cstring>
 #include <stdexcept>
+#include <algorithm>
 
 TcpServerEndpoint::TcpServerEndpoint(uint16_t port) : _port(port) {}
 
@@ -48,90 +49,166 @@ bool TcpServerEndpoint::open() {
         return false;
     }
 
-    // 创建epoll实例
-    _epollFd = epoll_create1(0);
-    if (_epollFd < 0) {
-        logError("Epoll creation failed: " + std::string(strerror(errno)));
-        ::close(_serverFd);
-        _serverFd = -1;
-        return false;
-    }
-
-    // 添加服务器socket到epoll
-    epoll_event event{};
-    event.events = EPOLLIN;
-    event.data.fd = _serverFd;
-    if (epoll_ctl(_epollFd, EPOLL_CTL_ADD, _serverFd, &event) < 0) {
+    // 注册到事件循环
+    if (!getEventLoop()->addFd(_serverFd, EPOLLIN, [this](uint32_t) { handleNewConnection(); })) {
         logError("Epoll_ctl failed: " + std::string(strerror(errno)));
-        ::close(_epollFd);
         ::close(_serverFd);
-        _epollFd = -1;
         _serverFd = -1;
         return false;
     }
 
+    _running = true;
     setState(State::CONNECTED);
-    startThread();
     return true;
 }
 
 void TcpServerEndpoint::close() {
-    stopThread();
-    
-    if (_epollFd >= 0) {
-        ::close(_epollFd);
-        _epollFd = -1;
-    }
+    if (!_running.exchange(false)) return;
     
+    // 注销后事件循环不会再回调本端点
+    EventLoop* loop = getEventLoop();
     if (_serverFd >= 0) {
+        loop->removeFd(_serverFd);
         ::close(_serverFd);
         _serverFd = -1;
     }
     
-    for (auto& client : _clients) {
+    // 先取出客户端列表再注销，避免持锁等待事件循环
+    std::unordered_map<int, struct sockaddr_in> clients;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        clients.swap(_clients);
+        _blockedClientFd = -1;
+    }
+    for (auto& client : clients) {
+        loop->removeFd(client.first);
         ::close(client.first);
     }
-    _clients.clear();
     
     setState(State::DISCONNECTED);
 }
 
 void TcpServerEndpoint::write(const uint8_t* data, size_t len) {
     std::lock_guard<std::mutex> lock(_mutex);
+    sendToClients(data, len);
+}
+
+void TcpServerEndpoint::sendToClients(const uint8_t* data, size_t len) {
     for (auto& client : _clients) {
         if (send(client.first, data, len, MSG_NOSIGNAL) < 0) {
             logError("Send failed to client: " + std::to_string(client.first));
         }
     }
 }
-void TcpServerEndpoint::run() {
-    constexpr int MAX_EVENTS = 10;
-    epoll_event events[MAX_EVENTS];
-    
-    while (isRunning()) {
-        int numEvents = epoll_wait(_epollFd, events, MAX_EVENTS, 100);
-        if (numEvents < 0) {
-            if (errno != EINTR) {
-                logError("Epoll_wait error: " + std::string(strerror(errno)));
+
+ssize_t TcpServerEndpoint::writev(const struct iovec* iov, int iovcnt) {
+    const size_t total = iovLength(iov, iovcnt);
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    msghdr msg{};
+    msg.msg_iov = const_cast<struct iovec*>(iov);
+    msg.msg_iovlen = iovcnt;
+
+    // 无客户端：数据由调用方丢弃
+    if (_clients.empty()) return -1;
+
+    // 多客户端广播：各连接进度不同，按尽力发送处理（与 write() 一致）
+    if (_clients.size() != 1) {
+        for (auto& client : _clients) {
+            if (sendmsg(client.first, &msg, MSG_NOSIGNAL) < 0) {
+                logError("Send failed to client: " + std::to_string(client.first));
             }
-            continue;
         }
+        return total;
+    }
+
+    // 单客户端：只确认内核已接收的字节，其余留给调用方重试
+    int clientFd = _clients.begin()->first;
+    ssize_t sent = sendmsg(clientFd, &msg, MSG_NOSIGNAL);
+    if (sent < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            logError("Send failed to client: " + std::to_string(clientFd));
+            return -1;
+        }
+        sent = 0;
+    }
+
+    if (static_cast<size_t>(sent) < total) {
+        waitWritableLocked(clientFd);
+    }
+    return sent;
+}
 
-        for (int i = 0; i < numEvents; ++i) {
-            if (events[i].data.fd == _serverFd) {
-                handleNewConnection();
-            } else {
-                // 检查连接是否断开
-                if (events[i].events & (EPOLLHUP | EPOLLERR | EPOLLRDHUP)) {
-                    closeClient(events[i].data.fd);
-                } else if (events[i].events & EPOLLIN) {
-                    handleClientData(events[i].data.fd);
-                }
+ssize_t TcpServerEndpoint::spliceFrom(int pipeFd, size_t len) {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // 无客户端：数据由调用方丢弃
+    if (_clients.empty()) return -1;
+
+    // 单客户端：管道 -> socket，数据始终留在内核页中
+    if (_clients.size() == 1) {
+        int clientFd = _clients.begin()->first;
+        size_t total = 0;
+        while (total < len) {
+            ssize_t n = splice(pipeFd, nullptr, clientFd, nullptr, len - total,
+                               SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+            if (n > 0) {
+                total += n;
+                continue;
+            }
+            if (n < 0 && errno != EAGAIN) {
+                logError("Splice failed to client: " + std::to_string(clientFd));
+                return total > 0 ? static_cast<ssize_t>(total) : -1;
             }
+            break;
         }
+        // 内核未接收的部分留在管道中，等待 EPOLLOUT 后由调用方重试
+        if (total < len) {
+            waitWritableLocked(clientFd);
+        }
+        return total;
+    }
+
+    // 多客户端广播：splice 无法一对多写 socket，回退为读出后逐个发送
+    uint8_t buffer[4096];
+    size_t total = 0;
+    while (total < len) {
+        ssize_t n = ::read(pipeFd, buffer, std::min(sizeof(buffer), len - total));
+        if (n <= 0) break;
+        sendToClients(buffer, n);
+        total += n;
+    }
+    return total;
+}
+void TcpServerEndpoint::waitWritableLocked(int clientFd) {
+    if (_blockedClientFd == clientFd) return;
+    _blockedClientFd = clientFd;
+    if (!getEventLoop()->modifyFd(clientFd, clientEventsLocked(clientFd))) {
+        _blockedClientFd = -1;
+    }
+}
+
+uint32_t TcpServerEndpoint::clientEventsLocked(int clientFd) const {
+    // 读暂停时同时去掉 EPOLLRDHUP，避免对端半关闭时丢弃 socket 中尚未读取的数据
+    uint32_t events = EPOLLHUP | EPOLLERR;
+    if (!isReadPaused()) events |= EPOLLIN | EPOLLRDHUP;
+    if (clientFd == _blockedClientFd) events |= EPOLLOUT;
+    return events;
+}
+
+void TcpServerEndpoint::updateReadInterest() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (const auto& client : _clients) {
+        getEventLoop()->modifyFd(client.first, clientEventsLocked(client.first));
     }
 }
 
+void TcpServerEndpoint::fillStats(EndpointStats& stats) const {
+    Endpoint::fillStats(stats);
+    stats.clients = _clientCount.load(std::memory_order_relaxed);
+    stats.accepted = _acceptedCount.load(std::memory_order_relaxed);
+}
+
 void TcpServerEndpoint::handleNewConnection() {
     sockaddr_in clientAddr{};
     socklen_t addrLen = sizeof(clientAddr);
@@ -143,22 +220,64 @@ void TcpServerEndpoint::handleNewConnection() {
     }
 
     // 添加到epoll监控
-    epoll_event event{};
-    event.events = EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR;
-    event.data.fd = clientFd;
-    if (epoll_ctl(_epollFd, EPOLL_CTL_ADD, clientFd, &event) < 0) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_maxClients > 0 && _clients.size() >= _maxClients) {
+        ::close(clientFd);
+        logMessage("Rejected client " + std::string(inet_ntoa(clientAddr.sin_addr)) + ":" +
+                   std::to_string(ntohs(clientAddr.sin_port)) + ": at most " +
+                   std::to_string(_maxClients) + " client(s) allowed");
+        return;
+    }
+    EventLoop* loop = getEventLoop();
+    // io_uring 后端：数据由多发接收交付，epoll 只负责 EPOLLOUT/挂断（零拷贝模式仍由 epoll 触发 splice）
+    if (loop->hasIoUring() && !_spliceCallback) {
+        loop->addRecv(clientFd, false, false,
+                      [this, clientFd](const uint8_t* data, ssize_t len, const sockaddr_in*) {
+                          if (len > 0) {
+                              processData(data, len);
+                          } else {
+                              closeClient(clientFd);
+                          }
+                      });
+    }
+    auto handler = [this, clientFd](uint32_t events) {
+        // 检查连接是否断开
+        if (events & (EPOLLHUP | EPOLLERR)) {
+            closeClient(clientFd);
+            return;
+        }
+        if (events & EPOLLOUT) {
+            handleClientWritable(clientFd);
+        }
+        // 对端半关闭时先读完剩余数据，读到 EOF 后再关闭
+        if (events & (EPOLLIN | EPOLLRDHUP)) {
+            handleClientData(clientFd);
+        }
+    };
+    if (!loop->addFd(clientFd, clientEventsLocked(clientFd), handler)) {
         logError("Epoll_ctl add client failed: " + std::string(strerror(errno)));
+        loop->removeFd(clientFd);
         ::close(clientFd);
         return;
     }
 
     _clients[clientFd] = clientAddr;
+    _clientCount.store(_clients.size(), std::memory_order_relaxed);
+    _acceptedCount.fetch_add(1, std::memory_order_relaxed);
     logMessage("New client connected: " + std::string(inet_ntoa(clientAddr.sin_addr)) + 
                ":" + std::to_string(ntohs(clientAddr.sin_port)));
 }
 
 
 void TcpServerEndpoint::handleClientData(int clientFd) {
+    // 零拷贝模式：由通道直接从 socket splice 到目标端点
+    if (_spliceCallback) {
+        if (!_spliceCallback(clientFd)) {
+            closeClient(clientFd);
+        }
+        return;
+    }
+
     uint8_t buffer[4096];
     ssize_t bytesRead = recv(clientFd, buffer, sizeof(buffer), 0);
     
@@ -170,18 +289,39 @@ void TcpServerEndpoint::handleClientData(int clientFd) {
     }
 }
 
+void TcpServerEndpoint::handleClientWritable(int clientFd) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_blockedClientFd != clientFd) return;
+        _blockedClientFd = -1;
+        getEventLoop()->modifyFd(clientFd, clientEventsLocked(clientFd));
+    }
+    notifyWritable();
+}
+
 void TcpServerEndpoint::closeClient(int clientFd) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    auto it = _clients.find(clientFd);
-    if (it != _clients.end()) {
+    bool wasBlocked = false;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _clients.find(clientFd);
+        if (it == _clients.end()) return;
+
         logMessage("Client disconnected: " + 
                    std::string(inet_ntoa(it->second.sin_addr)) + 
                    ":" + std::to_string(ntohs(it->second.sin_port)));
         
-        if (_epollFd >= 0) {
-            epoll_ctl(_epollFd, EPOLL_CTL_DEL, clientFd, nullptr);
-        }
+        getEventLoop()->removeFd(clientFd);
         ::close(clientFd);
         _clients.erase(it);
+        _clientCount.store(_clients.size(), std::memory_order_relaxed);
+        if (_blockedClientFd == clientFd) {
+            _blockedClientFd = -1;
+            wasBlocked = true;
+        }
+    }
+
+    // 等待可写的客户端已断开，通知转发方继续处理积压数据
+    if (wasBlocked) {
+        notifyWritable();
     }
 }
\ No newline at end of file
@@ -13,15 +13,30 @@ public:
     bool open() override;
     void close() override;
     void write(const uint8_t* data, size_t len) override;
+    ssize_t writev(const struct iovec* iov, int iovcnt) override;
+    // 同时连接的客户端数上限（0 表示不限制），超过时拒绝新连接；open() 之前设置
+    void setMaxClients(size_t maxClients) { _maxClients = maxClients; }
+
+    bool supportsSplice() const override { return true; }
+    ssize_t spliceFrom(int pipeFd, size_t len) override;
+
+    void fillStats(EndpointStats& stats) const override;
 
 private:
-    void run() override;
     void handleNewConnection();
     void handleClientData(int clientFd);
     void closeClient(int clientFd);
+    void handleClientWritable(int clientFd);
+    void sendToClients(const uint8_t* data, size_t len); // 调用方需持有 _mutex
+    uint32_t clientEventsLocked(int clientFd) const;     // 调用方需持有 _mutex
+    void waitWritableLocked(int clientFd);               // 调用方需持有 _mutex
+    void updateReadInterest() override;
 
     const uint16_t _port;
     int _serverFd = -1;
-    int _epollFd = -1;
+    size_t _maxClients = 0;
     std::unordered_map<int, struct sockaddr_in> _clients;
+    int _blockedClientFd = -1; // 等待 EPOLLOUT 的客户端（受 _mutex 保护）
+    std::atomic<uint64_t> _clientCount{0};
+    std::atomic<uint64_t> _acceptedCount{0};
 };
\ No newline at end of file
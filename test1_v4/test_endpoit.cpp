@@ -12,6 +12,7 @@
 #include "udp_server_endpoint.h"
 #include "udp_client_endpoint.h"
 #include "serial_endpoint.h"
+#include "reactor.h"
 
 // 接收数据回调函数
 void dataCallback(const uint8_t* data, size_t len) {
@@ -53,8 +54,25 @@ int main(int argc, char* argv[]) {
         }
     }
 
+    // 解析 --io-backend 参数
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--io-backend") == 0 && i + 1 < argc) {
+            Reactor::Backend backend;
+            if (!Reactor::parseBackend(argv[i + 1], backend)) {
+                std::cerr << "Unknown I/O backend: " << argv[i + 1] << std::endl;
+                return 1;
+            }
+            Reactor::init(0, backend);
+            for (int j = i; j + 2 < argc; ++j) {
+                argv[j] = argv[j + 2];
+            }
+            argc -= 2;
+            break;
+        }
+    }
+
     if (argc < 2) {
-        std::cerr << "Usage: " << argv[0] << " <type> [options] [-n interval_ms]\n"
+        std::cerr << "Usage: " << argv[0] << " <type> [options] [-n interval_ms] [--io-backend epoll|io_uring]\n"
                   << "Types:\n"
                   << "  tcp_server <port>\n"
                   << "  tcp_client <ip> <port>\n"
@@ -62,7 +80,8 @@ int main(int argc, char* argv[]) {
                   << "  udp_client <ip> <port>\n"
                   << "  serial <device> <baud>\n"
                   << "Options:\n"
-                  << "  -n <interval_ms> : Send data periodically every interval_ms milliseconds\n";
+                  << "  -n <interval_ms> : Send data periodically every interval_ms milliseconds\n"
+                  << "  --io-backend <epoll|io_uring> : I/O backend (default epoll)\n";
         return 1;
     }
 
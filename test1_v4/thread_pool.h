@@ -1,62 +1,349 @@
 #pragma once
 #include <vector>
+#include <deque>
 #include <thread>
-#include <queue>
 #include <mutex>
 #include <condition_variable>
-#include <functional>
 #include <atomic>
+#include <cstdint>
 #include <memory>
+#include <cerrno>
+#include <pthread.h>
+#include <sched.h>
+#include "task.h"
 
+// 工作窃取线程池
+// - 每个工作线程一个有界无锁队列：外部线程轮流投递到各队列，工作线程内部提交的任务进入自己的队列
+// - 自己的队列为空时依次从其他队列窃取；所有队列已满时退入带锁的溢出队列（极少发生）
+// - enqueueTo() 把任务投递到指定线程的专属队列，该队列不参与窃取（通道亲和调度）
+// - 空闲线程先自旋若干轮再休眠；已有线程在自旋找任务时 enqueue 不做唤醒（无系统调用）
+// - 任务为 Task（小缓冲区优化），捕获不超过 64 字节时不分配内存
 class ThreadPool {
 public:
     explicit ThreadPool(size_t num_threads = std::thread::hardware_concurrency())
         : running_(true) {
+        if (num_threads == 0) num_threads = 1;
+        states_.reserve(num_threads);
         for (size_t i = 0; i < num_threads; ++i) {
-            workers_.emplace_back([this] {
-                while (running_) {
-                    std::function<void()> task;
-                    {
-                        std::unique_lock<std::mutex> lock(queue_mutex_);
-                        condition_.wait(lock, [this] {
-                            return !tasks_.empty() || !running_;
-                        });
-                        
-                        if (!running_ && tasks_.empty()) return;
-                        
-                        task = std::move(tasks_.front());
-                        tasks_.pop();
-                    }
-                    task();
-                }
-            });
+            states_.emplace_back(std::make_unique<WorkerState>());
+        }
+        // 线程启动时处于“自旋”状态，未进入休眠前不需要唤醒
+        spinning_.store(num_threads, std::memory_order_relaxed);
+        for (size_t i = 0; i < num_threads; ++i) {
+            workers_.emplace_back([this, i] { workerLoop(i); });
         }
     }
-    
+
     ~ThreadPool() {
-        {
-            std::lock_guard<std::mutex> lock(queue_mutex_);
-            running_ = false;
+        running_.store(false, std::memory_order_release);
+        for (auto& state : states_) {
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+            }
+            state->cv.notify_one();
         }
-        condition_.notify_all();
         for (auto& worker : workers_) {
             if (worker.joinable()) worker.join();
         }
     }
-    
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
     template<typename F>
     void enqueue(F&& f) {
-        {
-            std::lock_guard<std::mutex> lock(queue_mutex_);
-            tasks_.emplace(std::forward<F>(f));
+        push(Task(std::forward<F>(f)));
+
+        // 与 park() 配对：发布任务后再检查休眠线程，保证任务要么被唤醒者取走，要么被休眠前的复查发现
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (spinning_.load(std::memory_order_relaxed) == 0 &&
+            sleepers_.load(std::memory_order_relaxed) > 0) {
+            wakeOne();
+        }
+    }
+
+    // 投递到指定工作线程执行（不会被其他线程窃取）；目标线程休眠时才唤醒
+    template<typename F>
+    void enqueueTo(size_t worker, F&& f) {
+        WorkerState& state = *states_[worker % states_.size()];
+        Task task(std::forward<F>(f));
+        if (!state.affine.push(task)) {
+            // 专属队列已满（单个线程上积压了上千个任务）：退回共享队列，放弃亲和性但不丢任务
+            enqueue(std::move(task));
+            return;
+        }
+
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (state.sleeping.load(std::memory_order_relaxed)) {
+            unpark(state);
+        }
+    }
+
+    size_t size() const { return workers_.size(); }
+
+    // 排队中的任务数（各队列的近似值之和，仅用于统计）
+    size_t queueDepth() const {
+        size_t depth = overflow_size_.load(std::memory_order_relaxed);
+        for (const auto& state : states_) {
+            depth += state->queue.size() + state->affine.size();
         }
-        condition_.notify_one();
+        return depth;
+    }
+
+    // 将工作线程绑定到指定 CPU，失败返回 false（errno 由 pthread_setaffinity_np 给出）
+    bool pinWorker(size_t worker, int cpu) {
+        if (worker >= workers_.size() || cpu < 0 || cpu >= CPU_SETSIZE) return false;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        int ret = pthread_setaffinity_np(workers_[worker].native_handle(), sizeof(set), &set);
+        if (ret != 0) {
+            errno = ret;
+            return false;
+        }
+        return true;
     }
 
 private:
+    static constexpr size_t kQueueCapacity = 1024;
+    static constexpr int kSpinRounds = 64;
+    static constexpr size_t kCacheLine = 64;
+
+    // 有界多生产者/多消费者无锁队列（每个槽位带序号，Vyukov 算法），任务按值存放在槽位中
+    class WorkQueue {
+    public:
+        explicit WorkQueue(size_t capacity) : cells_(capacity), mask_(capacity - 1) {
+            for (size_t i = 0; i < capacity; ++i) {
+                cells_[i].seq.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        bool push(Task& task) {
+            size_t pos = tail_.load(std::memory_order_relaxed);
+            while (true) {
+                Cell& cell = cells_[pos & mask_];
+                const size_t seq = cell.seq.load(std::memory_order_acquire);
+                const intptr_t dif = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+                if (dif == 0) {
+                    if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        cell.task = std::move(task);
+                        cell.seq.store(pos + 1, std::memory_order_release);
+                        return true;
+                    }
+                } else if (dif < 0) {
+                    return false; // 队列已满
+                } else {
+                    pos = tail_.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        bool pop(Task& task) {
+            size_t pos = head_.load(std::memory_order_relaxed);
+            while (true) {
+                Cell& cell = cells_[pos & mask_];
+                const size_t seq = cell.seq.load(std::memory_order_acquire);
+                const intptr_t dif = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+                if (dif == 0) {
+                    if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        task = std::move(cell.task);
+                        cell.seq.store(pos + mask_ + 1, std::memory_order_release);
+                        return true;
+                    }
+                } else if (dif < 0) {
+                    return false; // 队列为空（或生产者尚未写完该槽位）
+                } else {
+                    pos = head_.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        bool empty() const {
+            return head_.load(std::memory_order_relaxed) == tail_.load(std::memory_order_relaxed);
+        }
+
+        size_t size() const {
+            const size_t head = head_.load(std::memory_order_relaxed);
+            const size_t tail = tail_.load(std::memory_order_relaxed);
+            return tail > head ? tail - head : 0;
+        }
+
+    private:
+        struct Cell {
+            std::atomic<size_t> seq;
+            Task task;
+        };
+
+        std::vector<Cell> cells_;
+        const size_t mask_;
+        alignas(kCacheLine) std::atomic<size_t> head_{0};
+        alignas(kCacheLine) std::atomic<size_t> tail_{0};
+    };
+
+    // 每个工作线程的队列与休眠状态
+    struct WorkerState {
+        WorkQueue queue{kQueueCapacity};  // 共享队列，可被其他线程窃取
+        WorkQueue affine{kQueueCapacity}; // 专属队列，只由本线程取出
+        std::atomic<bool> sleeping{false};
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool notified = false; // 受 mutex 保护
+    };
+
+    // 当前线程所属的线程池及工作线程下标（非工作线程为 nullptr）
+    struct WorkerContext {
+        const ThreadPool* pool = nullptr;
+        size_t index = 0;
+        size_t next = 0; // 外部线程轮流投递的起始队列
+    };
+
+    static WorkerContext& context() {
+        thread_local WorkerContext ctx;
+        return ctx;
+    }
+
+    void push(Task task) {
+        WorkerContext& ctx = context();
+        const size_t n = states_.size();
+        const size_t start = ctx.pool == this ? ctx.index : ctx.next++ % n;
+        for (size_t i = 0; i < n; ++i) {
+            if (states_[(start + i) % n]->queue.push(task)) return;
+        }
+
+        std::lock_guard<std::mutex> lock(overflow_mutex_);
+        overflow_.push_back(std::move(task));
+        overflow_size_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // 先取自己的专属队列和共享队列，再从其他线程的共享队列窃取，最后检查溢出队列
+    bool findTask(size_t index, Task& task) {
+        if (states_[index]->affine.pop(task)) return true;
+        const size_t n = states_.size();
+        for (size_t i = 0; i < n; ++i) {
+            if (states_[(index + i) % n]->queue.pop(task)) return true;
+        }
+        if (overflow_size_.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<std::mutex> lock(overflow_mutex_);
+            if (!overflow_.empty()) {
+                task = std::move(overflow_.front());
+                overflow_.pop_front();
+                overflow_size_.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // 线程 index 可以取到的任务（自己的专属队列 + 所有共享队列）
+    bool hasWork(size_t index) const {
+        if (!states_[index]->affine.empty()) return true;
+        for (const auto& state : states_) {
+            if (!state->queue.empty()) return true;
+        }
+        return overflow_size_.load(std::memory_order_relaxed) > 0;
+    }
+
+    void workerLoop(size_t index) {
+        WorkerContext& ctx = context();
+        ctx.pool = this;
+        ctx.index = index;
+
+        Task task;
+        int idle_rounds = 0;
+        while (true) {
+            if (findTask(index, task)) {
+                // 最后一个自旋线程转去执行任务时，若仍有积压则唤醒一个休眠线程接手
+                if (spinning_.fetch_sub(1, std::memory_order_seq_cst) == 1 &&
+                    sleepers_.load(std::memory_order_relaxed) > 0 && hasWork(index)) {
+                    wakeOne();
+                }
+                task();
+                task.reset();
+                spinning_.fetch_add(1, std::memory_order_seq_cst);
+                idle_rounds = 0;
+                continue;
+            }
+
+            if (!running_.load(std::memory_order_acquire)) break;
+
+            if (++idle_rounds < kSpinRounds) {
+                cpuRelax();
+                continue;
+            }
+            idle_rounds = 0;
+            park(index);
+        }
+        spinning_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void park(size_t index) {
+        WorkerState& state = *states_[index];
+        spinning_.fetch_sub(1, std::memory_order_seq_cst);
+        sleepers_.fetch_add(1, std::memory_order_seq_cst);
+        state.sleeping.store(true, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        // 声明休眠后复查一次，与 enqueue / enqueueTo 中的检查配对，避免丢失唤醒
+        if (!hasWork(index)) {
+            std::unique_lock<std::mutex> lock(state.mutex);
+            state.cv.wait(lock, [&] {
+                return state.notified || !running_.load(std::memory_order_relaxed);
+            });
+        }
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            state.notified = false;
+        }
+        state.sleeping.store(false, std::memory_order_relaxed);
+
+        // 先恢复自旋计数再撤销休眠计数，期间 enqueue 不会重复唤醒
+        spinning_.fetch_add(1, std::memory_order_seq_cst);
+        sleepers_.fetch_sub(1, std::memory_order_seq_cst);
+    }
+
+    // 唤醒任意一个休眠线程（它醒来后会扫描所有共享队列）
+    void wakeOne() {
+        const size_t n = states_.size();
+        const size_t start = wake_cursor_.fetch_add(1, std::memory_order_relaxed);
+        for (size_t i = 0; i < n; ++i) {
+            WorkerState& state = *states_[(start + i) % n];
+            if (state.sleeping.load(std::memory_order_seq_cst)) {
+                unpark(state);
+                return;
+            }
+        }
+    }
+
+    static void unpark(WorkerState& state) {
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            if (state.notified) return; // 已有唤醒在途
+            state.notified = true;
+        }
+        state.cv.notify_one();
+    }
+
+    static void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#else
+        std::this_thread::yield();
+#endif
+    }
+
     std::vector<std::thread> workers_;
-    std::queue<std::function<void()>> tasks_;
-    std::mutex queue_mutex_;
-    std::condition_variable condition_;
+    std::vector<std::unique_ptr<WorkerState>> states_;
     std::atomic<bool> running_;
-};
\ No newline at end of file
+
+    // 所有无锁队列已满时的后备队列
+    std::mutex overflow_mutex_;
+    std::deque<Task> overflow_;
+    std::atomic<size_t> overflow_size_{0};
+
+    // 空闲线程状态：自旋中 / 休眠中的线程数
+    alignas(kCacheLine) std::atomic<size_t> spinning_{0};
+    alignas(kCacheLine) std::atomic<size_t> sleepers_{0};
+    std::atomic<size_t> wake_cursor_{0};
+};
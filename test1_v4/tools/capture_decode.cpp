@@ -0,0 +1,144 @@
+// capture_decode.cpp
+// 抓包文件离线解码：按原文本日志格式输出（接收报文为十六进制，转发报文为 UTF-8 文本）
+// 用法: ./capture_decode [--channel <name>] <file.cap>...
+//   指定 --channel 时只输出该通道，格式与原通道日志文件逐行一致；
+//   否则输出全部通道，每行前加 "<通道名>\t"
+#include "../traffic_capture.h"
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+// 与 LogRecord 相同的时间格式：YYYY-mm-dd HH:MM:SS.mmm（本地时间）
+std::string formatTime(uint64_t wallNs) {
+    std::time_t seconds = static_cast<std::time_t>(wallNs / 1000000000ull);
+    const unsigned millis = static_cast<unsigned>(wallNs / 1000000ull % 1000);
+    std::tm tm;
+    localtime_r(&seconds, &tm);
+    char buffer[40];
+    size_t len = strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &tm);
+    snprintf(buffer + len, sizeof(buffer) - len, ".%03u", millis);
+    return buffer;
+}
+
+const char* const kPrefixes[4] = {"[NODE1 RECV]", "[NODE2 RECV]", "[NODE1->NODE2]", "[NODE2->NODE1]"};
+
+void printRecord(const std::string& channel, const std::string& time, uint8_t direction,
+                 const uint8_t* data, size_t len, bool tagChannel, std::string& line) {
+    static const char kHex[] = "0123456789abcdef";
+    line.clear();
+    if (tagChannel) {
+        line += channel;
+        line += '\t';
+    }
+    line += time;
+
+    if (direction <= static_cast<uint8_t>(capture::Direction::Node2Recv)) {
+        // LOG_BINARY：时间 前缀字节数 bytes: 十六进制
+        line += ' ';
+        line += kPrefixes[direction];
+        line += std::to_string(len);
+        line += " bytes: ";
+        for (size_t i = 0; i < len; ++i) {
+            line += kHex[data[i] >> 4];
+            line += kHex[data[i] & 0x0F];
+            if (i < len - 1) line += ' ';
+        }
+    } else {
+        // LOG_BINARY_TEXT：时间 [INFO ] [通道] 前缀 字节数 bytes: 文本（遇到 NUL 截断）
+        line += " [INFO ] [";
+        line += channel;
+        line += "] ";
+        line += direction < 4 ? kPrefixes[direction] : "[UNKNOWN]";
+        line += ' ';
+        line += std::to_string(len);
+        line += " bytes: ";
+        const void* nul = memchr(data, 0, len);
+        line.append(reinterpret_cast<const char*>(data),
+                    nul ? static_cast<const uint8_t*>(nul) - data : len);
+    }
+    line += '\n';
+    fwrite(line.data(), 1, line.size(), stdout);
+}
+
+bool decodeFile(const char* path, const char* onlyChannel) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << path << ": cannot open" << std::endl;
+        return false;
+    }
+    std::vector<uint8_t> content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    capture::FileHeader header;
+    if (content.size() < sizeof(header)) {
+        std::cerr << path << ": file too short" << std::endl;
+        return false;
+    }
+    std::memcpy(&header, content.data(), sizeof(header));
+    if (std::memcmp(header.magic, capture::kMagic, sizeof(header.magic)) != 0 ||
+        header.version != capture::kVersion || header.headerSize < sizeof(header)) {
+        std::cerr << path << ": not a capture file (or unsupported version)" << std::endl;
+        return false;
+    }
+
+    std::map<uint16_t, std::string> channels;
+    std::string line;
+    size_t offset = header.headerSize;
+    while (offset + sizeof(capture::RecordHeader) <= content.size()) {
+        capture::RecordHeader record;
+        std::memcpy(&record, content.data() + offset, sizeof(record));
+        if (record.length == 0) break; // 分段未写满 / 进程异常退出时未提交的记录
+        if (record.length < sizeof(record) || offset + record.length > content.size()) {
+            std::cerr << path << ": corrupt record at offset " << offset << std::endl;
+            return false;
+        }
+
+        const uint8_t* payload = content.data() + offset + sizeof(record);
+        const size_t len = record.length - sizeof(record);
+        if (record.type == static_cast<uint8_t>(capture::RecordType::Channel)) {
+            channels[record.channel].assign(reinterpret_cast<const char*>(payload), len);
+        } else if (record.type == static_cast<uint8_t>(capture::RecordType::Data)) {
+            auto it = channels.find(record.channel);
+            const std::string name = it != channels.end() ? it->second
+                                                          : "channel#" + std::to_string(record.channel);
+            if (!onlyChannel || name == onlyChannel) {
+                // 单调时钟时间戳按分段头记录的对应关系换算为墙上时间
+                const uint64_t wallNs = header.realtimeNs + (record.timestampNs - header.monotonicNs);
+                printRecord(name, formatTime(wallNs), record.direction, payload, len, onlyChannel == nullptr, line);
+            }
+        }
+        offset += capture::recordSize(len);
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const char* onlyChannel = nullptr;
+    std::vector<const char*> files;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--channel") == 0 && i + 1 < argc) {
+            onlyChannel = argv[++i];
+        } else {
+            files.push_back(argv[i]);
+        }
+    }
+    if (files.empty()) {
+        std::cerr << "Usage: " << argv[0] << " [--channel <name>] <file.cap>..." << std::endl;
+        return 1;
+    }
+
+    bool ok = true;
+    for (const char* path : files) {
+        ok = decodeFile(path, onlyChannel) && ok;
+    }
+    return ok ? 0 : 1;
+}
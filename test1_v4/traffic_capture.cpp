@@ -0,0 +1,239 @@
+// traffic_capture.cpp
+#include "traffic_capture.h"
+#include "logrecord.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using capture::Direction;
+using capture::FileHeader;
+using capture::RecordHeader;
+using capture::RecordType;
+
+namespace {
+constexpr size_t kPageSize = 4096;
+
+uint64_t clockNs(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+}
+
+// 预留空间并写入一条记录；分段剩余空间不足时返回 false
+bool appendRecord(uint8_t* base, size_t size, std::atomic<uint64_t>& offset,
+                  RecordType type, uint16_t channel, Direction direction,
+                  const uint8_t* data, size_t len) {
+    const size_t total = capture::recordSize(len);
+    const uint64_t pos = offset.fetch_add(total, std::memory_order_relaxed);
+    if (pos + total > size) return false;
+
+    auto* header = reinterpret_cast<RecordHeader*>(base + pos);
+    header->channel = channel;
+    header->type = static_cast<uint8_t>(type);
+    header->direction = static_cast<uint8_t>(direction);
+    header->timestampNs = clockNs(CLOCK_MONOTONIC);
+    if (len > 0) std::memcpy(header + 1, data, len);
+    // 长度最后写入：读取方看到非零长度时整条记录已完整
+    __atomic_store_n(&header->length, static_cast<uint32_t>(sizeof(RecordHeader) + len), __ATOMIC_RELEASE);
+    return true;
+}
+} // namespace
+
+TrafficCapture& TrafficCapture::getInstance() {
+    static TrafficCapture instance;
+    return instance;
+}
+
+TrafficCapture::~TrafficCapture() {
+    close();
+}
+
+bool TrafficCapture::open(const std::string& dir, size_t segmentSize) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_current.load(std::memory_order_acquire)) return true;
+
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    if (ec) {
+        LOG_ERROR("Traffic capture: cannot create %s: %s", dir.c_str(), ec.message().c_str());
+        return false;
+    }
+
+    _dir = dir;
+    _segmentSize = (std::max(segmentSize, kMinSegmentSize) + kPageSize - 1) & ~(kPageSize - 1);
+
+    // 文件名前缀：traffic-<启动时间>-<pid>，分段序号递增
+    char stamp[32];
+    std::time_t now = std::time(nullptr);
+    std::tm tm;
+    localtime_r(&now, &tm);
+    strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", &tm);
+    _prefix = std::string("traffic-") + stamp + "-" + std::to_string(getpid());
+    _nextSegment = 0;
+
+    Segment* segment = createSegment();
+    if (!segment) return false;
+    _current.store(segment, std::memory_order_seq_cst);
+    LOG_INFO("Traffic capture enabled: %s/%s.*.cap (%zu MB segments)",
+             _dir.c_str(), _prefix.c_str(), _segmentSize / (1024 * 1024));
+    return true;
+}
+
+void TrafficCapture::close() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    Segment* segment = _current.exchange(nullptr, std::memory_order_seq_cst);
+    if (segment) {
+        _retired.push_back(segment);
+    }
+    reclaimRetired(true);
+    if (segment) {
+        LOG_INFO("Traffic capture closed");
+    }
+}
+
+void TrafficCapture::write(int channel, Direction direction, const uint8_t* data, size_t len) {
+    if (channel < 0) return;
+    // 超过半个分段的记录不保存（分段最小 1MB，远大于单次读取的数据量），保证切换后一定写得下
+    if (capture::recordSize(len) > _segmentSize / 2) return;
+
+    while (true) {
+        Segment* segment = _current.load(std::memory_order_seq_cst);
+        if (!segment) return;
+
+        // 先登记写入者再复查：分段只有在被切换出去且没有写入者时才解除映射
+        segment->writers.fetch_add(1, std::memory_order_seq_cst);
+        if (_current.load(std::memory_order_seq_cst) != segment) {
+            segment->writers.fetch_sub(1, std::memory_order_release);
+            continue;
+        }
+        const bool written = appendRecord(segment->base, segment->size, segment->offset, RecordType::Data,
+                                          static_cast<uint16_t>(channel), direction, data, len);
+        segment->writers.fetch_sub(1, std::memory_order_release);
+        if (written) return;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        rotate(segment);
+    }
+}
+
+int TrafficCapture::registerChannel(const std::string& name) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    Segment* segment = _current.load(std::memory_order_acquire);
+    if (!segment) return -1;
+
+    // 同名通道（如配置更新后重建）沿用原 ID
+    auto it = std::find(_channels.begin(), _channels.end(), name);
+    if (it != _channels.end()) {
+        return static_cast<int>(it - _channels.begin());
+    }
+    if (_channels.size() > UINT16_MAX) {
+        LOG_WARNING("Traffic capture: too many channels, %s not captured", name.c_str());
+        return -1;
+    }
+
+    const uint16_t id = static_cast<uint16_t>(_channels.size());
+    _channels.push_back(name);
+    // 持有 _mutex 期间当前分段不会被切换；空间不足时切换，新分段开头会写入全部通道定义
+    if (!appendRecord(segment->base, segment->size, segment->offset, RecordType::Channel, id,
+                      Direction::Node1Recv, reinterpret_cast<const uint8_t*>(name.data()), name.size())) {
+        rotate(segment);
+    }
+    return id;
+}
+
+TrafficCapture::Segment* TrafficCapture::createSegment() {
+    const uint32_t number = _nextSegment++;
+    const std::string path = _dir + "/" + _prefix + "." + std::to_string(number) + ".cap";
+
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        LOG_ERROR("Traffic capture: cannot open %s: %s", path.c_str(), strerror(errno));
+        return nullptr;
+    }
+    // 预分配磁盘空间，写入时不会因分配块而阻塞；文件系统不支持时退化为稀疏文件
+    int ret = posix_fallocate(fd, 0, static_cast<off_t>(_segmentSize));
+    if (ret != 0 && ftruncate(fd, static_cast<off_t>(_segmentSize)) != 0) {
+        LOG_ERROR("Traffic capture: cannot allocate %s: %s", path.c_str(), strerror(errno));
+        ::close(fd);
+        return nullptr;
+    }
+    void* base = mmap(nullptr, _segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        LOG_ERROR("Traffic capture: mmap %s failed: %s", path.c_str(), strerror(errno));
+        ::close(fd);
+        return nullptr;
+    }
+
+    auto segment = std::make_unique<Segment>();
+    segment->fd = fd;
+    segment->base = static_cast<uint8_t*>(base);
+    segment->size = _segmentSize;
+    segment->mapped = true;
+
+    FileHeader header{};
+    std::memcpy(header.magic, capture::kMagic, sizeof(header.magic));
+    header.version = capture::kVersion;
+    header.headerSize = sizeof(FileHeader);
+    header.realtimeNs = clockNs(CLOCK_REALTIME);
+    header.monotonicNs = clockNs(CLOCK_MONOTONIC);
+    header.segment = number;
+    std::memcpy(segment->base, &header, sizeof(header));
+    segment->offset.store(sizeof(FileHeader), std::memory_order_relaxed);
+
+    // 每个分段自带通道定义，可单独解码
+    for (size_t id = 0; id < _channels.size(); ++id) {
+        appendRecord(segment->base, segment->size, segment->offset, RecordType::Channel,
+                     static_cast<uint16_t>(id), Direction::Node1Recv,
+                     reinterpret_cast<const uint8_t*>(_channels[id].data()), _channels[id].size());
+    }
+
+    _segments.push_back(std::move(segment));
+    return _segments.back().get();
+}
+
+void TrafficCapture::rotate(Segment* full) {
+    // 其他线程已完成切换
+    if (_current.load(std::memory_order_seq_cst) != full) return;
+
+    Segment* next = createSegment();
+    _current.store(next, std::memory_order_seq_cst);
+    _retired.push_back(full);
+    if (!next) {
+        LOG_ERROR("Traffic capture stopped: cannot create next segment");
+    }
+    reclaimRetired(false);
+}
+
+void TrafficCapture::reclaimRetired(bool wait) {
+    // wait 时最多等待 100ms，让仍在 memcpy 的写入线程完成
+    for (int attempt = 0; !_retired.empty(); ++attempt) {
+        auto it = std::remove_if(_retired.begin(), _retired.end(), [this](Segment* segment) {
+            if (segment->writers.load(std::memory_order_seq_cst) != 0) return false;
+            release(*segment);
+            return true;
+        });
+        _retired.erase(it, _retired.end());
+        if (!wait || _retired.empty() || attempt >= 100) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+void TrafficCapture::release(Segment& segment) {
+    if (!segment.mapped) return;
+    // 截掉未使用的预分配空间
+    const uint64_t used = std::min<uint64_t>(segment.offset.load(std::memory_order_relaxed), segment.size);
+    munmap(segment.base, segment.size);
+    if (ftruncate(segment.fd, static_cast<off_t>(used)) != 0) {
+        LOG_WARNING("Traffic capture: truncate failed: %s", strerror(errno));
+    }
+    ::close(segment.fd);
+    segment.base = nullptr;
+    segment.fd = -1;
+    segment.mapped = false;
+}
@@ -0,0 +1,114 @@
+// traffic_capture.h
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// 二进制流量抓包：替代十六进制文本的 LOG_BINARY
+// - 记录 = 16 字节头（长度、通道 ID、类型、方向、单调时钟时间戳）+ 原始字节，按 8 字节对齐
+// - 写入预分配并内存映射的分段文件；写满后切换到下一个分段
+// - 多个线程并发写入：原子地预留空间后直接 memcpy，不加锁、不做系统调用
+// 文件格式见下方结构体，离线解码工具为 tools/capture_decode.cpp
+namespace capture {
+
+constexpr char kMagic[8] = {'P', 'C', 'C', 'A', 'P', 'T', '0', '1'};
+constexpr uint32_t kVersion = 1;
+
+// 分段文件头（64 字节）
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;     // sizeof(FileHeader)，记录从此偏移开始
+    uint64_t realtimeNs;     // 创建分段时的 CLOCK_REALTIME
+    uint64_t monotonicNs;    // 同一时刻的 CLOCK_MONOTONIC，用于把记录时间戳换算为墙上时间
+    uint32_t segment;        // 分段序号
+    uint32_t reserved[7];
+};
+static_assert(sizeof(FileHeader) == 64, "capture file header must be 64 bytes");
+
+enum class RecordType : uint8_t {
+    Channel = 1, // 通道定义：payload 为通道名称
+    Data = 2     // 数据：payload 为原始字节
+};
+
+// 数据方向（与文本日志中的前缀一一对应）
+enum class Direction : uint8_t {
+    Node1Recv = 0,    // [NODE1 RECV]
+    Node2Recv = 1,    // [NODE2 RECV]
+    Node1ToNode2 = 2, // [NODE1->NODE2]
+    Node2ToNode1 = 3  // [NODE2->NODE1]
+};
+
+// 记录头：length 最后写入（release），为 0 表示分段内后续没有已提交的记录
+struct RecordHeader {
+    uint32_t length;      // 记录字节数（含记录头，不含对齐填充）
+    uint16_t channel;
+    uint8_t type;
+    uint8_t direction;
+    uint64_t timestampNs; // CLOCK_MONOTONIC
+};
+static_assert(sizeof(RecordHeader) == 16, "capture record header must be 16 bytes");
+
+inline size_t recordSize(size_t payload) {
+    return (sizeof(RecordHeader) + payload + 7) & ~static_cast<size_t>(7);
+}
+
+} // namespace capture
+
+class TrafficCapture {
+public:
+    static TrafficCapture& getInstance();
+
+    // 在 dir 下创建分段文件（每段 segmentSize 字节，预分配），失败返回 false
+    bool open(const std::string& dir, size_t segmentSize);
+    // 写出并截断当前分段，之后的写入被忽略
+    void close();
+    bool enabled() const { return _current.load(std::memory_order_acquire) != nullptr; }
+
+    // 注册通道，返回记录中使用的通道 ID；未启用时返回 -1
+    int registerChannel(const std::string& name);
+
+    void write(int channel, capture::Direction direction, const uint8_t* data, size_t len);
+
+    static constexpr size_t kDefaultSegmentSize = 64 * 1024 * 1024;
+    static constexpr size_t kMinSegmentSize = 1024 * 1024;
+
+private:
+    struct Segment {
+        int fd = -1;
+        uint8_t* base = nullptr;
+        size_t size = 0;
+        std::atomic<uint64_t> offset{0};  // 下一条记录的预留位置
+        std::atomic<uint32_t> writers{0}; // 正在写入该分段的线程数
+        bool mapped = false;
+    };
+
+    TrafficCapture() = default;
+    ~TrafficCapture();
+    TrafficCapture(const TrafficCapture&) = delete;
+    TrafficCapture& operator=(const TrafficCapture&) = delete;
+
+    // 以下函数需持有 _mutex
+    Segment* createSegment();
+    void appendChannelRecord(Segment& segment, uint16_t id, const std::string& name);
+    void rotate(Segment* full);
+    void reclaimRetired(bool wait);
+    void release(Segment& segment);
+
+    std::atomic<Segment*> _current{nullptr};
+    std::mutex _mutex;
+    std::string _dir;
+    std::string _prefix;
+    size_t _segmentSize = kDefaultSegmentSize;
+    uint32_t _nextSegment = 0;
+    std::vector<std::string> _channels; // 下标即通道 ID
+    // 分段对象（几十字节）直到进程退出才释放：写入线程可能仍持有已退役分段的指针，
+    // 解除映射前通过 writers 计数确认没有线程在写
+    std::deque<std::unique_ptr<Segment>> _segments;
+    std::vector<Segment*> _retired; // 已切换出去、尚未解除映射的分段
+};
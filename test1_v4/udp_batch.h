@@ -0,0 +1,105 @@
+// udp_batch.h
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+
+// UDP 批量收发辅助：recvmmsg 一次取出多个数据报，sendmmsg 一次发往多个地址
+// 缓冲区在构造时一次分配，收发路径上不再分配内存（非线程安全，由调用方串行使用）
+
+// 批量接收缓冲区：每个槽位对应一个数据报及其来源地址
+class UdpRecvBatch {
+public:
+    static constexpr size_t kBatchSize = 64;
+
+    explicit UdpRecvBatch(size_t datagramSize)
+        : _datagramSize(datagramSize), _buffer(kBatchSize * datagramSize),
+          _msgs(kBatchSize), _iovs(kBatchSize), _addrs(kBatchSize) {
+        for (size_t i = 0; i < kBatchSize; ++i) {
+            _iovs[i].iov_base = _buffer.data() + i * _datagramSize;
+            _iovs[i].iov_len = _datagramSize;
+            std::memset(&_msgs[i].msg_hdr, 0, sizeof(_msgs[i].msg_hdr));
+            _msgs[i].msg_hdr.msg_name = &_addrs[i];
+            _msgs[i].msg_hdr.msg_iov = &_iovs[i];
+            _msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+    }
+
+    UdpRecvBatch(const UdpRecvBatch&) = delete;
+    UdpRecvBatch& operator=(const UdpRecvBatch&) = delete;
+
+    // 非阻塞读取最多 kBatchSize 个数据报，返回数量；无数据时返回 0，出错返回 -1
+    int receive(int fd) {
+        // 地址长度是输入输出参数，每次接收前复位
+        for (auto& msg : _msgs) {
+            msg.msg_hdr.msg_namelen = sizeof(sockaddr_in);
+        }
+
+        int n = recvmmsg(fd, _msgs.data(), kBatchSize, MSG_DONTWAIT, nullptr);
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+            return 0;
+        }
+        return n;
+    }
+
+    const uint8_t* data(int i) const { return _buffer.data() + i * _datagramSize; }
+    size_t length(int i) const { return _msgs[i].msg_len; }
+    const sockaddr_in& address(int i) const { return _addrs[i]; }
+
+private:
+    const size_t _datagramSize;
+    std::vector<uint8_t> _buffer;
+    std::vector<mmsghdr> _msgs;
+    std::vector<iovec> _iovs;
+    std::vector<sockaddr_in> _addrs;
+};
+
+// 将同一个数据报（iovec 描述）发送到多个地址，每批 kBatchSize 个地址一次 sendmmsg
+class UdpFanout {
+public:
+    static constexpr size_t kBatchSize = 64;
+
+    UdpFanout() : _msgs(kBatchSize) {}
+
+    UdpFanout(const UdpFanout&) = delete;
+    UdpFanout& operator=(const UdpFanout&) = delete;
+
+    // 逐个目标回调 onError(addrIndex, errno)，返回成功发送的目标数
+    template <typename ErrorHandler>
+    size_t send(int fd, const struct iovec* iov, int iovcnt,
+                const sockaddr_in* addrs, size_t count, ErrorHandler&& onError) {
+        size_t sent = 0;
+        size_t done = 0;
+        while (done < count) {
+            const size_t batch = std::min(kBatchSize, count - done);
+            for (size_t i = 0; i < batch; ++i) {
+                msghdr& hdr = _msgs[i].msg_hdr;
+                std::memset(&hdr, 0, sizeof(hdr));
+                hdr.msg_name = const_cast<sockaddr_in*>(&addrs[done + i]);
+                hdr.msg_namelen = sizeof(sockaddr_in);
+                hdr.msg_iov = const_cast<struct iovec*>(iov);
+                hdr.msg_iovlen = iovcnt;
+            }
+
+            int n = sendmmsg(fd, _msgs.data(), batch, MSG_DONTWAIT);
+            if (n <= 0) {
+                // 第一个目标即失败：报告后跳过该目标继续发送其余目标
+                onError(done, n < 0 ? errno : EIO);
+                ++done;
+                continue;
+            }
+            sent += n;
+            done += n;
+        }
+        return sent;
+    }
+
+private:
+    std::vector<mmsghdr> _msgs;
+};
@@ -32,89 +32,121 @@ bool UdpClientEndpoint::open() {
         return false;
     }
 
-    // 创建epoll实例
-    _epollFd = epoll_create1(0);
-    if (_epollFd < 0) {
-        logError("Epoll creation failed: " + std::string(strerror(errno)));
-        ::close(_socketFd);
-        _socketFd = -1;
-        return false;
+    // 注册到事件循环（io_uring 后端使用多发接收，由 addFd 的 EPOLLIN 开启）
+    EventLoop* loop = getEventLoop();
+    if (loop->hasIoUring()) {
+        loop->addRecv(_socketFd, true, false,
+                      [this](const uint8_t* data, ssize_t len, const sockaddr_in*) {
+                          if (len > 0) {
+                              processData(data, len);
+                          } else if (len < 0) {
+                              logError("Recv error: " + std::string(strerror(-len)));
+                          }
+                      });
     }
-
-    // 添加socket到epoll
-    epoll_event event{};
-    event.events = EPOLLIN;
-    event.data.fd = _socketFd;
-    if (epoll_ctl(_epollFd, EPOLL_CTL_ADD, _socketFd, &event) < 0) {
+    // epoll 负责发送缓冲区满后的可写通知（未使用 io_uring 接收时同时负责读事件）
+    if (!loop->addFd(_socketFd, readEvents(), [this](uint32_t events) {
+            if (events & EPOLLOUT) handleWritable();
+            if (events & EPOLLIN) handleData();
+        })) {
         logError("Epoll_ctl failed: " + std::string(strerror(errno)));
-        ::close(_epollFd);
+        loop->removeFd(_socketFd);
         ::close(_socketFd);
-        _epollFd = -1;
         _socketFd = -1;
         return false;
     }
-
+    
+    _running = true;
     setState(State::CONNECTED);
-    startThread();
     logMessage("UDP client connected to " + _host + ":" + std::to_string(_port));
     return true;
 }
 
 void UdpClientEndpoint::close() {
-    stopThread();
-    
-    if (_epollFd >= 0) {
-        ::close(_epollFd);
-        _epollFd = -1;
-    }
+    if (!_running.exchange(false)) return;
     
+    // 注销后事件循环不会再回调本端点
     if (_socketFd >= 0) {
+        getEventLoop()->removeFd(_socketFd);
+        std::lock_guard<std::mutex> lock(_mutex);
         ::close(_socketFd);
         _socketFd = -1;
+        _writeBlocked = false;
     }
     
     setState(State::DISCONNECTED);
     logMessage("UDP client disconnected");
 }
 
+void UdpClientEndpoint::updateReadInterest() {
+    // 读暂停期间数据报留在 socket 接收缓冲区，溢出时由内核丢弃
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_socketFd >= 0) {
+        getEventLoop()->modifyFd(_socketFd, readEvents() | (_writeBlocked ? static_cast<uint32_t>(EPOLLOUT) : 0u));
+    }
+}
+
 void UdpClientEndpoint::write(const uint8_t* data, size_t len) {
     if (!isConnected()) return;
     
     std::lock_guard<std::mutex> lock(_mutex);
+    struct iovec iov{const_cast<uint8_t*>(data), len};
+    if (getEventLoop()->sendTo(_socketFd, &iov, 1, &_serverAddr, 1)) return;
     if (sendto(_socketFd, data, len, 0, 
               (sockaddr*)&_serverAddr, sizeof(_serverAddr)) < 0) {
         logError("Sendto failed: " + std::string(strerror(errno)));
     }
 }
 
-void UdpClientEndpoint::run() {
-    constexpr int MAX_EVENTS = 10;
-    epoll_event events[MAX_EVENTS];
-    
-    while (isRunning()) {
-        int numEvents = epoll_wait(_epollFd, events, MAX_EVENTS, 100);
-        if (numEvents < 0) {
-            if (errno != EINTR) {
-                logError("Epoll_wait error: " + std::string(strerror(errno)));
-            }
-            continue;
-        }
+ssize_t UdpClientEndpoint::writev(const struct iovec* iov, int iovcnt) {
+    const size_t total = iovLength(iov, iovcnt);
+    if (!isConnected()) return -1;
 
-        for (int i = 0; i < numEvents; ++i) {
-            if (events[i].data.fd == _socketFd) {
-                handleData();
-            }
+    // 多段数据合并为一个数据报发送
+    msghdr msg{};
+    msg.msg_name = &_serverAddr;
+    msg.msg_namelen = sizeof(_serverAddr);
+    msg.msg_iov = const_cast<struct iovec*>(iov);
+    msg.msg_iovlen = iovcnt;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (getEventLoop()->sendTo(_socketFd, iov, iovcnt, &_serverAddr, 1)) return total;
+    if (sendmsg(_socketFd, &msg, 0) >= 0) return total;
+    const int err = errno;
+
+    // 发送缓冲区已满：数据报留给调用方，注册 EPOLLOUT，可写后通知调用方重试
+    if (err == EAGAIN || err == EWOULDBLOCK) {
+        if (!_writeBlocked) {
+            _writeBlocked = getEventLoop()->modifyFd(_socketFd, readEvents() | EPOLLOUT);
         }
+        if (_writeBlocked) return 0;
     }
+    // 其他错误（ENOBUFS 等）只影响这个数据报：由调用方丢弃，端点状态不变
+    reportError("Sendto failed: " + std::string(strerror(err)));
+    return -1;
+}
+
+void UdpClientEndpoint::handleWritable() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_writeBlocked) return;
+        getEventLoop()->modifyFd(_socketFd, readEvents());
+        _writeBlocked = false;
+    }
+    notifyWritable();
 }
 
 void UdpClientEndpoint::handleData() {
-    uint8_t buffer[4096];
-    ssize_t bytesRead = recv(_socketFd, buffer, sizeof(buffer), 0);
-    
-    if (bytesRead > 0) {
-        processData(buffer, bytesRead);
-    } else if (bytesRead < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+    // 一次 recvmmsg 取出最多 kBatchSize 个数据报；剩余数据由水平触发的 epoll 再次通知
+    int count = _recvBatch.receive(_socketFd);
+    if (count < 0) {
         logError("Recv error: " + std::string(strerror(errno)));
+        return;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        if (_recvBatch.length(i) > 0) {
+            processData(_recvBatch.data(i), _recvBatch.length(i));
+        }
     }
-}
\ No newline at end of file
+}
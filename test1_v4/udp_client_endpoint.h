@@ -1,6 +1,7 @@
 // udp_client_endpoint.h
 #pragma once
 #include "endpoint.h"
+#include "udp_batch.h"
 #include <sys/epoll.h>
 #include <netinet/in.h>  // 添加此头文件
 
@@ -12,14 +13,21 @@ public:
     bool open() override;
     void close() override;
     void write(const uint8_t* data, size_t len) override;
+    ssize_t writev(const struct iovec* iov, int iovcnt) override;
+    // 每次写入对应一个数据报，保持与接收缓冲区一致的上限
+    size_t maxWriteSize() const override { return kMaxDatagramSize; }
+
+    static constexpr size_t kMaxDatagramSize = 4096;
 
 private:
-    void run() override;
     void handleData();
+    void handleWritable();
+    void updateReadInterest() override;
 
     const std::string _host;
     const uint16_t _port;
     int _socketFd = -1;
-    int _epollFd = -1;
     struct sockaddr_in _serverAddr;  // 现在类型完整
+    bool _writeBlocked = false;      // 发送缓冲区满，已注册 EPOLLOUT（受 _mutex 保护）
+    UdpRecvBatch _recvBatch{kMaxDatagramSize}; // 批量接收缓冲区（仅事件循环线程使用）
 };
\ No newline at end of file
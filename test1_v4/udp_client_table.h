@@ -0,0 +1,160 @@
+// udp_client_table.h
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <netinet/in.h>
+
+// UDP 服务端的客户端表：开放寻址（线性探测）哈希，键为 IPv4 地址 + 端口打包成的 48 位整数
+// - 客户端地址连续存放，可直接作为 sendmmsg 的目标数组
+// - 已知客户端的 touch() 只更新最近活跃时间，不分配内存；仅新客户端导致扩容时分配
+// - 删除使用后移（backward shift），不留墓碑
+// 非线程安全，由调用方加锁
+class UdpClientTable {
+public:
+    explicit UdpClientTable(size_t initialCapacity = 64)
+        : _slots(roundUpPow2(initialCapacity * 2)), _mask(_slots.size() - 1) {
+        _keys.reserve(initialCapacity);
+        _addrs.reserve(initialCapacity);
+        _lastSeen.reserve(initialCapacity);
+    }
+
+    // 记录一次来自 addr 的活动，返回 true 表示新客户端
+    bool touch(const sockaddr_in& addr, int64_t now) {
+        const uint64_t key = makeKey(addr);
+        size_t pos = hash(key) & _mask;
+        while (_slots[pos].key != 0) {
+            if (_slots[pos].key == key) {
+                _lastSeen[_slots[pos].index] = now;
+                return false;
+            }
+            pos = (pos + 1) & _mask;
+        }
+
+        if ((_keys.size() + 1) * 2 > _slots.size()) {
+            grow();
+            pos = findFree(key);
+        }
+        _slots[pos] = Slot{key, static_cast<uint32_t>(_keys.size())};
+        _keys.push_back(key);
+        _addrs.push_back(addr);
+        _lastSeen.push_back(now);
+        return true;
+    }
+
+    // 移除最近活跃时间早于 deadline 的客户端，逐个回调 onExpired(addr)，返回移除数量
+    template <typename Callback>
+    size_t expire(int64_t deadline, Callback&& onExpired) {
+        size_t removed = 0;
+        size_t i = 0;
+        while (i < _keys.size()) {
+            if (_lastSeen[i] < deadline) {
+                onExpired(_addrs[i]);
+                removeAt(i); // 末尾元素移入 i，需重新检查该位置
+                ++removed;
+            } else {
+                ++i;
+            }
+        }
+        return removed;
+    }
+
+    void clear() {
+        for (auto& slot : _slots) slot = Slot{};
+        _keys.clear();
+        _addrs.clear();
+        _lastSeen.clear();
+    }
+
+    bool empty() const { return _keys.empty(); }
+    size_t size() const { return _keys.size(); }
+    const sockaddr_in* addresses() const { return _addrs.data(); }
+    const sockaddr_in& address(size_t i) const { return _addrs[i]; }
+
+private:
+    struct Slot {
+        uint64_t key = 0;   // 0 表示空槽（0.0.0.0:0 不会是合法来源）
+        uint32_t index = 0; // 在连续数组中的下标
+    };
+
+    static uint64_t makeKey(const sockaddr_in& addr) {
+        return (static_cast<uint64_t>(addr.sin_addr.s_addr) << 16) | addr.sin_port;
+    }
+
+    static uint64_t hash(uint64_t key) {
+        key *= 0x9E3779B97F4A7C15ull;
+        return key ^ (key >> 32);
+    }
+
+    static size_t roundUpPow2(size_t n) {
+        size_t cap = 16;
+        while (cap < n) cap <<= 1;
+        return cap;
+    }
+
+    size_t findFree(uint64_t key) const {
+        size_t pos = hash(key) & _mask;
+        while (_slots[pos].key != 0) {
+            pos = (pos + 1) & _mask;
+        }
+        return pos;
+    }
+
+    size_t findSlot(uint64_t key) const {
+        size_t pos = hash(key) & _mask;
+        while (_slots[pos].key != key) {
+            pos = (pos + 1) & _mask;
+        }
+        return pos;
+    }
+
+    void grow() {
+        std::vector<Slot> old(_slots.size() * 2);
+        old.swap(_slots);
+        _mask = _slots.size() - 1;
+        for (const auto& slot : old) {
+            if (slot.key != 0) {
+                _slots[findFree(slot.key)] = slot;
+            }
+        }
+    }
+
+    void removeAt(size_t index) {
+        eraseSlot(findSlot(_keys[index]));
+
+        // 末尾元素移入空位，更新其槽位中的下标
+        const size_t last = _keys.size() - 1;
+        if (index != last) {
+            _keys[index] = _keys[last];
+            _addrs[index] = _addrs[last];
+            _lastSeen[index] = _lastSeen[last];
+            _slots[findSlot(_keys[index])].index = static_cast<uint32_t>(index);
+        }
+        _keys.pop_back();
+        _addrs.pop_back();
+        _lastSeen.pop_back();
+    }
+
+    void eraseSlot(size_t hole) {
+        // 后移删除：把探测链上后续元素搬回空位，保证查找不会提前遇到空槽
+        size_t pos = hole;
+        while (true) {
+            pos = (pos + 1) & _mask;
+            if (_slots[pos].key == 0) break;
+            const size_t ideal = hash(_slots[pos].key) & _mask;
+            // ideal 不在 (hole, pos] 区间内（环形）时，该元素可以移到 hole
+            if (((pos - ideal) & _mask) >= ((pos - hole) & _mask)) {
+                _slots[hole] = _slots[pos];
+                hole = pos;
+            }
+        }
+        _slots[hole] = Slot{};
+    }
+
+    std::vector<Slot> _slots;
+    size_t _mask;
+    // 按下标对齐的连续数组
+    std::vector<uint64_t> _keys;
+    std::vector<sockaddr_in> _addrs;
+    std::vector<int64_t> _lastSeen;
+};
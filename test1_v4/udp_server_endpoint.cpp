@@ -15,6 +15,13 @@ std::string UdpServerEndpoint::getClientId(const sockaddr_in& addr) const {
     return std::string(ip) + ":" + std::to_string(ntohs(addr.sin_port));
 }
 
+namespace {
+int64_t nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        EventLoop::Clock::now().time_since_epoch()).count();
+}
+} // namespace
+
 UdpServerEndpoint::UdpServerEndpoint(uint16_t port) : _port(port) {}
 
 UdpServerEndpoint::~UdpServerEndpoint() {
@@ -44,24 +51,19 @@ bool UdpServerEndpoint::open() {
         return false;
     }
 
-    // 创建epoll实例
-    _epollFd = epoll_create1(0);
-    if (_epollFd < 0) {
-        logError("Epoll creation failed: " + std::string(strerror(errno)));
-        ::close(_socketFd);
-        _socketFd = -1;
-        return false;
-    }
-
-    // 添加socket到epoll
-    epoll_event event{};
-    event.events = EPOLLIN;
-    event.data.fd = _socketFd;
-    if (epoll_ctl(_epollFd, EPOLL_CTL_ADD, _socketFd, &event) < 0) {
+    // 注册到事件循环（io_uring 后端使用多发接收）
+    EventLoop* loop = getEventLoop();
+    bool registered = loop->hasIoUring()
+        ? loop->addRecv(_socketFd, true, readEvents() != 0,
+                        [this](const uint8_t* data, ssize_t len, const sockaddr_in* from) {
+                            handleDatagram(data, len, from);
+                        })
+        : loop->addFd(_socketFd, readEvents(), [this](uint32_t events) {
+              if (events & EPOLLIN) handleData();
+          });
+    if (!registered) {
         logError("Epoll_ctl failed: " + std::string(strerror(errno)));
-        ::close(_epollFd);
         ::close(_socketFd);
-        _epollFd = -1;
         _socketFd = -1;
         return false;
     }
@@ -72,21 +74,27 @@ bool UdpServerEndpoint::open() {
         _clients.clear();
     }
 
+    // 定期清理空闲客户端，检查间隔为超时的 1/4（至少 1 秒）
+    auto interval = std::max<std::chrono::milliseconds>(_clientIdleTimeout / 4, std::chrono::seconds(1));
+    _expiryTimer = getEventLoop()->runEvery(interval, [this] { expireClients(); });
+
+    _running = true;
     setState(State::CONNECTED);
-    startThread();
     logMessage("UDP server started on port " + std::to_string(_port));
     return true;
 }
 
 void UdpServerEndpoint::close() {
-    stopThread();
+    if (!_running.exchange(false)) return;
     
-    if (_epollFd >= 0) {
-        ::close(_epollFd);
-        _epollFd = -1;
+    // 注销后事件循环不会再回调本端点
+    if (_expiryTimer) {
+        getEventLoop()->cancelTimer(_expiryTimer);
+        _expiryTimer = 0;
     }
-    
     if (_socketFd >= 0) {
+        getEventLoop()->removeFd(_socketFd);
+        std::lock_guard<std::mutex> lock(_clientsMutex);
         ::close(_socketFd);
         _socketFd = -1;
     }
@@ -101,6 +109,37 @@ void UdpServerEndpoint::close() {
     logMessage("UDP server closed");
 }
 
+void UdpServerEndpoint::updateReadInterest() {
+    // 读暂停期间数据报留在 socket 接收缓冲区，溢出时由内核丢弃
+    std::lock_guard<std::mutex> lock(_clientsMutex);
+    if (_socketFd >= 0) {
+        getEventLoop()->modifyFd(_socketFd, readEvents());
+    }
+}
+
+void UdpServerEndpoint::setClientIdleTimeout(std::chrono::milliseconds timeout) {
+    _clientIdleTimeout = timeout.count() > 0 ? timeout : kDefaultClientIdleTimeout;
+}
+
+void UdpServerEndpoint::expireClients() {
+    std::lock_guard<std::mutex> lock(_clientsMutex);
+    _clients.expire(nowMs() - _clientIdleTimeout.count(), [this](const sockaddr_in& addr) {
+        logMessage("Client " + getClientId(addr) + " idle, removed from broadcast list");
+    });
+}
+
+void UdpServerEndpoint::broadcast(const struct iovec* iov, int iovcnt) {
+    // io_uring 后端：提交一条 SENDMSG 链；队列已满时回退为 sendmmsg
+    if (getEventLoop()->sendTo(_socketFd, iov, iovcnt, _clients.addresses(), _clients.size())) {
+        return;
+    }
+    _fanout.send(_socketFd, iov, iovcnt, _clients.addresses(), _clients.size(),
+                 [this](size_t index, int err) {
+        reportError("Sendto failed to " + getClientId(_clients.address(index)) + ": " +
+                 std::string(strerror(err)));
+    });
+}
+
 // 广播到所有客户端
 void UdpServerEndpoint::write(const uint8_t* data, size_t len) {
     // if (!isConnected()) return;
@@ -111,56 +150,56 @@ void UdpServerEndpoint::write(const uint8_t* data, size_t len) {
         return;
     }
     
-    for (const auto& client : _clients) {
-        if (sendto(_socketFd, data, len, 0, 
-                  (sockaddr*)&client.second, sizeof(client.second)) < 0) {
-            logError("Sendto failed to " + client.first + ": " + 
-                     std::string(strerror(errno)));
-        }
-    }
+    struct iovec iov{const_cast<uint8_t*>(data), len};
+    broadcast(&iov, 1);
 }
 
+ssize_t UdpServerEndpoint::writev(const struct iovec* iov, int iovcnt) {
+    const size_t total = iovLength(iov, iovcnt);
 
-void UdpServerEndpoint::run() {
-    constexpr int MAX_EVENTS = 10;
-    epoll_event events[MAX_EVENTS];
-    
-    while (isRunning()) {
-        int numEvents = epoll_wait(_epollFd, events, MAX_EVENTS, 100);
-        if (numEvents < 0) {
-            if (errno != EINTR) {
-                logError("Epoll_wait error: " + std::string(strerror(errno)));
-            }
-            continue;
+    // 还没有客户端：与 TCP 服务端相同，由调用方丢弃并计入丢弃
+    std::lock_guard<std::mutex> lock(_clientsMutex);
+    if (_clients.empty()) return -1;
+
+    broadcast(iov, iovcnt);
+    return total;
+}
+
+void UdpServerEndpoint::handleData() {
+    // 一次 recvmmsg 取出最多 kBatchSize 个数据报；剩余数据由水平触发的 epoll 再次通知
+    int count = _recvBatch.receive(_socketFd);
+    if (count < 0) {
+        logError("Recvfrom error: " + std::string(strerror(errno)));
+        return;
+    }
+    if (count == 0) return;
+
+    // 注册/更新客户端（整批只加锁一次，共用一个时间戳）
+    {
+        const int64_t now = nowMs();
+        std::lock_guard<std::mutex> lock(_clientsMutex);
+        for (int i = 0; i < count; ++i) {
+            _clients.touch(_recvBatch.address(i), now);
         }
+    }
 
-        for (int i = 0; i < numEvents; ++i) {
-            if (events[i].data.fd == _socketFd) {
-                handleData();
-            }
+    // 已读出的数据报全部交付；背压的高水位余量足以容纳一整批
+    for (int i = 0; i < count; ++i) {
+        if (_recvBatch.length(i) > 0) {
+            processData(_recvBatch.data(i), _recvBatch.length(i));
         }
     }
 }
 
-void UdpServerEndpoint::handleData() {
-    uint8_t buffer[4096];
-    sockaddr_in clientAddr;
-    socklen_t addrLen = sizeof(clientAddr);
-    
-    ssize_t bytesRead = recvfrom(_socketFd, buffer, sizeof(buffer), 0,
-                                (sockaddr*)&clientAddr, &addrLen);
-    
-    if (bytesRead > 0) {
-        // 注册/更新客户端
-        std::string clientId = getClientId(clientAddr);
-        {
-            std::lock_guard<std::mutex> lock(_clientsMutex);
-            _clients[clientId] = clientAddr;
-        }
-        
-        // logMessage("Received data from " + clientId);
-        processData(buffer, bytesRead);
-    } else if (bytesRead < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
-        logError("Recvfrom error: " + std::string(strerror(errno)));
+void UdpServerEndpoint::handleDatagram(const uint8_t* data, ssize_t len, const sockaddr_in* from) {
+    if (len < 0) {
+        logError("Recvfrom error: " + std::string(strerror(-len)));
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_clientsMutex);
+        _clients.touch(*from, nowMs());
     }
-}
\ No newline at end of file
+    processData(data, len);
+}
@@ -1,9 +1,11 @@
 // udp_server_endpoint.h
 #pragma once
 #include "endpoint.h"
+#include "udp_batch.h"
+#include "udp_client_table.h"
 #include <sys/epoll.h>
 #include <netinet/in.h>
-#include <map>
+#include <chrono>
 #include <mutex>
 #include <string>
 
@@ -15,17 +17,36 @@ public:
     bool open() override;
     void close() override;
     void write(const uint8_t* data, size_t len) override;
+    ssize_t writev(const struct iovec* iov, int iovcnt) override;
+    // 每次写入对应一个数据报，保持与接收缓冲区一致的上限
+    size_t maxWriteSize() const override { return kMaxDatagramSize; }
+
+    // 客户端空闲超时：超过该时长未收到数据的客户端不再接收广播（0 表示默认值）
+    void setClientIdleTimeout(std::chrono::milliseconds timeout);
+
+    static constexpr size_t kMaxDatagramSize = 4096;
+    static constexpr std::chrono::milliseconds kDefaultClientIdleTimeout{60000};
 
 private:
-    void run() override;
     void handleData();
+    // io_uring 接收回调（事件循环线程）
+    void handleDatagram(const uint8_t* data, ssize_t len, const sockaddr_in* from);
+    void updateReadInterest() override;
     std::string getClientId(const sockaddr_in& addr) const; // 生成客户端唯一ID
+    void expireClients();                                    // 定时器回调（事件循环线程）
+    // 同一数据报一次 sendmmsg 发往所有客户端（需持有 _clientsMutex）
+    void broadcast(const struct iovec* iov, int iovcnt);
 
     const uint16_t _port;
     int _socketFd = -1;
-    int _epollFd = -1;
     
     // 客户端地址管理
     std::mutex _clientsMutex;
-    std::map<std::string, sockaddr_in> _clients; // 客户端ID->地址映射
+    UdpClientTable _clients;
+    std::chrono::milliseconds _clientIdleTimeout = kDefaultClientIdleTimeout;
+    EventLoop::TimerId _expiryTimer = 0;
+
+    // 批量收发缓冲区（接收仅在事件循环线程使用，发送由 _clientsMutex 保护）
+    UdpRecvBatch _recvBatch{kMaxDatagramSize};
+    UdpFanout _fanout;
 };
\ No newline at end of file
@@ -0,0 +1,174 @@
+// uring.cpp
+#include "uring.h"
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace {
+int sysSetup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int sysEnter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+}
+
+int sysRegister(int fd, unsigned opcode, void* arg, unsigned nrArgs) {
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, nrArgs));
+}
+
+template <typename T>
+T* at(void* base, uint32_t offset) {
+    return reinterpret_cast<T*>(static_cast<uint8_t*>(base) + offset);
+}
+} // namespace
+
+IoUring::IoUring(unsigned entries) {
+    io_uring_params params{};
+    _ringFd = sysSetup(entries, &params);
+    if (_ringFd < 0) {
+        throw std::runtime_error("io_uring_setup failed: " + std::string(strerror(errno)));
+    }
+    _features = params.features;
+
+    _sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    _cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    if (_features & IORING_FEAT_SINGLE_MMAP) {
+        if (_cqRingSize > _sqRingSize) _sqRingSize = _cqRingSize;
+        _cqRingSize = _sqRingSize;
+    }
+
+    _sqRing = mmap(nullptr, _sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                   _ringFd, IORING_OFF_SQ_RING);
+    if (_sqRing == MAP_FAILED) {
+        _sqRing = nullptr;
+        int err = errno;
+        ::close(_ringFd);
+        throw std::runtime_error("io_uring SQ mmap failed: " + std::string(strerror(err)));
+    }
+
+    if (_features & IORING_FEAT_SINGLE_MMAP) {
+        _cqRing = _sqRing;
+    } else {
+        _cqRing = mmap(nullptr, _cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                       _ringFd, IORING_OFF_CQ_RING);
+        if (_cqRing == MAP_FAILED) {
+            _cqRing = nullptr;
+            int err = errno;
+            munmap(_sqRing, _sqRingSize);
+            ::close(_ringFd);
+            throw std::runtime_error("io_uring CQ mmap failed: " + std::string(strerror(err)));
+        }
+    }
+
+    _sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = mmap(nullptr, _sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      _ringFd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        int err = errno;
+        if (_cqRing != _sqRing) munmap(_cqRing, _cqRingSize);
+        munmap(_sqRing, _sqRingSize);
+        ::close(_ringFd);
+        throw std::runtime_error("io_uring SQE mmap failed: " + std::string(strerror(err)));
+    }
+    _sqes = static_cast<io_uring_sqe*>(sqes);
+
+    _sqHead = at<unsigned>(_sqRing, params.sq_off.head);
+    _sqTail = at<unsigned>(_sqRing, params.sq_off.tail);
+    _sqMask = *at<unsigned>(_sqRing, params.sq_off.ring_mask);
+    _sqEntries = *at<unsigned>(_sqRing, params.sq_off.ring_entries);
+    _sqArray = at<unsigned>(_sqRing, params.sq_off.array);
+    _sqLocalTail = *_sqTail;
+
+    _cqHead = at<unsigned>(_cqRing, params.cq_off.head);
+    _cqTail = at<unsigned>(_cqRing, params.cq_off.tail);
+    _cqMask = *at<unsigned>(_cqRing, params.cq_off.ring_mask);
+    _cqes = at<io_uring_cqe>(_cqRing, params.cq_off.cqes);
+}
+
+IoUring::~IoUring() {
+    // 先关闭 ring，内核取消未完成的请求后才释放缓冲区
+    ::close(_ringFd);
+    if (_bufBase) munmap(_bufBase, _bufSize * _bufCount);
+    if (_bufRing) munmap(_bufRing, _bufRingSize);
+    munmap(_sqes, _sqesSize);
+    if (_cqRing != _sqRing) munmap(_cqRing, _cqRingSize);
+    munmap(_sqRing, _sqRingSize);
+}
+
+unsigned IoUring::sqSpace() const {
+    const unsigned head = __atomic_load_n(_sqHead, __ATOMIC_ACQUIRE);
+    return _sqEntries - (_sqLocalTail - head);
+}
+
+io_uring_sqe* IoUring::getSqe() {
+    if (sqSpace() == 0) return nullptr;
+    const unsigned index = _sqLocalTail & _sqMask;
+    io_uring_sqe* sqe = &_sqes[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    _sqArray[index] = index;
+    ++_sqLocalTail;
+    return sqe;
+}
+
+int IoUring::submit() {
+    const unsigned pending = _sqLocalTail - *_sqTail;
+    if (pending == 0) return 0;
+    __atomic_store_n(_sqTail, _sqLocalTail, __ATOMIC_RELEASE);
+
+    int ret;
+    do {
+        ret = sysEnter(_ringFd, pending, 0, 0);
+    } while (ret < 0 && errno == EINTR);
+    return ret < 0 ? -errno : ret;
+}
+
+bool IoUring::setupBufferRing(uint16_t bgid, unsigned count, size_t size) {
+    _bufRingSize = count * sizeof(io_uring_buf);
+    void* ring = mmap(nullptr, _bufRingSize, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    if (ring == MAP_FAILED) return false;
+
+    void* base = mmap(nullptr, count * size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+        munmap(ring, _bufRingSize);
+        return false;
+    }
+
+    io_uring_buf_reg reg{};
+    reg.ring_addr = reinterpret_cast<uint64_t>(ring);
+    reg.ring_entries = count;
+    reg.bgid = bgid;
+    if (sysRegister(_ringFd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        int err = errno;
+        munmap(base, count * size);
+        munmap(ring, _bufRingSize);
+        errno = err;
+        return false;
+    }
+
+    _bufRing = static_cast<io_uring_buf_ring*>(ring);
+    _bufMask = count - 1;
+    _bufBase = static_cast<uint8_t*>(base);
+    _bufSize = size;
+    _bufCount = count;
+    for (unsigned bid = 0; bid < count; ++bid) {
+        recycleBuffer(static_cast<uint16_t>(bid));
+    }
+    return true;
+}
+
+void IoUring::recycleBuffer(uint16_t bid) {
+    // C++ 下 __DECLARE_FLEX_ARRAY 展开的空结构体占 1 字节，bufs 成员偏移错误，按环起始地址取条目
+    const uint16_t tail = _bufRing->tail;
+    io_uring_buf& buf = reinterpret_cast<io_uring_buf*>(_bufRing)[tail & _bufMask];
+    buf.addr = reinterpret_cast<uint64_t>(buffer(bid));
+    buf.len = static_cast<uint32_t>(_bufSize);
+    buf.bid = bid;
+    __atomic_store_n(&_bufRing->tail, static_cast<uint16_t>(tail + 1), __ATOMIC_RELEASE);
+}
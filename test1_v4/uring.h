@@ -0,0 +1,81 @@
+// uring.h
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <linux/io_uring.h>
+
+// io_uring 的最小封装（直接使用系统调用，不依赖 liburing）
+// - SQ 的填充与提交需由调用方串行化；CQ 只在一个线程中收割
+// - 提供缓冲区环（provided buffer ring）：内核接收时自行挑选缓冲区，用户态用完后归还
+class IoUring {
+public:
+    // 创建失败（内核不支持 / 被禁用）时抛出 std::runtime_error
+    explicit IoUring(unsigned entries);
+    ~IoUring();
+
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    int fd() const { return _ringFd; }
+    unsigned features() const { return _features; }
+
+    // 取一个空闲 SQE（已清零），SQ 满时返回 nullptr
+    io_uring_sqe* getSqe();
+    unsigned sqSpace() const;
+    // 提交已填充的 SQE，返回内核接收的数量，失败返回 -errno
+    int submit();
+
+    // 收割所有已完成的 CQE，返回处理数量
+    template <typename Handler>
+    unsigned reap(Handler&& handler) {
+        unsigned head = *_cqHead;
+        const unsigned tail = __atomic_load_n(_cqTail, __ATOMIC_ACQUIRE);
+        unsigned count = 0;
+        while (head != tail) {
+            handler(_cqes[head & _cqMask]);
+            ++head;
+            ++count;
+        }
+        __atomic_store_n(_cqHead, head, __ATOMIC_RELEASE);
+        return count;
+    }
+
+    // 注册提供缓冲区环：count 个（2 的幂）大小为 size 的缓冲区，组号 bgid
+    bool setupBufferRing(uint16_t bgid, unsigned count, size_t size);
+    uint8_t* buffer(uint16_t bid) const { return _bufBase + static_cast<size_t>(bid) * _bufSize; }
+    size_t bufferSize() const { return _bufSize; }
+    // 归还缓冲区（仅收割线程调用）
+    void recycleBuffer(uint16_t bid);
+
+private:
+    int _ringFd = -1;
+    unsigned _features = 0;
+
+    // SQ 环
+    void* _sqRing = nullptr;
+    size_t _sqRingSize = 0;
+    unsigned* _sqHead = nullptr;
+    unsigned* _sqTail = nullptr;
+    unsigned* _sqArray = nullptr;
+    unsigned _sqMask = 0;
+    unsigned _sqEntries = 0;
+    unsigned _sqLocalTail = 0; // 已填充但尚未发布的尾部
+    io_uring_sqe* _sqes = nullptr;
+    size_t _sqesSize = 0;
+
+    // CQ 环（IORING_FEAT_SINGLE_MMAP 时与 SQ 环共用映射）
+    void* _cqRing = nullptr;
+    size_t _cqRingSize = 0;
+    unsigned* _cqHead = nullptr;
+    unsigned* _cqTail = nullptr;
+    unsigned _cqMask = 0;
+    io_uring_cqe* _cqes = nullptr;
+
+    // 提供缓冲区环
+    io_uring_buf_ring* _bufRing = nullptr;
+    size_t _bufRingSize = 0;
+    unsigned _bufMask = 0;
+    uint8_t* _bufBase = nullptr;
+    size_t _bufSize = 0;
+    size_t _bufCount = 0;
+};